@@ -0,0 +1,274 @@
+/* ring buffer memory budget test, many bursty streams sharing one budget */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "ringBufferBudget.h"
+
+/* most producer/consumer thread pairs */
+#define MAXTHREADS 64
+/* bytes per consumer read */
+#define READCHUNK (1 << 16)
+
+struct s_ringBuffer **pp_streams = NULL;
+
+unsigned long int numStreams = 1000;
+unsigned long int numThreads = 4;
+unsigned long int numBursts = 1000;
+unsigned long int maxBurst = 1 << 18;
+
+/* one producer and one consumer per group, group g has every stream s with s % numThreads == g. */
+unsigned long int groups[MAXTHREADS];
+unsigned long int errors[MAXTHREADS];
+unsigned long int moved[MAXTHREADS];
+
+void *producer(void *data);
+void *consumer(void *data);
+double now(void);
+
+int main(int argc, char *argv[])
+{
+  int opt = 0;
+
+  unsigned long int index = 0;
+  unsigned long int minSize = 1 << 10;
+  unsigned long int maxSize = 1 << 20;
+  unsigned long int limit = 64 << 20;
+  unsigned long int numCreated = 0;
+  unsigned long int totalErrors = 0;
+  unsigned long int totalMoved = 0;
+
+  double start = 0;
+  double end = 0;
+
+  pthread_t producerThreads[MAXTHREADS];
+  pthread_t consumerThreads[MAXTHREADS];
+
+  struct s_ringBufferBudget *p_budget = NULL;
+
+  while((opt = getopt(argc, argv, "n:t:m:x:b:B:h")) != -1)
+  {
+    switch(opt)
+    {
+      case 'n':
+        numStreams = strtoul(optarg, NULL, 0);
+        break;
+      case 't':
+        numThreads = strtoul(optarg, NULL, 0);
+        break;
+      case 'm':
+        minSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'x':
+        maxSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'b':
+        limit = strtoul(optarg, NULL, 0) << 20;
+        break;
+      case 'B':
+        numBursts = strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("Usage: %s [-n streams] [-t thread pairs] [-m min stream bytes] [-x max stream bytes] [-b budget MB] [-B bursts per producer]\n", argv[0]);
+        return EXIT_SUCCESS;
+    }
+  }
+
+  if(numThreads <= 0 || numThreads > MAXTHREADS || numStreams < numThreads)
+  {
+    fprintf(stderr, "1 to %d thread pairs, at least one stream each.\n", MAXTHREADS);
+    return EXIT_FAILURE;
+  }
+
+  maxBurst = maxSize / 4;
+
+  p_budget = initRingBufferBudget(limit);
+
+  pp_streams = calloc(numStreams, sizeof(*pp_streams));
+
+  if(!p_budget || !pp_streams)
+  {
+    fprintf(stderr, "Failed to create budget.\n");
+    free(pp_streams);
+    freeRingBufferBudget(&p_budget);
+    return EXIT_FAILURE;
+  }
+
+  for(numCreated = 0; numCreated < numStreams; numCreated++)
+  {
+    pp_streams[numCreated] = initRingBufferOnBudget(p_budget, minSize, maxSize, 1);
+
+    if(!pp_streams[numCreated]) break;
+  }
+
+  if(numCreated < numStreams)
+  {
+    fprintf(stderr, "Budget only covers the minimum of %lu streams.\n", numCreated);
+
+    for(index = 0; index < numCreated; index++) freeRingBuffer(&pp_streams[index]);
+
+    free(pp_streams);
+    freeRingBufferBudget(&p_budget);
+    return EXIT_FAILURE;
+  }
+
+  start = now();
+
+  for(index = 0; index < numThreads; index++)
+  {
+    groups[index] = index;
+
+    pthread_create(&consumerThreads[index], NULL, consumer, &groups[index]);
+    pthread_create(&producerThreads[index], NULL, producer, &groups[index]);
+  }
+
+  for(index = 0; index < numThreads; index++)
+  {
+    pthread_join(producerThreads[index], NULL);
+    pthread_join(consumerThreads[index], NULL);
+
+    totalErrors += errors[index];
+    totalMoved += moved[index];
+  }
+
+  end = now();
+
+  printf("%lu streams, %lu to %lu bytes each, bursts up to %lu bytes\n", numStreams, minSize, maxSize, maxBurst);
+  printf("worst case preallocated: %lu MB\n", numStreams * maxSize >> 20);
+  printf("budget: %lu MB, peak used %lu KB, now %lu KB, turned down %lu times\n", limit >> 20, getRingBufferBudgetPeak(p_budget) >> 10, getRingBufferBudgetUsed(p_budget) >> 10, getRingBufferBudgetDenied(p_budget));
+  printf("moved %lu MB in %.2f s, %lu bytes out of order\n", totalMoved >> 20, end - start, totalErrors);
+
+  for(index = 0; index < numStreams; index++) freeRingBuffer(&pp_streams[index]);
+
+  free(pp_streams);
+
+  freeRingBufferBudget(&p_budget);
+
+  return (totalErrors ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* bursts of counting bytes to random streams of the group, each stream keeps its own count. */
+void *producer(void *data)
+{
+  unsigned long int group = *(unsigned long int *)data;
+  unsigned long int index = 0;
+  unsigned long int stream = 0;
+  unsigned long int len = 0;
+  unsigned long int groupSize = 0;
+  unsigned long int seed = group + 1;
+  unsigned long int offset = 0;
+
+  unsigned char *p_counts = NULL;
+  unsigned char *p_burst = NULL;
+
+  groupSize = (numStreams - group + numThreads - 1) / numThreads;
+
+  p_counts = calloc(groupSize, 1);
+  p_burst = malloc(maxBurst);
+
+  if(!p_counts || !p_burst)
+  {
+    perror("Could not allocate producer buffers.");
+    index = numBursts;
+  }
+
+  for(; index < numBursts; index++)
+  {
+    /* a small linear congruential generator, same bursts every run. */
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+
+    stream = (seed >> 33) % groupSize;
+    len = 1 + (seed >> 13) % maxBurst;
+
+    for(offset = 0; offset < len; offset++) p_burst[offset] = (unsigned char)(p_counts[stream] + offset);
+
+    p_counts[stream] += (unsigned char)len;
+
+    ringBufferBlockingWrite(pp_streams[group + stream * numThreads], p_burst, len, NULL);
+  }
+
+  for(stream = 0; stream < groupSize; stream++) ringBufferEndBlocking(pp_streams[group + stream * numThreads]);
+
+  free(p_burst);
+  free(p_counts);
+
+  return NULL;
+}
+
+/* poll the streams of the group, checking the counts, till every stream has ended and been drained. */
+void *consumer(void *data)
+{
+  unsigned long int group = *(unsigned long int *)data;
+  unsigned long int index = 0;
+  unsigned long int stream = 0;
+  unsigned long int numRead = 0;
+  unsigned long int groupSize = 0;
+  unsigned long int numAlive = 0;
+  unsigned long int passRead = 0;
+
+  unsigned char *p_counts = NULL;
+  unsigned char *p_chunk = NULL;
+
+  groupSize = (numStreams - group + numThreads - 1) / numThreads;
+
+  p_counts = calloc(groupSize, 1);
+  p_chunk = malloc(READCHUNK);
+
+  if(!p_counts || !p_chunk)
+  {
+    perror("Could not allocate consumer buffers.");
+    free(p_chunk);
+    free(p_counts);
+    return NULL;
+  }
+
+  do
+  {
+    numAlive = 0;
+    passRead = 0;
+
+    for(stream = 0; stream < groupSize; stream++)
+    {
+      if(!ringBufferIsAlive(pp_streams[group + stream * numThreads])) continue;
+
+      numAlive++;
+
+      numRead = ringBufferRead(pp_streams[group + stream * numThreads], p_chunk, READCHUNK);
+
+      for(index = 0; index < numRead; index++)
+      {
+        if(p_chunk[index] != p_counts[stream]) errors[group]++;
+
+        p_counts[stream] = p_chunk[index] + 1;
+      }
+
+      moved[group] += numRead;
+      passRead += numRead;
+    }
+
+    /* nothing moved this pass, give the producer a chance. */
+    if(!passRead) usleep(100);
+  }
+  while(numAlive > 0);
+
+  free(p_chunk);
+  free(p_counts);
+
+  return NULL;
+}
+
+double now(void)
+{
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+
+  return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
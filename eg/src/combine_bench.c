@@ -0,0 +1,188 @@
+/* ring buffer write combining benchmark, many producers writing small records through the mutex or combined */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <sched.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "ringBuffer.h"
+
+/* most producer threads */
+#define MAXTHREADS 64
+/* records per consumer read */
+#define READBATCH 4096
+
+/* a small record, who wrote it and its place in that producers order. */
+struct s_record
+{
+  unsigned long int producer;
+  unsigned long int seq;
+};
+
+struct s_ringBuffer *p_ringBuffer = NULL;
+
+unsigned long int numRecords = 100000;
+
+double now(void);
+void *producer(void *data);
+double runBench(unsigned long int numProducers, unsigned long int b_combining, unsigned long int *op_misordered);
+
+int main(int argc, char *argv[])
+{
+  int opt = 0;
+
+  unsigned long int index = 0;
+  unsigned long int ringSize = 1 << 16;
+  unsigned long int misordered = 0;
+
+  unsigned long int producerCounts[] = {2, 4, 8, 16, 32, 64};
+
+  double plainTime = 0;
+  double combinedTime = 0;
+
+  while((opt = getopt(argc, argv, "n:r:h")) != -1)
+  {
+    switch(opt)
+    {
+      case 'n':
+        numRecords = strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        ringSize = strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("Usage: %s [-n records per producer] [-r ring size in records]\n", argv[0]);
+        return EXIT_SUCCESS;
+    }
+  }
+
+  p_ringBuffer = initRingBuffer(ringSize, sizeof(struct s_record));
+
+  if(!p_ringBuffer)
+  {
+    fprintf(stderr, "Failed to create ring buffer.\n");
+    return EXIT_FAILURE;
+  }
+
+  /* a full buffer turns the write away, the producer tries again. */
+  ringBufferSetOverflowPolicy(p_ringBuffer, RING_BUFFER_DROP_NEWEST);
+
+  printf("%lu records of %lu bytes per producer, %lu CPUs\n", numRecords, (unsigned long int)sizeof(struct s_record), (unsigned long int)sysconf(_SC_NPROCESSORS_ONLN));
+  printf("%10s %16s %16s %8s\n", "producers", "mutex Mrec/s", "combined Mrec/s", "speedup");
+
+  for(index = 0; index < sizeof(producerCounts) / sizeof(producerCounts[0]); index++)
+  {
+    plainTime = runBench(producerCounts[index], 0, &misordered);
+    combinedTime = runBench(producerCounts[index], 1, &misordered);
+
+    if(plainTime <= 0 || combinedTime <= 0) break;
+
+    printf("%10lu %16.2f %16.2f %7.2fx\n", producerCounts[index], (double)(producerCounts[index] * numRecords) / plainTime / 1e6, (double)(producerCounts[index] * numRecords) / combinedTime / 1e6, plainTime / combinedTime);
+  }
+
+  if(misordered) printf("%lu records out of order!\n", misordered);
+
+  freeRingBuffer(&p_ringBuffer);
+
+  return (misordered ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* run the producers, read everything on this thread, checking each producers order. */
+double runBench(unsigned long int numProducers, unsigned long int b_combining, unsigned long int *op_misordered)
+{
+  unsigned long int index = 0;
+  unsigned long int numRead = 0;
+  unsigned long int total = 0;
+  unsigned long int ids[MAXTHREADS];
+  unsigned long int nextSeq[MAXTHREADS];
+
+  double start = 0;
+  double end = 0;
+
+  pthread_t producerThreads[MAXTHREADS];
+
+  struct s_record *p_records = NULL;
+
+  p_records = malloc(READBATCH * sizeof(*p_records));
+
+  if(!p_records)
+  {
+    perror("Could not allocate read buffer.");
+    return 0;
+  }
+
+  ringBufferRecycle(p_ringBuffer);
+  ringBufferSetOverflowPolicy(p_ringBuffer, RING_BUFFER_DROP_NEWEST);
+  ringBufferSetWriteCombining(p_ringBuffer, b_combining);
+
+  start = now();
+
+  for(index = 0; index < numProducers; index++)
+  {
+    ids[index] = index;
+    nextSeq[index] = 0;
+
+    if(pthread_create(&producerThreads[index], NULL, producer, &ids[index]))
+    {
+      fprintf(stderr, "Failed to create producer thread.\n");
+
+      /* the ones we have still finish, we just can't wait on the rest. */
+      numProducers = index;
+      break;
+    }
+  }
+
+  while(total < numProducers * numRecords)
+  {
+    numRead = ringBufferBlockingReadRange(p_ringBuffer, p_records, 1, READBATCH, NULL);
+
+    for(index = 0; index < numRead; index++)
+    {
+      if(p_records[index].seq != nextSeq[p_records[index].producer]) (*op_misordered)++;
+
+      nextSeq[p_records[index].producer] = p_records[index].seq + 1;
+    }
+
+    total += numRead;
+  }
+
+  end = now();
+
+  for(index = 0; index < numProducers; index++)
+  {
+    pthread_join(producerThreads[index], NULL);
+  }
+
+  free(p_records);
+
+  return end - start;
+}
+
+void *producer(void *data)
+{
+  struct s_record record;
+
+  record.producer = *(unsigned long int *)data;
+
+  for(record.seq = 0; record.seq < numRecords; record.seq++)
+  {
+    while(!ringBufferWrite(p_ringBuffer, &record, 1)) sched_yield();
+  }
+
+  return NULL;
+}
+
+double now(void)
+{
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+
+  return (double)time.tv_sec + (double)time.tv_nsec / 1e9;
+}
@@ -0,0 +1,168 @@
+/* ring buffer copy mode benchmark, throughput and cache pollution of each copy mode */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <time.h>
+
+#include "ringBuffer.h"
+
+/* 1 MB */
+#define MEGABYTE (1 << 20)
+/* 1 KB */
+#define KILOBYTE (1 << 10)
+
+double now(void);
+double touch(unsigned char *p_hotSet, unsigned long int len, unsigned long int *p_sum);
+
+int main(int argc, char *argv[])
+{
+  int opt = 0;
+  int index = 0;
+
+  unsigned long int ringSize = 64;
+  unsigned long int chunkSize = 1024;
+  unsigned long int hotSize = 1024;
+  unsigned long int totalSize = 2048;
+  unsigned long int moved = 0;
+  unsigned long int sum = 0;
+
+  double writeTime = 0;
+  double readTime = 0;
+  double producerTouch = 0;
+  double consumerTouch = 0;
+  double start = 0;
+
+  unsigned long int modes[] = {RING_BUFFER_COPY_MEMCPY, RING_BUFFER_COPY_STREAM, RING_BUFFER_COPY_PREFETCH, RING_BUFFER_COPY_AUTO};
+  char const *p_modeNames[] = {"memcpy", "stream", "prefetch", "auto"};
+
+  unsigned char *p_chunk = NULL;
+  unsigned char *p_producerHot = NULL;
+  unsigned char *p_consumerHot = NULL;
+
+  struct s_ringBuffer *p_ringBuffer = NULL;
+
+  while((opt = getopt(argc, argv, "r:c:w:n:h")) != -1)
+  {
+    switch(opt)
+    {
+      case 'r':
+        ringSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'c':
+        chunkSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'w':
+        hotSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'n':
+        totalSize = strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("Usage: %s [-r ring MB] [-c chunk KB] [-w working set KB per side] [-n total MB]\n", argv[0]);
+        return EXIT_SUCCESS;
+    }
+  }
+
+  ringSize *= MEGABYTE;
+  chunkSize *= KILOBYTE;
+  hotSize *= KILOBYTE;
+  totalSize *= MEGABYTE;
+
+  p_ringBuffer = initRingBuffer(ringSize, 1);
+
+  p_chunk = malloc(chunkSize);
+  p_producerHot = malloc(hotSize);
+  p_consumerHot = malloc(hotSize);
+
+  if(!p_ringBuffer || !p_chunk || !p_producerHot || !p_consumerHot)
+  {
+    fprintf(stderr, "Failed to allocate benchmark buffers.\n");
+
+    freeRingBuffer(&p_ringBuffer);
+    free(p_chunk);
+    free(p_producerHot);
+    free(p_consumerHot);
+
+    return EXIT_FAILURE;
+  }
+
+  memset(p_chunk, 0x5A, chunkSize);
+  memset(p_producerHot, 1, hotSize);
+  memset(p_consumerHot, 2, hotSize);
+
+  printf("ring %lu MB, chunk %lu KB, working set %lu KB per side, %lu MB moved per mode\n", ringSize / MEGABYTE, chunkSize / KILOBYTE, hotSize / KILOBYTE, totalSize / MEGABYTE);
+  printf("%-10s %12s %12s %18s %18s\n", "mode", "write GB/s", "read GB/s", "producer ns/line", "consumer ns/line");
+
+  for(index = 0; index < (int)(sizeof(modes) / sizeof(*modes)); index++)
+  {
+    ringBufferReset(p_ringBuffer);
+    ringBufferSetCopyMode(p_ringBuffer, modes[index], 0);
+
+    /* half full, so what the consumer reads was written long ago, like a real backlog. */
+    while(getRingBufferReadSize(p_ringBuffer) < ringSize / 2) ringBufferWrite(p_ringBuffer, p_chunk, chunkSize);
+
+    writeTime = readTime = producerTouch = consumerTouch = 0;
+
+    touch(p_producerHot, hotSize, &sum);
+    touch(p_consumerHot, hotSize, &sum);
+
+    for(moved = 0; moved < totalSize; moved += chunkSize)
+    {
+      start = now();
+      ringBufferWrite(p_ringBuffer, p_chunk, chunkSize);
+      writeTime += now() - start;
+
+      producerTouch += touch(p_producerHot, hotSize, &sum);
+
+      start = now();
+      ringBufferRead(p_ringBuffer, p_chunk, chunkSize);
+      readTime += now() - start;
+
+      consumerTouch += touch(p_consumerHot, hotSize, &sum);
+    }
+
+    printf("%-10s %12.2f %12.2f %18.2f %18.2f\n", p_modeNames[index],
+      totalSize / writeTime / 1e9,
+      totalSize / readTime / 1e9,
+      producerTouch / (totalSize / chunkSize) / (hotSize / 64) * 1e9,
+      consumerTouch / (totalSize / chunkSize) / (hotSize / 64) * 1e9);
+  }
+
+  /* keeps the touches from being optimized out. */
+  if(sum == 1) printf("\n");
+
+  freeRingBuffer(&p_ringBuffer);
+
+  free(p_chunk);
+  free(p_producerHot);
+  free(p_consumerHot);
+
+  return EXIT_SUCCESS;
+}
+
+/* seconds on the monotonic clock */
+double now(void)
+{
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+
+  return time.tv_sec + time.tv_nsec / 1e9;
+}
+
+/* read a byte of every line in the working set, the time shows how much of it the copies evicted. */
+double touch(unsigned char *p_hotSet, unsigned long int len, unsigned long int *p_sum)
+{
+  unsigned long int index = 0;
+
+  double start = now();
+
+  for(index = 0; index < len; index += 64) *p_sum += p_hotSet[index];
+
+  return now() - start;
+}
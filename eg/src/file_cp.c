@@ -1,9 +1,13 @@
 /* ring buffer test */
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <getopt.h>
 #include <pthread.h>
 
@@ -13,16 +17,30 @@
 #define BUFFSIZE  (1 << 23)
 /* 1 MB */
 #define DATACHUNK (1 << 20)
+/* 64 KB */
+#define MINCHUNK  (1 << 16)
+/* O_DIRECT wants buffers, offsets and lengths on the logical block size, a page covers it. */
+#define DIRECTALIGN 4096
 
 struct s_ringBuffer *p_ringBuffer = NULL;
 
+/* bytes per pread/pwrite in direct mode. */
+unsigned long int blockSize = DATACHUNK;
+
 void *producer(void *data);
 void *consumer(void *data);
+void *directProducer(void *data);
+void *directConsumer(void *data);
+int openDirect(char const *p_fileName, int flags);
+int directCopy(char const *p_inFileName, char const *p_outFileName, unsigned long int queueDepth);
 
 int main(int argc, char *argv[])
 {
   int error = 0;
   int opt   = 0;
+  int b_direct = 0;
+
+  unsigned long int queueDepth = 8;
   
   pthread_t producerThread;
   pthread_t consumerThread;
@@ -32,8 +50,9 @@ int main(int argc, char *argv[])
 
   char inFileName[256]  = "input.txt";
   char outFileName[256] = "output.txt";
+  char traceFileName[256] = "";
 
-  while((opt = getopt(argc, argv, "i:o:h")) != -1)
+  while((opt = getopt(argc, argv, "i:o:db:q:T:h")) != -1)
   {
     switch(opt)
     {
@@ -43,11 +62,29 @@ int main(int argc, char *argv[])
       case 'o':
         strcpy(outFileName, optarg);
         break;
+      case 'd':
+        b_direct = 1;
+        break;
+      case 'b':
+        blockSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'q':
+        queueDepth = strtoul(optarg, NULL, 0);
+        break;
+      case 'T':
+        strcpy(traceFileName, optarg);
+        break;
       default:
-        printf("Usage: %s -i filein.txt -o fileout.txt\n", argv[0]);
+        printf("Usage: %s -i filein.txt -o fileout.txt [-d] [-b block size] [-q queue depth] [-T trace.bin]\n", argv[0]);
+        printf("  -d O_DIRECT copy, aligned ring buffer segments go straight to pread/pwrite.\n");
+        printf("  -b bytes per read/write in direct mode, a power of two of at least %d.\n", DIRECTALIGN);
+        printf("  -q blocks the reader can get ahead of the writer in direct mode.\n");
+        printf("  -T trace the ring buffer calls to a file for trace_replay, not in direct mode.\n");
         return EXIT_SUCCESS;
     }
   }
+
+  if(b_direct) return directCopy(inFileName, outFileName, queueDepth);
   
   p_inFile = fopen(inFileName, "r");
   
@@ -83,6 +120,9 @@ int main(int argc, char *argv[])
     return EXIT_FAILURE;
   }
 
+  /* freeRingBuffer stops the trace. */
+  if(traceFileName[0] && !ringBufferTraceStart(p_ringBuffer, traceFileName)) fprintf(stderr, "Copying without a trace.\n");
+
 #ifdef DEBUG_STATUS
   printf("CREATING PRODUCER THREAD\n");
 #endif
@@ -218,16 +258,193 @@ void *consumer(void *data)
   {
     int numElemWrote = 0;
     
-    numElemRead = ringBufferBlockingRead(p_ringBuffer, p_fileBuffer, DATACHUNK, NULL);
+    /* wake up for a small batch, take a big one if it's there. 0 means blocking ended and it's empty. */
+    numElemRead = ringBufferBlockingReadRange(p_ringBuffer, p_fileBuffer, MINCHUNK, DATACHUNK, NULL);
 
-    do
+    while(numElemWrote < numElemRead)
     {
       numElemWrote += fwrite(p_fileBuffer + numElemWrote, sizeof(*p_fileBuffer), numElemRead - numElemWrote, p_outFile);
-    } while(numElemRead < numElemWrote);
+    }
 
-  } while(numElemRead == DATACHUNK);
+  } while(numElemRead > 0);
   
   free(p_fileBuffer);
   
   return NULL;
 }
+
+int directCopy(char const *p_inFileName, char const *p_outFileName, unsigned long int queueDepth)
+{
+  int error = 0;
+  int inFd  = -1;
+  int outFd = -1;
+
+  pthread_t producerThread;
+  pthread_t consumerThread;
+
+  if((blockSize < DIRECTALIGN) || (blockSize & (blockSize - 1)) || (queueDepth <= 0))
+  {
+    fprintf(stderr, "Block size must be a power of two of at least %d, queue depth at least 1.\n", DIRECTALIGN);
+    return EXIT_FAILURE;
+  }
+
+  inFd = openDirect(p_inFileName, O_RDONLY);
+
+  if(inFd < 0) return EXIT_FAILURE;
+
+  outFd = openDirect(p_outFileName, O_WRONLY | O_CREAT | O_TRUNC);
+
+  if(outFd < 0)
+  {
+    close(inFd);
+    return EXIT_FAILURE;
+  }
+
+  /* one block more then the queue depth, the ring keeps a byte free so that block is never whole. */
+  p_ringBuffer = initRingBufferAligned(blockSize * (queueDepth + 1), 1, DIRECTALIGN);
+
+  if(!p_ringBuffer)
+  {
+    fprintf(stderr, "Failed to create ring buffer.\n");
+
+    close(outFd);
+    close(inFd);
+
+    return EXIT_FAILURE;
+  }
+
+  error = pthread_create(&producerThread, NULL, directProducer, &inFd);
+
+  if(error)
+  {
+    fprintf(stderr, "Failed to create producer thread.\n");
+
+    close(outFd);
+    close(inFd);
+
+    freeRingBuffer(&p_ringBuffer);
+
+    return EXIT_FAILURE;
+  }
+
+  error = pthread_create(&consumerThread, NULL, directConsumer, &outFd);
+
+  if(error)
+  {
+    fprintf(stderr, "Failed to create consumer thread.\n");
+
+    ringBufferEndBlocking(p_ringBuffer);
+
+    pthread_join(producerThread, NULL);
+
+    close(outFd);
+    close(inFd);
+
+    freeRingBuffer(&p_ringBuffer);
+
+    return EXIT_FAILURE;
+  }
+
+  pthread_join(producerThread, NULL);
+  pthread_join(consumerThread, NULL);
+
+  freeRingBuffer(&p_ringBuffer);
+
+  close(inFd);
+  close(outFd);
+
+  return EXIT_SUCCESS;
+}
+
+/* open with O_DIRECT, falling back to the page cache where the file system doesn't do it (tmpfs). */
+int openDirect(char const *p_fileName, int flags)
+{
+  int fd = -1;
+
+  fd = open(p_fileName, flags | O_DIRECT, 0644);
+
+  if((fd < 0) && (errno == EINVAL))
+  {
+    fprintf(stderr, "%s does not support O_DIRECT, using the page cache.\n", p_fileName);
+
+    fd = open(p_fileName, flags, 0644);
+  }
+
+  if(fd < 0) perror("File IO Issue.");
+
+  return fd;
+}
+
+void *directProducer(void *data)
+{
+  ssize_t numRead = 0;
+
+  off_t offset = 0;
+
+  void *p_segment = NULL;
+
+  int inFd = *(int *)data;
+
+  do
+  {
+    if(!ringBufferAcquireWrite(p_ringBuffer, &p_segment, blockSize, NULL)) break;
+
+    /* read right into the ring, a whole aligned block. */
+    numRead = pread(inFd, p_segment, blockSize, offset);
+
+    if(numRead < 0)
+    {
+      perror("File IO Issue.");
+      break;
+    }
+
+    offset += numRead;
+
+    ringBufferCommitWrite(p_ringBuffer, numRead);
+
+  /* a short read is the end of the file, the next offset wouldn't be aligned anyway. */
+  } while((unsigned long int)numRead == blockSize);
+
+  ringBufferEndBlocking(p_ringBuffer);
+
+  return NULL;
+}
+
+void *directConsumer(void *data)
+{
+  unsigned long int segLen = 0;
+  unsigned long int writeLen = 0;
+  unsigned long int padLen = 0;
+
+  off_t offset = 0;
+
+  void *p_segment = NULL;
+
+  int outFd = *(int *)data;
+
+  /* 0 means blocking ended and it's empty. */
+  while((segLen = ringBufferAcquireRead(p_ringBuffer, &p_segment, blockSize, NULL)) > 0)
+  {
+    writeLen = (segLen < blockSize ? segLen : blockSize);
+
+    /* the last block is short, write it padded out and truncate after. It is still inside the ring's block. */
+    padLen = (writeLen + DIRECTALIGN - 1) & ~(unsigned long int)(DIRECTALIGN - 1);
+
+    if(pwrite(outFd, p_segment, padLen, offset) != (ssize_t)padLen)
+    {
+      perror("File IO Issue.");
+
+      /* don't leave the producer waiting for space. */
+      ringBufferEndBlocking(p_ringBuffer);
+      break;
+    }
+
+    offset += writeLen;
+
+    ringBufferCommitRead(p_ringBuffer, writeLen);
+  }
+
+  if(ftruncate(outFd, offset)) perror("File IO Issue.");
+
+  return NULL;
+}
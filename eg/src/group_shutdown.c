@@ -0,0 +1,148 @@
+/* ring buffer group shutdown test, many idle consumers all have to return after end blocking */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "ringBufferGroup.h"
+
+/* most consumer threads */
+#define MAXCONSUMERS 64
+/* elements per consumer read */
+#define READBATCH 64
+/* seconds to wait for a consumer to return before calling it hung */
+#define JOINTIMEOUT 5
+
+struct s_ringBufferGroup *p_group = NULL;
+
+unsigned long int numRecords = 10000;
+
+unsigned long int ids[MAXCONSUMERS];
+unsigned long int consumed[MAXCONSUMERS];
+
+void *consumer(void *data);
+
+int main(int argc, char *argv[])
+{
+  int opt = 0;
+
+  unsigned long int index = 0;
+  unsigned long int round = 0;
+  unsigned long int numRounds = 100;
+  unsigned long int numConsumers = 8;
+  unsigned long int numShards = 4;
+  unsigned long int record = 0;
+  unsigned long int total = 0;
+  unsigned long int hung = 0;
+  unsigned long int lost = 0;
+
+  pthread_t consumerThreads[MAXCONSUMERS];
+
+  struct timespec joinDeadline;
+
+  while((opt = getopt(argc, argv, "c:s:n:r:h")) != -1)
+  {
+    switch(opt)
+    {
+      case 'c':
+        numConsumers = strtoul(optarg, NULL, 0);
+        break;
+      case 's':
+        numShards = strtoul(optarg, NULL, 0);
+        break;
+      case 'n':
+        numRecords = strtoul(optarg, NULL, 0);
+        break;
+      case 'r':
+        numRounds = strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("Usage: %s [-c consumers] [-s shards] [-n records per round] [-r rounds]\n", argv[0]);
+        return EXIT_SUCCESS;
+    }
+  }
+
+  if(numConsumers <= 0 || numConsumers > MAXCONSUMERS || numShards <= 0)
+  {
+    fprintf(stderr, "1 to %d consumers, at least one shard.\n", MAXCONSUMERS);
+    return EXIT_FAILURE;
+  }
+
+  for(round = 0; round < numRounds && !hung; round++)
+  {
+    p_group = initRingBufferGroup(numShards, numConsumers, 256, sizeof(unsigned long int));
+
+    if(!p_group)
+    {
+      fprintf(stderr, "Failed to create ring buffer group.\n");
+      return EXIT_FAILURE;
+    }
+
+    for(index = 0; index < numConsumers; index++)
+    {
+      ids[index] = index;
+      consumed[index] = 0;
+
+      pthread_create(&consumerThreads[index], NULL, consumer, &ids[index]);
+    }
+
+    for(record = 0; record < numRecords; record++)
+    {
+      ringBufferGroupWrite(p_group, record % numShards, &record, 1, NULL);
+    }
+
+    /* odd rounds end right away, even rounds let the consumers go idle first. */
+    if(!(round & 1)) usleep(1000);
+
+    ringBufferGroupEndBlocking(p_group);
+
+    clock_gettime(CLOCK_REALTIME, &joinDeadline);
+
+    joinDeadline.tv_sec += JOINTIMEOUT;
+
+    total = 0;
+
+    for(index = 0; index < numConsumers; index++)
+    {
+      if(pthread_timedjoin_np(consumerThreads[index], NULL, &joinDeadline))
+      {
+        fprintf(stderr, "round %lu, consumer %lu did not return after end blocking.\n", round, index);
+        hung++;
+        continue;
+      }
+
+      total += consumed[index];
+    }
+
+    if(total != numRecords) lost++;
+
+    /* a hung consumer still has the group, leave it be. */
+    if(!hung) freeRingBufferGroup(&p_group);
+  }
+
+  printf("%lu rounds, %lu consumers on %lu shards\n", round, numConsumers, numShards);
+  printf("%lu consumers hung, %lu rounds lost records\n", hung, lost);
+
+  return ((hung || lost) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* read till the group is ended and drained. */
+void *consumer(void *data)
+{
+  unsigned long int id = *(unsigned long int *)data;
+  unsigned long int numRead = 0;
+  unsigned long int records[READBATCH];
+
+  while((numRead = ringBufferGroupRead(p_group, id, records, READBATCH, NULL)) > 0)
+  {
+    consumed[id] += numRead;
+  }
+
+  return NULL;
+}
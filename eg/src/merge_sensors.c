@@ -0,0 +1,184 @@
+/* ring buffer merge test, timestamped sensor records merged into one stream in time order */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "ringBufferMerge.h"
+
+/* most sensor threads */
+#define MAXSENSORS 64
+/* records per merge read */
+#define READBATCH 256
+
+/* a timestamped record, who wrote it and its place in that sensors order. */
+struct s_record
+{
+  unsigned long int time;
+  unsigned long int sensor;
+  unsigned long int seq;
+};
+
+struct s_ringBuffer *p_rings[MAXSENSORS];
+
+unsigned long int numRecords = 20000;
+/* most microseconds between two records of a sensor */
+unsigned long int maxGap = 200;
+
+unsigned long int ids[MAXSENSORS];
+
+void *sensor(void *data);
+unsigned long int recordTime(void const *p_record, void *p_context);
+unsigned long int nowNs(void);
+
+int main(int argc, char *argv[])
+{
+  int opt = 0;
+
+  unsigned long int index = 0;
+  unsigned long int numSensors = 8;
+  unsigned long int numRead = 0;
+  unsigned long int total = 0;
+  unsigned long int lastTime = 0;
+  unsigned long int misordered = 0;
+  unsigned long int missing = 0;
+  unsigned long int start = 0;
+  unsigned long int nextSeq[MAXSENSORS];
+
+  pthread_t sensorThreads[MAXSENSORS];
+
+  struct s_record records[READBATCH];
+
+  struct s_ringBufferMerge *p_merge = NULL;
+
+  while((opt = getopt(argc, argv, "s:n:g:h")) != -1)
+  {
+    switch(opt)
+    {
+      case 's':
+        numSensors = strtoul(optarg, NULL, 0);
+        break;
+      case 'n':
+        numRecords = strtoul(optarg, NULL, 0);
+        break;
+      case 'g':
+        maxGap = strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("Usage: %s [-s sensors] [-n records per sensor] [-g max microseconds between records]\n", argv[0]);
+        return EXIT_SUCCESS;
+    }
+  }
+
+  if(numSensors <= 0 || numSensors > MAXSENSORS)
+  {
+    fprintf(stderr, "1 to %d sensors.\n", MAXSENSORS);
+    return EXIT_FAILURE;
+  }
+
+  for(index = 0; index < numSensors; index++)
+  {
+    p_rings[index] = initRingBuffer(1024, sizeof(struct s_record));
+
+    if(!p_rings[index])
+    {
+      fprintf(stderr, "Failed to create ring buffer.\n");
+      return EXIT_FAILURE;
+    }
+
+    nextSeq[index] = 0;
+  }
+
+  p_merge = initRingBufferMerge(p_rings, numSensors, recordTime, NULL);
+
+  if(!p_merge)
+  {
+    fprintf(stderr, "Failed to create merge.\n");
+    return EXIT_FAILURE;
+  }
+
+  start = nowNs();
+
+  for(index = 0; index < numSensors; index++)
+  {
+    ids[index] = index;
+
+    pthread_create(&sensorThreads[index], NULL, sensor, &ids[index]);
+  }
+
+  while((numRead = ringBufferMergeRead(p_merge, records, READBATCH, NULL)) > 0)
+  {
+    for(index = 0; index < numRead; index++)
+    {
+      if(records[index].time < lastTime) misordered++;
+
+      if(records[index].seq != nextSeq[records[index].sensor]) missing++;
+
+      lastTime = records[index].time;
+      nextSeq[records[index].sensor] = records[index].seq + 1;
+    }
+
+    total += numRead;
+  }
+
+  for(index = 0; index < numSensors; index++)
+  {
+    pthread_join(sensorThreads[index], NULL);
+  }
+
+  printf("%lu sensors, %lu records merged in %.2f s\n", numSensors, total, (double)(nowNs() - start) / 1e9);
+  printf("%lu out of time order, %lu out of sensor order\n", misordered, missing);
+
+  freeRingBufferMerge(&p_merge);
+
+  for(index = 0; index < numSensors; index++) freeRingBuffer(&p_rings[index]);
+
+  return ((misordered || missing || total != numSensors * numRecords) ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+/* each sensor runs at its own uneven rate, and ends on its own. */
+void *sensor(void *data)
+{
+  unsigned long int seed = *(unsigned long int *)data + 1;
+
+  struct s_record record;
+
+  record.sensor = *(unsigned long int *)data;
+
+  for(record.seq = 0; record.seq < numRecords; record.seq++)
+  {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+
+    if(maxGap) usleep((seed >> 33) % maxGap);
+
+    record.time = nowNs();
+
+    ringBufferBlockingWrite(p_rings[record.sensor], &record, 1, NULL);
+  }
+
+  ringBufferEndBlocking(p_rings[record.sensor]);
+
+  return NULL;
+}
+
+unsigned long int recordTime(void const *p_record, void *p_context)
+{
+  (void)p_context;
+
+  return ((struct s_record const *)p_record)->time;
+}
+
+unsigned long int nowNs(void)
+{
+  struct timespec time;
+
+  clock_gettime(CLOCK_MONOTONIC, &time);
+
+  return (unsigned long int)time.tv_sec * 1000000000UL + (unsigned long int)time.tv_nsec;
+}
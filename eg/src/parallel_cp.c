@@ -0,0 +1,237 @@
+/* ring buffer test, file copy with parallel readers put back in order */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "ringBufferReorder.h"
+
+/* 1 MB */
+#define DATACHUNK (1 << 20)
+/* most reader threads */
+#define MAXTHREADS 64
+
+struct s_ringBufferReorder *p_reorder = NULL;
+
+int inFd  = -1;
+int outFd = -1;
+
+unsigned long int chunkSize = DATACHUNK;
+unsigned long int numChunks = 0;
+/* next chunk a reader takes, shared by all of them. */
+volatile unsigned long int nextChunk = 0;
+
+void *producer(void *data);
+unsigned long int writeChunk(void *p_data, unsigned long int len, void *p_context);
+
+int main(int argc, char *argv[])
+{
+  int error = 0;
+  int opt   = 0;
+
+  unsigned long int index = 0;
+  unsigned long int numThreads = 4;
+  unsigned long int windowSize = 0;
+  unsigned long int b_failed = 0;
+  unsigned long int drained = 0;
+  unsigned long int count = 0;
+
+  double seconds = 0;
+
+  struct stat inStat;
+  struct timespec start;
+  struct timespec end;
+
+  pthread_t producerThreads[MAXTHREADS];
+
+  char inFileName[256]  = "input.txt";
+  char outFileName[256] = "output.txt";
+
+  while((opt = getopt(argc, argv, "i:o:t:b:w:h")) != -1)
+  {
+    switch(opt)
+    {
+      case 'i':
+        strcpy(inFileName, optarg);
+        break;
+      case 'o':
+        strcpy(outFileName, optarg);
+        break;
+      case 't':
+        numThreads = strtoul(optarg, NULL, 0);
+        break;
+      case 'b':
+        chunkSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'w':
+        windowSize = strtoul(optarg, NULL, 0);
+        break;
+      default:
+        printf("Usage: %s -i filein.txt -o fileout.txt [-t readers] [-b chunk size] [-w window chunks]\n", argv[0]);
+        printf("  -t reader threads, each preads the next chunk, 1 to %d (4).\n", MAXTHREADS);
+        printf("  -b bytes per chunk (%d).\n", DATACHUNK);
+        printf("  -w chunks the readers can be ahead of the writer (4 per reader).\n");
+        return EXIT_SUCCESS;
+    }
+  }
+
+  if((numThreads <= 0) || (numThreads > MAXTHREADS) || (chunkSize <= 0))
+  {
+    fprintf(stderr, "Readers must be 1 to %d, chunk size greater then 0.\n", MAXTHREADS);
+    return EXIT_FAILURE;
+  }
+
+  if(windowSize <= 0) windowSize = numThreads * 4;
+
+  inFd = open(inFileName, O_RDONLY);
+
+  if((inFd < 0) || fstat(inFd, &inStat))
+  {
+    perror("File IO Issue.");
+    return EXIT_FAILURE;
+  }
+
+  outFd = open(outFileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+
+  if(outFd < 0)
+  {
+    perror("File IO Issue.");
+    close(inFd);
+    return EXIT_FAILURE;
+  }
+
+  numChunks = ((unsigned long int)inStat.st_size + chunkSize - 1) / chunkSize;
+
+  p_reorder = initRingBufferReorder(windowSize, chunkSize);
+
+  if(!p_reorder)
+  {
+    fprintf(stderr, "Failed to create reorder ring.\n");
+
+    close(outFd);
+    close(inFd);
+
+    return EXIT_FAILURE;
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+
+  for(index = 0; index < numThreads; index++)
+  {
+    error = pthread_create(&producerThreads[index], NULL, producer, NULL);
+
+    if(error)
+    {
+      fprintf(stderr, "Failed to create producer thread.\n");
+
+      ringBufferReorderEndBlocking(p_reorder);
+
+      numThreads = index;
+      b_failed = 1;
+
+      break;
+    }
+  }
+
+  /* this thread is the consumer, the chunks come out in file order. 0 means a reader ended it. */
+  while(!b_failed && (drained < numChunks))
+  {
+    count = ringBufferReorderDrain(p_reorder, writeChunk, &b_failed, NULL);
+
+    if(count <= 0) b_failed = 1;
+
+    drained += count;
+  }
+
+  /* a failed write leaves readers waiting on the window. */
+  ringBufferReorderEndBlocking(p_reorder);
+
+  for(index = 0; index < numThreads; index++)
+  {
+    pthread_join(producerThreads[index], NULL);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+  printf("%lu readers, %lu chunks of %lu bytes, window %lu: %.1f MB/s\n", numThreads, numChunks, chunkSize, windowSize, (double)inStat.st_size / 1e6 / seconds);
+
+  freeRingBufferReorder(&p_reorder);
+
+  close(inFd);
+  close(outFd);
+
+  return (b_failed ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+void *producer(void *data)
+{
+  unsigned long int chunk = 0;
+
+  ssize_t numRead = 0;
+
+  void *p_slot = NULL;
+
+  (void)data;
+
+  for(;;)
+  {
+    chunk = __sync_fetch_and_add(&nextChunk, 1);
+
+    if(chunk >= numChunks) break;
+
+    /* waits while the chunk is a window ahead of the writer. */
+    p_slot = ringBufferReorderAcquire(p_reorder, chunk, NULL);
+
+    if(!p_slot) break;
+
+    numRead = pread(inFd, p_slot, chunkSize, (off_t)(chunk * chunkSize));
+
+    if(numRead < 0)
+    {
+      perror("File IO Issue.");
+
+      /* the writer would wait on this chunk forever. */
+      ringBufferReorderEndBlocking(p_reorder);
+      break;
+    }
+
+    ringBufferReorderCommit(p_reorder, chunk, (unsigned long int)numRead);
+  }
+
+  return NULL;
+}
+
+unsigned long int writeChunk(void *p_data, unsigned long int len, void *p_context)
+{
+  unsigned long int numWrote = 0;
+
+  ssize_t wrote = 0;
+
+  while(numWrote < len)
+  {
+    wrote = write(outFd, ((char *)p_data) + numWrote, len - numWrote);
+
+    if(wrote < 0)
+    {
+      perror("File IO Issue.");
+
+      *(unsigned long int *)p_context = 1;
+
+      return numWrote;
+    }
+
+    numWrote += (unsigned long int)wrote;
+  }
+
+  return numWrote;
+}
@@ -0,0 +1,218 @@
+/* ring buffer pipeline test, file copy with a line count stage in the middle */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+
+#include "ringBufferPipeline.h"
+
+/* 8 MB */
+#define BUFFSIZE  (1 << 23)
+/* 1 MB */
+#define DATACHUNK (1 << 20)
+
+int reader(struct s_ringBufferStageWorker *p_worker);
+int counter(struct s_ringBufferStageWorker *p_worker);
+int writer(struct s_ringBufferStageWorker *p_worker);
+
+unsigned long int numLines = 0;
+
+int main(int argc, char *argv[])
+{
+  int error = 0;
+  int opt   = 0;
+  
+  long int cpu = RING_BUFFER_PIPELINE_NO_CPU;
+  
+  FILE *p_inFile = NULL;
+  FILE *p_outFile = NULL;
+  
+  struct s_ringBufferPipeline *p_pipeline = NULL;
+
+  char inFileName[256]  = "input.txt";
+  char outFileName[256] = "output.txt";
+
+  while((opt = getopt(argc, argv, "i:o:ph")) != -1)
+  {
+    switch(opt)
+    {
+      case 'i':
+        strcpy(inFileName, optarg);
+        break;
+      case 'o':
+        strcpy(outFileName, optarg);
+        break;
+      case 'p':
+        cpu = 0;
+        break;
+      default:
+        printf("Usage: %s -i filein.txt -o fileout.txt [-p pin stages to cpus]\n", argv[0]);
+        return EXIT_SUCCESS;
+    }
+  }
+  
+  p_inFile = fopen(inFileName, "r");
+  
+  if(!p_inFile)
+  {
+    perror("File IO Issue.");
+    
+    return EXIT_FAILURE;
+  }
+  
+  p_outFile = fopen(outFileName, "w");
+  
+  if(!p_outFile)
+  {
+    perror("File IO Issue.");
+    
+    fclose(p_inFile);
+    
+    return EXIT_FAILURE;
+  }
+  
+  p_pipeline = initRingBufferPipeline(BUFFSIZE, 1);
+  
+  if(!p_pipeline)
+  {
+    fprintf(stderr, "Failed to create pipeline.\n");
+    
+    fclose(p_outFile);
+    fclose(p_inFile);
+    
+    return EXIT_FAILURE;
+  }
+  
+  /* order has to be kept, so one worker each. */
+  if(!ringBufferPipelineAddStage(p_pipeline, "read", reader, p_inFile, 1, cpu) ||
+     !ringBufferPipelineAddStage(p_pipeline, "count", counter, NULL, 1, (cpu < 0 ? cpu : cpu + 1)) ||
+     !ringBufferPipelineAddStage(p_pipeline, "write", writer, p_outFile, 1, (cpu < 0 ? cpu : cpu + 2)))
+  {
+    fprintf(stderr, "Failed to add pipeline stages.\n");
+    
+    freeRingBufferPipeline(&p_pipeline);
+    
+    fclose(p_outFile);
+    fclose(p_inFile);
+    
+    return EXIT_FAILURE;
+  }
+  
+  error = ringBufferPipelineRun(p_pipeline);
+  
+  if(error)
+  {
+    fprintf(stderr, "Pipeline failed with %d.\n", error);
+  }
+  
+  printf("%lu lines\n", numLines);
+  
+  ringBufferPipelineReport(p_pipeline, stdout);
+  
+  freeRingBufferPipeline(&p_pipeline);
+  
+  fclose(p_inFile);
+  fclose(p_outFile);
+  
+  return (error ? EXIT_FAILURE : EXIT_SUCCESS);
+}
+
+int reader(struct s_ringBufferStageWorker *p_worker)
+{
+  int error = 0;
+  
+  char *p_fileBuffer = NULL;
+  
+  FILE *p_inFile = (FILE *)p_worker->p_userData;
+  
+  p_fileBuffer = malloc(DATACHUNK);
+  
+  if(!p_fileBuffer)
+  {
+    perror("Could not allocate reader buffer.");
+    return 1;
+  }
+  
+  do
+  {
+    unsigned long int numElemRead = 0;
+    
+    numElemRead = fread(p_fileBuffer, sizeof(*p_fileBuffer), DATACHUNK, p_inFile);
+    
+    if(ferror(p_inFile))
+    {
+      error = 2;
+      break;
+    }
+    
+    if(ringBufferStageWrite(p_worker, p_fileBuffer, numElemRead) < numElemRead) break;
+    
+  } while(!feof(p_inFile));
+  
+  free(p_fileBuffer);
+  
+  return error;
+}
+
+int counter(struct s_ringBufferStageWorker *p_worker)
+{
+  unsigned long int numElemRead = 0;
+  
+  char *p_fileBuffer = NULL;
+  
+  p_fileBuffer = malloc(DATACHUNK);
+  
+  if(!p_fileBuffer)
+  {
+    perror("Could not allocate counter buffer.");
+    return 1;
+  }
+  
+  while((numElemRead = ringBufferStageRead(p_worker, p_fileBuffer, DATACHUNK)) > 0)
+  {
+    unsigned long int index = 0;
+    
+    for(index = 0; index < numElemRead; index++) numLines += (p_fileBuffer[index] == '\n');
+    
+    if(ringBufferStageWrite(p_worker, p_fileBuffer, numElemRead) < numElemRead) break;
+  }
+  
+  free(p_fileBuffer);
+  
+  return 0;
+}
+
+int writer(struct s_ringBufferStageWorker *p_worker)
+{
+  int error = 0;
+  
+  unsigned long int numElemRead = 0;
+  
+  char *p_fileBuffer = NULL;
+  
+  FILE *p_outFile = (FILE *)p_worker->p_userData;
+  
+  p_fileBuffer = malloc(DATACHUNK);
+  
+  if(!p_fileBuffer)
+  {
+    perror("Could not allocate writer buffer.");
+    return 1;
+  }
+  
+  while((numElemRead = ringBufferStageRead(p_worker, p_fileBuffer, DATACHUNK)) > 0)
+  {
+    if(fwrite(p_fileBuffer, sizeof(*p_fileBuffer), numElemRead, p_outFile) < numElemRead)
+    {
+      error = 3;
+      break;
+    }
+  }
+  
+  free(p_fileBuffer);
+  
+  return error;
+}
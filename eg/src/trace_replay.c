@@ -0,0 +1,450 @@
+/* ring buffer trace replay, plays a trace back with the same threads, sizes and timing against any ring configuration */
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "ringBuffer.h"
+
+/* most threads in a trace */
+#define MAXTHREADS 64
+/* trace operations */
+#define NUMOPS 6
+/* trace outcomes */
+#define NUMOUTCOMES 4
+/* no progress for this long and blocking is ended, in ms */
+#define STALLTIME 1000
+
+/* what the calls of one operation did, from the trace or the replay. */
+struct s_opStats
+{
+  unsigned long int calls;
+  unsigned long int done;
+  unsigned long int outcomes[NUMOUTCOMES];
+  double totalNs;
+  double maxNs;
+};
+
+/* one replay thread, the records of one traced thread. */
+struct s_replayThread
+{
+  unsigned long int numRecords;
+  unsigned long int maxLen;
+  unsigned long int *p_records;
+  struct s_opStats stats[NUMOPS];
+};
+
+struct s_ringBuffer *p_ringBuffer = NULL;
+
+struct s_ringBufferTraceRecord *p_trace = NULL;
+
+struct timespec replayStart;
+
+double timeScale = 1.0;
+
+volatile unsigned long int progress = 0;
+volatile unsigned long int finished = 0;
+
+void *replay(void *data);
+unsigned long int replayCall(struct s_ringBufferTraceRecord const *ip_record, void *p_buffer);
+void addStats(struct s_opStats *op_stats, unsigned long int result, unsigned long int outcome, double ns);
+void addTime(struct timespec *iop_time, double ns);
+double elapsed(struct timespec const *ip_from, struct timespec const *ip_to);
+
+int main(int argc, char *argv[])
+{
+  int opt = 0;
+
+  unsigned long int index = 0;
+  unsigned long int op = 0;
+  unsigned long int outcome = 0;
+  unsigned long int numRecords = 0;
+  unsigned long int maxRecords = 0;
+  unsigned long int numThreads = 0;
+  unsigned long int bufferSize = 0;
+  unsigned long int policy = ~0UL;
+  unsigned long int b_combining = 0;
+  unsigned long int b_fair = 0;
+  unsigned long int lastProgress = 0;
+  unsigned long int stalled = 0;
+  unsigned long int b_ended = 0;
+
+  unsigned long int threadIds[MAXTHREADS];
+
+  char const *p_opNames[NUMOPS] = {"write", "read", "blk write", "blk read", "write rng", "read rng"};
+
+  char traceFileName[256] = "trace.bin";
+
+  struct s_ringBufferTraceHeader header;
+  struct s_ringBufferTraceRecord record;
+
+  struct s_replayThread threads[MAXTHREADS];
+
+  struct s_opStats traced[NUMOPS];
+  struct s_opStats replayed[NUMOPS];
+
+  struct timespec end;
+  struct timespec pause = {0, 10000000L};
+
+  pthread_t replayThreads[MAXTHREADS];
+
+  FILE *p_traceFile = NULL;
+
+  while((opt = getopt(argc, argv, "i:s:p:cfx:h")) != -1)
+  {
+    switch(opt)
+    {
+      case 'i':
+        strcpy(traceFileName, optarg);
+        break;
+      case 's':
+        bufferSize = strtoul(optarg, NULL, 0);
+        break;
+      case 'p':
+        policy = strtoul(optarg, NULL, 0);
+        break;
+      case 'c':
+        b_combining = 1;
+        break;
+      case 'f':
+        b_fair = 1;
+        break;
+      case 'x':
+        timeScale = atof(optarg);
+        break;
+      default:
+        printf("Usage: %s -i trace.bin [-s ring size] [-p policy] [-c] [-f] [-x time scale]\n", argv[0]);
+        printf("  -s ring size in elements, the traced size if not given.\n");
+        printf("  -p overflow policy, 0 overwrite oldest, 1 drop newest, 2 block, the traced one if not given.\n");
+        printf("  -c write combining on.\n");
+        printf("  -f fairness on.\n");
+        printf("  -x multiply the traced times by this, 0 replays as fast as it can (1).\n");
+        return EXIT_SUCCESS;
+    }
+  }
+
+  p_traceFile = fopen(traceFileName, "rb");
+
+  if(!p_traceFile)
+  {
+    perror("File IO Issue.");
+    return EXIT_FAILURE;
+  }
+
+  if((fread(&header, sizeof(header), 1, p_traceFile) != 1) || strcmp(header.magic, RING_BUFFER_TRACE_MAGIC) || (header.version != RING_BUFFER_TRACE_VERSION) || (header.elementSize <= 0))
+  {
+    fprintf(stderr, "%s is not a version %d ring buffer trace.\n", traceFileName, RING_BUFFER_TRACE_VERSION);
+    fclose(p_traceFile);
+    return EXIT_FAILURE;
+  }
+
+  memset(threads, 0, sizeof(threads));
+
+  /* records are in the order calls finished, each thread gets its own in that order. */
+  while(fread(&record, sizeof(record), 1, p_traceFile) == 1)
+  {
+    if(record.op >= NUMOPS || record.outcome >= NUMOUTCOMES) continue;
+
+    for(index = 0; (index < numThreads) && (threadIds[index] != record.thread); index++);
+
+    if(index == numThreads)
+    {
+      if(numThreads == MAXTHREADS)
+      {
+        fprintf(stderr, "Trace has more then %d threads, the rest are skipped.\n", MAXTHREADS);
+        continue;
+      }
+
+      threadIds[numThreads++] = record.thread;
+    }
+
+    if(numRecords == maxRecords)
+    {
+      maxRecords = (maxRecords ? maxRecords * 2 : 4096);
+
+      p_trace = realloc(p_trace, maxRecords * sizeof(*p_trace));
+
+      if(!p_trace)
+      {
+        perror("Could not allocate trace.");
+        fclose(p_traceFile);
+        return EXIT_FAILURE;
+      }
+    }
+
+    p_trace[numRecords++] = record;
+
+    threads[index].numRecords++;
+
+    if(record.len > threads[index].maxLen) threads[index].maxLen = record.len;
+  }
+
+  fclose(p_traceFile);
+
+  if(numRecords <= 0)
+  {
+    fprintf(stderr, "%s has no records.\n", traceFileName);
+    return EXIT_FAILURE;
+  }
+
+  for(index = 0; index < numThreads; index++)
+  {
+    threads[index].p_records = malloc(threads[index].numRecords * sizeof(unsigned long int));
+
+    if(!threads[index].p_records)
+    {
+      perror("Could not allocate trace.");
+      return EXIT_FAILURE;
+    }
+
+    threads[index].numRecords = 0;
+  }
+
+  for(op = 0; op < numRecords; op++)
+  {
+    for(index = 0; threadIds[index] != p_trace[op].thread; index++);
+
+    threads[index].p_records[threads[index].numRecords++] = op;
+  }
+
+  p_ringBuffer = initRingBuffer((bufferSize ? bufferSize : header.bufferSize), header.elementSize);
+
+  if(!p_ringBuffer)
+  {
+    fprintf(stderr, "Failed to create ring buffer.\n");
+    return EXIT_FAILURE;
+  }
+
+  if(!ringBufferSetOverflowPolicy(p_ringBuffer, (policy != ~0UL ? policy : header.overflowPolicy)))
+  {
+    freeRingBuffer(&p_ringBuffer);
+    return EXIT_FAILURE;
+  }
+
+  ringBufferSetWriteCombining(p_ringBuffer, b_combining);
+  ringBufferSetFairness(p_ringBuffer, b_fair);
+
+  printf("%lu records, %lu threads, ring of %lu elements of %lu bytes (traced %lu), time scale %.2f\n", numRecords, numThreads, getRingBufferByteSize(p_ringBuffer) / header.elementSize, header.elementSize, header.bufferSize, timeScale);
+
+  clock_gettime(CLOCK_MONOTONIC, &replayStart);
+
+  for(index = 0; index < numThreads; index++)
+  {
+    if(pthread_create(&replayThreads[index], NULL, replay, &threads[index]))
+    {
+      fprintf(stderr, "Failed to create replay thread.\n");
+
+      /* the ones that started may wait on ones that didn't. */
+      ringBufferEndBlocking(p_ringBuffer);
+
+      numThreads = index;
+      b_ended = 1;
+      break;
+    }
+  }
+
+  /* a different configuration can leave a thread waiting on data the trace never gives it. */
+  while(finished < numThreads)
+  {
+    nanosleep(&pause, NULL);
+
+    if(progress != lastProgress)
+    {
+      lastProgress = progress;
+      stalled = 0;
+      continue;
+    }
+
+    stalled += 10;
+
+    if(!b_ended && (stalled >= STALLTIME))
+    {
+      ringBufferEndBlocking(p_ringBuffer);
+      b_ended = 1;
+    }
+  }
+
+  for(index = 0; index < numThreads; index++)
+  {
+    pthread_join(replayThreads[index], NULL);
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  memset(traced, 0, sizeof(traced));
+  memset(replayed, 0, sizeof(replayed));
+
+  for(op = 0; op < numRecords; op++)
+  {
+    addStats(&traced[p_trace[op].op], p_trace[op].result, p_trace[op].outcome, (double)p_trace[op].duration);
+  }
+
+  for(index = 0; index < numThreads; index++)
+  {
+    for(op = 0; op < NUMOPS; op++)
+    {
+      replayed[op].calls += threads[index].stats[op].calls;
+      replayed[op].done += threads[index].stats[op].done;
+      replayed[op].totalNs += threads[index].stats[op].totalNs;
+
+      if(threads[index].stats[op].maxNs > replayed[op].maxNs) replayed[op].maxNs = threads[index].stats[op].maxNs;
+
+      for(outcome = 0; outcome < NUMOUTCOMES; outcome++) replayed[op].outcomes[outcome] += threads[index].stats[op].outcomes[outcome];
+    }
+
+    free(threads[index].p_records);
+  }
+
+  printf("%-10s %8s %8s %14s %12s %12s %9s %9s\n", "op", "", "calls", "elements done", "mean us", "max us", "timeouts", "short");
+
+  for(op = 0; op < NUMOPS; op++)
+  {
+    if(!traced[op].calls) continue;
+
+    printf("%-10s %8s %8lu %14lu %12.2f %12.2f %9lu %9lu\n", p_opNames[op], "traced", traced[op].calls, traced[op].done, traced[op].totalNs / traced[op].calls / 1e3, traced[op].maxNs / 1e3, traced[op].outcomes[RING_BUFFER_TRACE_TIMEOUT], traced[op].outcomes[RING_BUFFER_TRACE_SHORT] + traced[op].outcomes[RING_BUFFER_TRACE_ENDED]);
+    printf("%-10s %8s %8lu %14lu %12.2f %12.2f %9lu %9lu\n", "", "replayed", replayed[op].calls, replayed[op].done, (replayed[op].calls ? replayed[op].totalNs / replayed[op].calls / 1e3 : 0), replayed[op].maxNs / 1e3, replayed[op].outcomes[RING_BUFFER_TRACE_TIMEOUT], replayed[op].outcomes[RING_BUFFER_TRACE_SHORT] + replayed[op].outcomes[RING_BUFFER_TRACE_ENDED]);
+  }
+
+  printf("traced %.3f s, replayed %.3f s, longest fair wait %lu us, %lu lapped\n", (double)(p_trace[numRecords - 1].time + p_trace[numRecords - 1].duration) / 1e9, elapsed(&replayStart, &end) / 1e9, ringBufferMaxWait(p_ringBuffer), ringBufferLapped(p_ringBuffer));
+
+  if(b_ended) printf("replay stalled, blocking was ended to finish it.\n");
+
+  freeRingBuffer(&p_ringBuffer);
+
+  free(p_trace);
+
+  return EXIT_SUCCESS;
+}
+
+/* play one threads records at their traced times. */
+void *replay(void *data)
+{
+  unsigned long int index = 0;
+  unsigned long int result = 0;
+  unsigned long int outcome = 0;
+  unsigned long int capacity = 0;
+
+  struct timespec when;
+  struct timespec start;
+  struct timespec end;
+
+  struct s_ringBufferTraceRecord const *p_record = NULL;
+
+  struct s_replayThread *p_thread = (struct s_replayThread *)data;
+
+  char *p_buffer = NULL;
+
+  p_buffer = calloc(p_thread->maxLen + 1, p_ringBuffer->elementSize);
+
+  if(!p_buffer)
+  {
+    perror("Could not allocate replay buffer.");
+    __sync_fetch_and_add(&finished, 1);
+    return NULL;
+  }
+
+  /* a range min bigger then the ring is cut down to what it holds. */
+  capacity = (getRingBufferByteSize(p_ringBuffer) - 1) / p_ringBuffer->elementSize;
+
+  for(index = 0; index < p_thread->numRecords; index++)
+  {
+    p_record = &p_trace[p_thread->p_records[index]];
+
+    if(timeScale > 0)
+    {
+      when = replayStart;
+
+      addTime(&when, (double)p_record->time * timeScale);
+
+      while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &when, NULL));
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    result = replayCall(p_record, p_buffer);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    if(result >= p_record->len) outcome = RING_BUFFER_TRACE_DONE;
+    else if((p_record->op == RING_BUFFER_TRACE_WRITE) || (p_record->op == RING_BUFFER_TRACE_READ)) outcome = RING_BUFFER_TRACE_SHORT;
+    else if(!ringBufferStillBlocking(p_ringBuffer)) outcome = RING_BUFFER_TRACE_ENDED;
+    else if((p_record->op >= RING_BUFFER_TRACE_WRITE_RANGE) && ((result >= p_record->minLen) || (result >= capacity))) outcome = RING_BUFFER_TRACE_DONE;
+    else outcome = RING_BUFFER_TRACE_TIMEOUT;
+
+    addStats(&p_thread->stats[p_record->op], result, outcome, elapsed(&start, &end));
+
+    __sync_fetch_and_add(&progress, 1);
+  }
+
+  free(p_buffer);
+
+  __sync_fetch_and_add(&finished, 1);
+
+  return NULL;
+}
+
+/* the traced call, with its timeout. The data is whatever was read last. */
+unsigned long int replayCall(struct s_ringBufferTraceRecord const *ip_record, void *p_buffer)
+{
+  struct timespec timeout;
+  struct timespec *p_timeout = NULL;
+
+  if(ip_record->timeout)
+  {
+    timeout.tv_sec = (time_t)(ip_record->timeout / 1000000000UL);
+    timeout.tv_nsec = (long)(ip_record->timeout % 1000000000UL);
+
+    p_timeout = &timeout;
+  }
+
+  switch(ip_record->op)
+  {
+    case RING_BUFFER_TRACE_WRITE:
+      return ringBufferWrite(p_ringBuffer, p_buffer, ip_record->len);
+    case RING_BUFFER_TRACE_READ:
+      return ringBufferRead(p_ringBuffer, p_buffer, ip_record->len);
+    case RING_BUFFER_TRACE_BLOCKING_WRITE:
+      return ringBufferBlockingWrite(p_ringBuffer, p_buffer, ip_record->len, p_timeout);
+    case RING_BUFFER_TRACE_BLOCKING_READ:
+      return ringBufferBlockingRead(p_ringBuffer, p_buffer, ip_record->len, p_timeout);
+    case RING_BUFFER_TRACE_WRITE_RANGE:
+      return ringBufferBlockingWriteRange(p_ringBuffer, p_buffer, ip_record->minLen, ip_record->len, p_timeout);
+    case RING_BUFFER_TRACE_READ_RANGE:
+      return ringBufferBlockingReadRange(p_ringBuffer, p_buffer, ip_record->minLen, ip_record->len, p_timeout);
+    default:
+      return 0;
+  }
+}
+
+void addStats(struct s_opStats *op_stats, unsigned long int result, unsigned long int outcome, double ns)
+{
+  op_stats->calls++;
+  op_stats->done += result;
+  op_stats->outcomes[outcome]++;
+  op_stats->totalNs += ns;
+
+  if(ns > op_stats->maxNs) op_stats->maxNs = ns;
+}
+
+void addTime(struct timespec *iop_time, double ns)
+{
+  iop_time->tv_sec += (time_t)(ns / 1e9);
+  iop_time->tv_nsec += (long)(ns - (double)(time_t)(ns / 1e9) * 1e9);
+
+  if(iop_time->tv_nsec >= 1000000000L)
+  {
+    iop_time->tv_sec++;
+    iop_time->tv_nsec -= 1000000000L;
+  }
+}
+
+double elapsed(struct timespec const *ip_from, struct timespec const *ip_to)
+{
+  return (double)(ip_to->tv_sec - ip_from->tv_sec) * 1e9 + (double)(ip_to->tv_nsec - ip_from->tv_nsec);
+}
@@ -10,7 +10,32 @@
   * @author  Jay Convertino(electrobs@gmail.com)
   * @date    12/01/2016
   * @version
-  * - 1.6.1 - Fixed examples build in cmake, Threads::Threads missing for Ubuntu 20.04.
+  * - 1.31.0 - Added key ordered merge reader over many ring buffers, merge_sensors example.
+  * 1.30.0 - Added memory budgets shared by ring buffers that grow and shrink, budget_streams example.
+  * 1.29.0 - Added optional USDT probes, RING_BUFFER_USDT cmake option.
+  * 1.28.0 - Added binary tracing of reads and writes, trace_replay example.
+  * 1.27.0 - Added fairness mode, blocked reads and writes served first come first served, max wait metric.
+  * 1.26.0 - Added flat combining for ringBufferWrite, combine_bench example.
+  * 1.25.0 - Added reorder ring for in order delivery from parallel producers, parallel_cp example.
+  * 1.24.0 - Added aligned ring buffers and block segment acquire/commit, file_cp O_DIRECT mode.
+  * 1.23.0 - Added planar read deinterleave and write interleave with SIMD kernels.
+  * 1.22.0 - Added sample format conversion fused into read and write, with SIMD kernels.
+  * 1.21.0 - Added sliding window reads, copied or in place, that only consume the hop.
+  * 1.20.0 - Added descriptor ring with a lock-free buffer pool.
+  * 1.19.0 - Added single allocation init, in place init, recycle and ring buffer pools.
+  * 1.18.0 - Size and status queries are lock-free.
+  * 1.17.0 - Added monotonic absolute deadlines, Until variants of the blocking calls.
+  * 1.16.0 - Added blocking read/write range calls, file_cp consumer uses them.
+  * 1.15.0 - Added streaming and prefetch copy kernels, with copy modes.
+  * 1.14.0 - Added CRC32C integrity checking fused into the copies.
+  * 1.13.0 - Added multi stage pipelines, end blocking now wakes every waiter.
+  * 1.12.0 - Added overflow policies for non-blocking write, overwrite now drops whole oldest elements.
+  * 1.11.0 - Added priority lanes with strict and weighted round robin draining.
+  * 1.10.0 - Added sharded ring buffer groups with work stealing consumers.
+  * 1.9.0 - Added wait sets to block on many ring buffers at once.
+  * 1.8.0 - Added in place drain with callback, blocking and timed.
+  * 1.7.0 - Added async read/write with completion callbacks for coroutine schedulers.
+  * 1.6.1 - Fixed examples build in cmake, Threads::Threads missing for Ubuntu 20.04.
   * 1.6.0 - Added new method for checking if the buffer is alive to help with mutex locks being abused.
   * 1.5.4 - Cast pointer to char so the library isn't using GCC void * math.
   * 1.5.3 - Element size was being put into buffer size twice... buffers too big.
@@ -50,6 +75,7 @@
 #ifndef __RINGBUFFER_HD
 #define __RINGBUFFER_HD
 
+#include <stdio.h>
 #include <pthread.h>
 #include <sys/time.h>
 
@@ -63,6 +89,565 @@ extern "C" {
  */
 #define ERROR_NULL     0
 
+/**
+ * @def RING_BUFFER_ASYNC_PENDING
+ * async operation queued, callback will be called on completion.
+ */
+#define RING_BUFFER_ASYNC_PENDING   0
+/**
+ * @def RING_BUFFER_ASYNC_DONE
+ * async operation transferred all elements requested.
+ */
+#define RING_BUFFER_ASYNC_DONE      1
+/**
+ * @def RING_BUFFER_ASYNC_ENDED
+ * async operation ended early since blocking was disabled.
+ */
+#define RING_BUFFER_ASYNC_ENDED     2
+/**
+ * @def RING_BUFFER_ASYNC_CANCELLED
+ * async operation was removed by ringBufferAsyncCancel.
+ */
+#define RING_BUFFER_ASYNC_CANCELLED 3
+/**
+ * @def RING_BUFFER_ASYNC_TIMEOUT
+ * async operation was timed out by the caller with ringBufferAsyncCancel.
+ */
+#define RING_BUFFER_ASYNC_TIMEOUT   4
+/**
+ * @def RING_BUFFER_ASYNC_ERROR
+ * async operation was refused, NULL ring buffer, op or op buffer.
+ */
+#define RING_BUFFER_ASYNC_ERROR     5
+
+/**
+ * @struct s_ringBufferAsyncOp
+ * @brief A struct type for a queued async read or write.
+ */
+struct s_ringBufferAsyncOp
+{
+  /**
+  * @var s_ringBufferAsyncOp::p_buffer
+  * buffer to read into or write from.
+  */
+  void *p_buffer;
+  /**
+  * @var s_ringBufferAsyncOp::len
+  * number of elements requested.
+  */
+  unsigned long int len;
+  /**
+  * @var s_ringBufferAsyncOp::count
+  * number of elements transferred so far.
+  */
+  unsigned long int count;
+  /**
+  * @var s_ringBufferAsyncOp::status
+  * RING_BUFFER_ASYNC_* status of the operation.
+  */
+  unsigned long int status;
+  /**
+  * @var s_ringBufferAsyncOp::p_callback
+  * called once the operation completes, with the ring buffer mutex held.
+  */
+  void (*p_callback)(struct s_ringBufferAsyncOp *p_op);
+  /**
+  * @var s_ringBufferAsyncOp::p_context
+  * user data for the callback, untouched by the ring buffer.
+  */
+  void *p_context;
+  /**
+  * @var s_ringBufferAsyncOp::p_next
+  * next queued operation, used internally.
+  */
+  struct s_ringBufferAsyncOp *p_next;
+};
+
+/**
+ * @def RING_BUFFER_OVERWRITE_OLDEST
+ * overflow policy, ringBufferWrite drops the oldest unread elements (default).
+ */
+#define RING_BUFFER_OVERWRITE_OLDEST 0
+/**
+ * @def RING_BUFFER_DROP_NEWEST
+ * overflow policy, ringBufferWrite drops the elements that don't fit.
+ */
+#define RING_BUFFER_DROP_NEWEST      1
+/**
+ * @def RING_BUFFER_BLOCK
+ * overflow policy, ringBufferWrite waits like ringBufferBlockingWrite.
+ */
+#define RING_BUFFER_BLOCK            2
+
+/**
+ * @def RING_BUFFER_WAIT_READ
+ * wait set event, ring buffer has data to read or blocking has ended.
+ */
+#define RING_BUFFER_WAIT_READ  1
+/**
+ * @def RING_BUFFER_WAIT_WRITE
+ * wait set event, ring buffer has space to write or blocking has ended.
+ */
+#define RING_BUFFER_WAIT_WRITE 2
+
+/**
+ * @def RING_BUFFER_ALIGN
+ * alignment in bytes of the control block and data laid out by ringBufferInitInPlace, a cache line.
+ */
+#define RING_BUFFER_ALIGN 64
+
+/**
+ * @def RING_BUFFER_COPY_AUTO
+ * copy mode, transfers of at least the threshold stream on write and prefetch on read (default).
+ */
+#define RING_BUFFER_COPY_AUTO     0
+/**
+ * @def RING_BUFFER_COPY_MEMCPY
+ * copy mode, always memcpy.
+ */
+#define RING_BUFFER_COPY_MEMCPY   1
+/**
+ * @def RING_BUFFER_COPY_STREAM
+ * copy mode, non-temporal stores that bypass the cache.
+ */
+#define RING_BUFFER_COPY_STREAM   2
+/**
+ * @def RING_BUFFER_COPY_PREFETCH
+ * copy mode, memcpy with software prefetch of the source.
+ */
+#define RING_BUFFER_COPY_PREFETCH 3
+/**
+ * @def RING_BUFFER_COPY_THRESHOLD
+ * default size in bytes a transfer has to be for RING_BUFFER_COPY_AUTO to stop using memcpy.
+ */
+#define RING_BUFFER_COPY_THRESHOLD (1 << 18)
+
+/**
+ * @def RING_BUFFER_FORMAT_INT8
+ * signed 8 bit samples.
+ */
+#define RING_BUFFER_FORMAT_INT8    1
+/**
+ * @def RING_BUFFER_FORMAT_INT16
+ * signed 16 bit samples.
+ */
+#define RING_BUFFER_FORMAT_INT16   2
+/**
+ * @def RING_BUFFER_FORMAT_INT32
+ * signed 32 bit samples.
+ */
+#define RING_BUFFER_FORMAT_INT32   3
+/**
+ * @def RING_BUFFER_FORMAT_FLOAT32
+ * float samples.
+ */
+#define RING_BUFFER_FORMAT_FLOAT32 4
+/**
+ * @def RING_BUFFER_FORMAT_FLOAT64
+ * double samples.
+ */
+#define RING_BUFFER_FORMAT_FLOAT64 5
+
+/**
+ * @def RING_BUFFER_TRACE_MAGIC
+ * first bytes of a trace file.
+ */
+#define RING_BUFFER_TRACE_MAGIC "RBTRACE"
+/**
+ * @def RING_BUFFER_TRACE_VERSION
+ * version of the trace file records.
+ */
+#define RING_BUFFER_TRACE_VERSION 1
+/**
+ * @def RING_BUFFER_TRACE_WRITE
+ * ringBufferWrite.
+ */
+#define RING_BUFFER_TRACE_WRITE         0
+/**
+ * @def RING_BUFFER_TRACE_READ
+ * ringBufferRead.
+ */
+#define RING_BUFFER_TRACE_READ          1
+/**
+ * @def RING_BUFFER_TRACE_BLOCKING_WRITE
+ * ringBufferBlockingWrite, Until and Convert variants.
+ */
+#define RING_BUFFER_TRACE_BLOCKING_WRITE 2
+/**
+ * @def RING_BUFFER_TRACE_BLOCKING_READ
+ * ringBufferBlockingRead, Until and Convert variants.
+ */
+#define RING_BUFFER_TRACE_BLOCKING_READ  3
+/**
+ * @def RING_BUFFER_TRACE_WRITE_RANGE
+ * ringBufferBlockingWriteRange and Until.
+ */
+#define RING_BUFFER_TRACE_WRITE_RANGE   4
+/**
+ * @def RING_BUFFER_TRACE_READ_RANGE
+ * ringBufferBlockingReadRange and Until.
+ */
+#define RING_BUFFER_TRACE_READ_RANGE    5
+/**
+ * @def RING_BUFFER_TRACE_DONE
+ * the call did all it asked for.
+ */
+#define RING_BUFFER_TRACE_DONE    0
+/**
+ * @def RING_BUFFER_TRACE_SHORT
+ * a non-blocking call did less then it asked for.
+ */
+#define RING_BUFFER_TRACE_SHORT   1
+/**
+ * @def RING_BUFFER_TRACE_TIMEOUT
+ * a blocking call timed out.
+ */
+#define RING_BUFFER_TRACE_TIMEOUT 2
+/**
+ * @def RING_BUFFER_TRACE_ENDED
+ * blocking ended during a blocking call, the rest was done as a non-blocking call.
+ */
+#define RING_BUFFER_TRACE_ENDED   3
+
+struct s_ringBuffer;
+struct s_ringBufferWaitSet;
+struct s_ringBufferBudget;
+
+/**
+ * @struct s_ringBufferWaitEntry
+ * @brief A struct type for one ring buffer registered in a wait set, internal.
+ */
+struct s_ringBufferWaitEntry
+{
+  /**
+  * @var s_ringBufferWaitEntry::p_ringBuffer
+  * ring buffer being watched.
+  */
+  struct s_ringBuffer *p_ringBuffer;
+  /**
+  * @var s_ringBufferWaitEntry::p_waitSet
+  * wait set the ring buffer is registered with.
+  */
+  struct s_ringBufferWaitSet *p_waitSet;
+  /**
+  * @var s_ringBufferWaitEntry::events
+  * RING_BUFFER_WAIT_* events of interest.
+  */
+  unsigned long int events;
+  /**
+  * @var s_ringBufferWaitEntry::p_userData
+  * user data returned with the ready ring buffer.
+  */
+  void *p_userData;
+  /**
+  * @var s_ringBufferWaitEntry::b_queued
+  * true when on the ready list.
+  */
+  unsigned long int b_queued;
+  /**
+  * @var s_ringBufferWaitEntry::p_readyNext
+  * next entry on the wait set ready list.
+  */
+  struct s_ringBufferWaitEntry *p_readyNext;
+  /**
+  * @var s_ringBufferWaitEntry::p_ringNext
+  * next entry for the same ring buffer (other wait sets).
+  */
+  struct s_ringBufferWaitEntry *p_ringNext;
+  /**
+  * @var s_ringBufferWaitEntry::p_setNext
+  * next entry in the same wait set.
+  */
+  struct s_ringBufferWaitEntry *p_setNext;
+};
+
+/**
+ * @struct s_ringBufferWaitSet
+ * @brief A struct type for waiting on many ring buffers at once.
+ */
+struct s_ringBufferWaitSet
+{
+  /**
+  * @var s_ringBufferWaitSet::mutex
+  * protects the ready list, taken after a ring buffer mutex, never before.
+  */
+  pthread_mutex_t mutex;
+  /**
+  * @var s_ringBufferWaitSet::condition
+  * signaled when an entry is added to the ready list.
+  */
+  pthread_cond_t condition;
+  /**
+  * @var s_ringBufferWaitSet::p_readyHead
+  * first ready entry.
+  */
+  struct s_ringBufferWaitEntry *p_readyHead;
+  /**
+  * @var s_ringBufferWaitSet::p_readyTail
+  * last ready entry.
+  */
+  struct s_ringBufferWaitEntry *p_readyTail;
+  /**
+  * @var s_ringBufferWaitSet::p_entries
+  * all entries registered.
+  */
+  struct s_ringBufferWaitEntry *p_entries;
+};
+
+/**
+ * @struct s_ringBufferReady
+ * @brief A struct type for a ready ring buffer returned by ringBufferWaitAny.
+ */
+struct s_ringBufferReady
+{
+  /**
+  * @var s_ringBufferReady::p_ringBuffer
+  * ring buffer that is ready.
+  */
+  struct s_ringBuffer *p_ringBuffer;
+  /**
+  * @var s_ringBufferReady::events
+  * RING_BUFFER_WAIT_* events that are ready.
+  */
+  unsigned long int events;
+  /**
+  * @var s_ringBufferReady::p_userData
+  * user data given to ringBufferWaitSetAdd.
+  */
+  void *p_userData;
+};
+
+/**
+ * @struct s_ringBufferCrcRecord
+ * @brief One write call worth of data in integrity mode.
+ */
+struct s_ringBufferCrcRecord
+{
+  /**
+  * @var s_ringBufferCrcRecord::len
+  * bytes of this write still in the buffer.
+  */
+  unsigned long int len;
+  /**
+  * @var s_ringBufferCrcRecord::crc
+  * CRC32C of the bytes when they were written.
+  */
+  unsigned long int crc;
+  /**
+  * @var s_ringBufferCrcRecord::runningCrc
+  * CRC32C of the bytes read back so far.
+  */
+  unsigned long int runningCrc;
+  /**
+  * @var s_ringBufferCrcRecord::b_valid
+  * false if the crc can't be checked (part of it was overwritten, or it was there before integrity was on).
+  */
+  unsigned long int b_valid;
+};
+
+/**
+ * @struct s_ringBufferCombineRecord
+ * @brief A write published for the combiner, on the writers stack.
+ */
+struct s_ringBufferCombineRecord
+{
+  /**
+  * @var s_ringBufferCombineRecord::p_buffer
+  * data to write.
+  */
+  void *p_buffer;
+  /**
+  * @var s_ringBufferCombineRecord::len
+  * bytes to write.
+  */
+  unsigned long int len;
+  /**
+  * @var s_ringBufferCombineRecord::result
+  * bytes written, set by the combiner.
+  */
+  unsigned long int result;
+  /**
+  * @var s_ringBufferCombineRecord::b_done
+  * Boolean, set once the combiner applied the write. It doesn't touch the record after.
+  */
+  volatile unsigned long int b_done;
+  /**
+  * @var s_ringBufferCombineRecord::p_next
+  * next record on the publication stack.
+  */
+  struct s_ringBufferCombineRecord *p_next;
+};
+
+/**
+ * @struct s_ringBufferTraceHeader
+ * @brief Start of a trace file, the ring buffer the trace was taken on.
+ */
+struct s_ringBufferTraceHeader
+{
+  /**
+  * @var s_ringBufferTraceHeader::magic
+  * RING_BUFFER_TRACE_MAGIC, with its terminator.
+  */
+  char magic[8];
+  /**
+  * @var s_ringBufferTraceHeader::version
+  * RING_BUFFER_TRACE_VERSION.
+  */
+  unsigned long int version;
+  /**
+  * @var s_ringBufferTraceHeader::bufferSize
+  * size of the buffer in elements.
+  */
+  unsigned long int bufferSize;
+  /**
+  * @var s_ringBufferTraceHeader::elementSize
+  * size of an element in bytes.
+  */
+  unsigned long int elementSize;
+  /**
+  * @var s_ringBufferTraceHeader::overflowPolicy
+  * overflow policy when the trace started.
+  */
+  unsigned long int overflowPolicy;
+};
+
+/**
+ * @struct s_ringBufferTraceRecord
+ * @brief One traced call, written as is after the header, in host byte order.
+ */
+struct s_ringBufferTraceRecord
+{
+  /**
+  * @var s_ringBufferTraceRecord::time
+  * nanoseconds from the start of the trace to the call.
+  */
+  unsigned long int time;
+  /**
+  * @var s_ringBufferTraceRecord::duration
+  * nanoseconds the call took, waiting included.
+  */
+  unsigned long int duration;
+  /**
+  * @var s_ringBufferTraceRecord::thread
+  * id of the calling thread, only good for telling threads apart.
+  */
+  unsigned long int thread;
+  /**
+  * @var s_ringBufferTraceRecord::op
+  * RING_BUFFER_TRACE_WRITE, READ, BLOCKING_WRITE, BLOCKING_READ, WRITE_RANGE or READ_RANGE.
+  */
+  unsigned long int op;
+  /**
+  * @var s_ringBufferTraceRecord::outcome
+  * RING_BUFFER_TRACE_DONE, SHORT, TIMEOUT or ENDED.
+  */
+  unsigned long int outcome;
+  /**
+  * @var s_ringBufferTraceRecord::len
+  * elements asked for, the max for a range.
+  */
+  unsigned long int len;
+  /**
+  * @var s_ringBufferTraceRecord::minLen
+  * least elements for a range, same as len otherwise.
+  */
+  unsigned long int minLen;
+  /**
+  * @var s_ringBufferTraceRecord::result
+  * elements written or read.
+  */
+  unsigned long int result;
+  /**
+  * @var s_ringBufferTraceRecord::timeout
+  * nanoseconds a blocking call could wait, 0 for no timeout.
+  */
+  unsigned long int timeout;
+};
+
+/**
+ * @struct s_ringBufferWaiter
+ * @brief A blocked read or write in fairness mode, on the waiting thread's stack.
+ */
+struct s_ringBufferWaiter
+{
+  /**
+  * @var s_ringBufferWaiter::condition
+  * signaled when it is this waiter's turn and its request fits.
+  */
+  pthread_cond_t condition;
+  /**
+  * @var s_ringBufferWaiter::need
+  * bytes of space or data the waiter needs.
+  */
+  unsigned long int need;
+  /**
+  * @var s_ringBufferWaiter::since
+  * CLOCK_MONOTONIC time it started waiting.
+  */
+  struct timespec since;
+  /**
+  * @var s_ringBufferWaiter::b_queued
+  * Boolean, true while it is in a queue.
+  */
+  unsigned long int b_queued;
+  /**
+  * @var s_ringBufferWaiter::p_next
+  * next waiter in line.
+  */
+  struct s_ringBufferWaiter *p_next;
+};
+
+/**
+ * @struct s_ringBufferWindow
+ * @brief A window of data in place, split in two where it wraps around the end of the buffer.
+ */
+struct s_ringBufferWindow
+{
+  /**
+  * @var s_ringBufferWindow::p_first
+  * start of the window.
+  */
+  void *p_first;
+  /**
+  * @var s_ringBufferWindow::firstLen
+  * bytes at p_first.
+  */
+  unsigned long int firstLen;
+  /**
+  * @var s_ringBufferWindow::p_second
+  * rest of the window at the start of the buffer, NULL if it doesn't wrap.
+  */
+  void *p_second;
+  /**
+  * @var s_ringBufferWindow::secondLen
+  * bytes at p_second, 0 if it doesn't wrap.
+  */
+  unsigned long int secondLen;
+};
+
+/**
+ * @struct s_ringBufferConvert
+ * @brief Sample formats for a converting read or write.
+ */
+struct s_ringBufferConvert
+{
+  /**
+  * @var s_ringBufferConvert::ringFormat
+  * RING_BUFFER_FORMAT_* of the samples in the ring buffer, elementSize must be a multiple of it.
+  */
+  unsigned long int ringFormat;
+  /**
+  * @var s_ringBufferConvert::userFormat
+  * RING_BUFFER_FORMAT_* of the samples in the caller's buffer.
+  */
+  unsigned long int userFormat;
+  /**
+  * @var s_ringBufferConvert::scale
+  * every sample is multiplied by this on the way through, 0 is taken as 1.
+  */
+  double scale;
+};
+
 /**
  * @struct s_ringBuffer
  * @brief A struct type for ringbuffer object.
@@ -113,272 +698,1532 @@ struct s_ringBuffer
   
   /**
   * @var s_ringBuffer::p_buffer
-  * pointer allocated with space for storing elements.
+  * pointer allocated with space for storing elements, and one
+  * element of scratch after them for an element split by the end.
   */
   void * volatile p_buffer;
-};
 
-/*********************************************//**
-  * @brief Initializes ring buffer,
-  * creates ring buffer with a minimum size.
+  /**
+  * @var s_ringBuffer::p_asyncReadHead
+  * first queued async read.
+  */
+  struct s_ringBufferAsyncOp *p_asyncReadHead;
+  /**
+  * @var s_ringBuffer::p_asyncReadTail
+  * last queued async read.
+  */
+  struct s_ringBufferAsyncOp *p_asyncReadTail;
+  /**
+  * @var s_ringBuffer::p_asyncWriteHead
+  * first queued async write.
+  */
+  struct s_ringBufferAsyncOp *p_asyncWriteHead;
+  /**
+  * @var s_ringBuffer::p_asyncWriteTail
+  * last queued async write.
+  */
+  struct s_ringBufferAsyncOp *p_asyncWriteTail;
+
+  /**
+  * @var s_ringBuffer::p_waitEntries
+  * wait sets watching this buffer.
+  */
+  struct s_ringBufferWaitEntry *p_waitEntries;
+
+  /**
+  * @var s_ringBuffer::overflowPolicy
+  * what ringBufferWrite does when data doesn't fit, RING_BUFFER_OVERWRITE_OLDEST default.
+  */
+  volatile unsigned long int overflowPolicy;
+  /**
+  * @var s_ringBuffer::dropped
+  * total elements dropped by the overflow policy.
+  */
+  volatile unsigned long int dropped;
+  /**
+  * @var s_ringBuffer::lapped
+  * unread elements overwritten since the reader last asked.
+  */
+  volatile unsigned long int lapped;
+
+  /**
+  * @var s_ringBuffer::b_integrity
+  * Boolean for integrity mode, CRC32C every write and check it on read.
+  */
+  volatile unsigned long int b_integrity;
+  /**
+  * @var s_ringBuffer::crcErrors
+  * total reads that didn't match the CRC32C of their write.
+  */
+  volatile unsigned long int crcErrors;
+  /**
+  * @var s_ringBuffer::p_crcRecords
+  * circular array of records, one per write still in the buffer.
+  */
+  struct s_ringBufferCrcRecord *p_crcRecords;
+  /**
+  * @var s_ringBuffer::crcRecordsSize
+  * number of records p_crcRecords has room for.
+  */
+  unsigned long int crcRecordsSize;
+  /**
+  * @var s_ringBuffer::crcRecordsHead
+  * oldest record.
+  */
+  unsigned long int crcRecordsHead;
+  /**
+  * @var s_ringBuffer::crcRecordsCount
+  * records in use.
+  */
+  unsigned long int crcRecordsCount;
+
+  /**
+  * @var s_ringBuffer::copyMode
+  * how data is copied in and out, RING_BUFFER_COPY_AUTO default.
+  */
+  volatile unsigned long int copyMode;
+  /**
+  * @var s_ringBuffer::copyThreshold
+  * bytes a copy has to be for RING_BUFFER_COPY_AUTO to stream or prefetch.
+  */
+  volatile unsigned long int copyThreshold;
+
+  /**
+  * @var s_ringBuffer::p_memory
+  * block initRingBuffer allocated the object in, NULL when the caller gave the memory.
+  */
+  void *p_memory;
+  /**
+  * @var s_ringBuffer::memFlags
+  * what the object owns and has to free, the object block and/or a buffer resize allocated.
+  */
+  unsigned long int memFlags;
+  /**
+  * @var s_ringBuffer::alignment
+  * alignment in bytes of the data area, a resize keeps it.
+  */
+  unsigned long int alignment;
+
+  /**
+  * @var s_ringBuffer::b_combining
+  * Boolean for write combining, ringBufferWrite publishes and one writer applies them all.
+  */
+  volatile unsigned long int b_combining;
+  /**
+  * @var s_ringBuffer::p_combineHead
+  * publication stack of writes waiting for a combiner.
+  */
+  struct s_ringBufferCombineRecord * volatile p_combineHead;
+
+  /**
+  * @var s_ringBuffer::b_fair
+  * Boolean for fairness mode, blocking reads and writes are served in the order they wait.
+  */
+  volatile unsigned long int b_fair;
+  /**
+  * @var s_ringBuffer::p_writeWaiters
+  * blocked writers, first in line first.
+  */
+  struct s_ringBufferWaiter *p_writeWaiters;
+  /**
+  * @var s_ringBuffer::p_readWaiters
+  * blocked readers, first in line first.
+  */
+  struct s_ringBufferWaiter *p_readWaiters;
+  /**
+  * @var s_ringBuffer::maxWait
+  * longest a fair waiter waited for its turn, in microseconds, since last asked.
+  */
+  unsigned long int maxWait;
+
+  /**
+  * @var s_ringBuffer::p_traceFile
+  * trace file, NULL when not tracing.
+  */
+  FILE * volatile p_traceFile;
+  /**
+  * @var s_ringBuffer::traceStart
+  * CLOCK_MONOTONIC time the trace started.
+  */
+  struct timespec traceStart;
+  /**
+  * @var s_ringBuffer::traceRecords
+  * records written to the trace file.
+  */
+  unsigned long int traceRecords;
+
+  /**
+  * @var s_ringBuffer::p_budget
+  * memory budget the buffer grows into, NULL when it has none.
+  */
+  struct s_ringBufferBudget *p_budget;
+  /**
+  * @var s_ringBuffer::budgetMin
+  * reserved size in bytes, the buffer laid out with the control block.
+  */
+  unsigned long int budgetMin;
+  /**
+  * @var s_ringBuffer::budgetMax
+  * most bytes the buffer may grow to.
+  */
+  unsigned long int budgetMax;
+  /**
+  * @var s_ringBuffer::p_homeBuffer
+  * the reserved buffer, used again once a grown buffer drains.
+  */
+  void *p_homeBuffer;
+  /**
+  * @var s_ringBuffer::waiting
+  * threads waiting on the buffer, their sizes are from before the wait.
+  */
+  unsigned long int waiting;
+  /**
+  * @var s_ringBuffer::segmentsHeld
+  * acquired segments not yet committed, 1 write, 2 read.
+  */
+  unsigned long int segmentsHeld;
+  /**
+  * @var s_ringBuffer::budgetIdle
+  * changes in a row a grown buffer has stayed under its low water mark.
+  */
+  unsigned long int budgetIdle;
+  /**
+  * @var s_ringBuffer::budgetDenied
+  * budget turn downs when it last grew, any more and it shrinks without the run.
+  */
+  unsigned long int budgetDenied;
+  /**
+  * @var s_ringBuffer::budgetWaiting
+  * threads waiting on the budget condition, changes to the buffer wake them too.
+  */
+  unsigned long int budgetWaiting;
+  /**
+  * @var s_ringBuffer::b_budgetShort
+  * the budget turned the last grow down, the next wait is for the budget to give.
+  */
+  unsigned long int b_budgetShort;
+  /**
+  * @var s_ringBuffer::geometry
+  * odd while the buffer, its size and the indexes are swapped, lock free size queries retry on a change.
+  */
+  volatile unsigned long int geometry;
+};
+
+/*********************************************//**
+  * @brief Initializes ring buffer,
+  * creates ring buffer with a minimum size.
+  *
+  * Creates ring buffer size based on buffSize,
+  * which serves as a minimum since this will find
+  * the closest power of two greater then it.
+  * The object and data are one allocation, see
+  * ringBufferInitInPlace.
+  *
+  * @param buffSize a minimum number of elements for
+  * the buffer.
+  * @param elementSize size of each element in the
+  * buffer.
+  * 
+  * @return  Initialized ring buffer object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBuffer *initRingBuffer(unsigned long int const buffSize, unsigned long int const elementSize);
+/*********************************************//**
+  * @brief Initializes aligned ring buffer,
+  * same as initRingBuffer with the data area on a
+  * larger boundary.
+  *
+  * For I/O that needs page or sector aligned memory,
+  * like O_DIRECT. The data area starts on alignment,
+  * and stays on it through a resize. Since the size is
+  * a power of two, every block sized segment from
+  * ringBufferAcquireWrite/Read is aligned as well.
+  *
+  * @param buffSize a minimum number of elements for
+  * the buffer.
+  * @param elementSize size of each element in the
+  * buffer.
+  * @param alignment power of two in bytes, at least
+  * RING_BUFFER_ALIGN. 4096 for a page.
+  *
+  * @return  Initialized ring buffer object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBuffer *initRingBufferAligned(unsigned long int const buffSize, unsigned long int const elementSize, unsigned long int const alignment);
+/*********************************************//**
+  * @brief Destroys ring buffer object.
+  * 
+  * Cleans up memory allocated to the ring buffer.
+  * 
+  * @param iopp_ringBuffer is a double pointer to
+  * the ring buffer object to be freed.
+  *************************************************/
+void freeRingBuffer(struct s_ringBuffer **iopp_ringBuffer);
+/*********************************************//**
+  * @brief In Place Size,
+  * bytes of memory ringBufferInitInPlace needs.
+  *
+  * Room for the control block and the data, the
+  * size rounded up to a power of two like init, plus
+  * one element of scratch and what is needed to align
+  * them to RING_BUFFER_ALIGN.
+  *
+  * @param buffSize number of elements the buffer holds.
+  * @param elementSize size of each element in bytes.
+  *
+  * @return bytes needed, 0 if the sizes are no good.
+  *************************************************/
+unsigned long int ringBufferInPlaceSize(unsigned long int buffSize, unsigned long int elementSize);
+/*********************************************//**
+  * @brief Init In Place,
+  * create a ring buffer in memory the caller gives it.
+  *
+  * The control block and the data area are laid out
+  * in iop_memory, each aligned to RING_BUFFER_ALIGN,
+  * nothing is allocated. freeRingBuffer only destroys
+  * the mutex and condition, the memory stays the
+  * callers. A resize moves the data to memory from
+  * malloc, freeRingBuffer frees that.
+  *
+  * @param iop_memory memory for the ring buffer.
+  * @param memSize size of iop_memory, at least
+  * ringBufferInPlaceSize.
+  * @param buffSize number of elements the buffer holds.
+  * @param elementSize size of each element in bytes.
+  *
+  * @return A pointer to the ring buffer inside
+  * iop_memory, NULL on failure.
+  *************************************************/
+struct s_ringBuffer *ringBufferInitInPlace(void *iop_memory, unsigned long int memSize, unsigned long int buffSize, unsigned long int elementSize);
+/*********************************************//**
+  * @brief Recycle,
+  * put the buffer back the way init left it.
+  *
+  * Empties it, takes it out of any wait sets, cancels
+  * queued async ops, clears the counters and sets the
+  * overflow policy, integrity and copy mode back to
+  * their defaults. Memory, mutex and condition are
+  * kept for the next user. Nothing may be blocked on
+  * it.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  *************************************************/
+void ringBufferRecycle(struct s_ringBuffer * const iop_ringBuffer);
+/*********************************************//**
+  * @brief Empty Test,
+  * is the buffer empty?
+  *
+  * Check if the ring buffer is empty by checking
+  * if the head index is equal to the tail index.
+  * Lock-free, see getRingBufferReadSize.
+  *
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  * 
+  * @return Is the ring buffer empty.
+  *************************************************/
+unsigned long int ringBufferIsEmpty(struct s_ringBuffer * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Full Test,
+  * is the buffer full?
+  *
+  * Check if the ring buffer is full by checking
+  * if the head index is one below the tail index.
+  * Lock-free, see getRingBufferWriteSize.
+  * 
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return Is the ring buffer full.
+  *************************************************/
+unsigned long int ringBufferIsFull(struct s_ringBuffer * const ip_ringBuffer);
+/********************************************//**
+  * @brief Check End Blocking Flag,
+  * have the blocking r/w methods been disabled?
+  *
+  * Return the flag that tells us if blocking is
+  * still allowed. True we are blocking, false
+  * the blocking is disabled. Lock-free, an acquire
+  * load of the flag.
+  * 
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return Has blocking functions been disabled.
+  ************************************************/
+unsigned long int ringBufferStillBlocking(struct s_ringBuffer * const ip_ringBuffer);
+/********************************************//**
+  * @brief Check if End Blocking flag is set and,
+  * there are any bytes in the buffer.
+  *
+  * Return the flag that tells us if blocking is
+  * still allowed and there are bytes. True no
+  * more blocking, and no more bytes left.
+  * Lock-free. The flag is loaded first, so once it
+  * returns false everything written before blocking
+  * ended has been read, safe as a loop condition.
+  *
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return True if blocking or data bytes exist.
+  ************************************************/
+unsigned long int ringBufferIsAlive(struct s_ringBuffer * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Get Write Size,
+  * the amount of available elements to write.
+  *
+  * Lock-free, head and tail are loaded as a pair
+  * that was true at one point during the call, so it
+  * never blocks readers or writers. From the writing
+  * thread it is the least a following write gets.
+  * 
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The number of elements that can be written.
+  *************************************************/
+unsigned long int getRingBufferWriteSize(struct s_ringBuffer * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Get Write Size,
+  * the amount of available bytes to write.
+  *
+  * Lock-free, head and tail are loaded as a pair
+  * that was true at one point during the call, so it
+  * never blocks readers or writers. From the writing
+  * thread it is the least a following write gets.
+  * 
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The number of elements that can be written.
+  *************************************************/
+unsigned long int getRingBufferWriteByteSize(struct s_ringBuffer * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Get Read Size,
+  * the amount of available elements to read.
+  *
+  * Lock-free, head and tail are loaded as a pair
+  * that was true at one point during the call, so it
+  * never blocks readers or writers. From the reading
+  * thread it is the least a following read gets.
+  *
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  * 
+  * @return The number of elements that can be read.
+  *************************************************/
+unsigned long int getRingBufferReadSize(struct s_ringBuffer * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Get Read Size,
+  * the amount of available bytes to read.
+  *
+  * Lock-free, head and tail are loaded as a pair
+  * that was true at one point during the call, so it
+  * never blocks readers or writers. From the reading
+  * thread it is the least a following read gets.
+  *
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  * 
+  * @return The number of elements that can be read.
+  *************************************************/
+unsigned long int getRingBufferReadByteSize(struct s_ringBuffer * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Get buffer element size in bytes.
+  *
+  * Return element size created by constructor.
+  * 
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The size of the element in bytes.
+  *************************************************/
+unsigned long int getRingBufferElementSize(struct s_ringBuffer const * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Get Buffer Size, in bytes.
+  *
+  * Return buffer size in bytes, created by constructor.
+  * 
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The total size of the buffer in bytes.
+  *************************************************/
+unsigned long int getRingBufferByteSize(struct s_ringBuffer const * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Get Buffer Size,
+  * the capacity in elements of the buffer.
+  *
+  * Return buffer size created by constructor.
+  * 
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The total size of the buffer.
+  *************************************************/
+unsigned long int getRingBufferSize(struct s_ringBuffer const * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Resize Buffer,
+  * to fit a new capcity, or we run out of space.
+  * You can shrink the buffer, and the indexs will
+  * be updated. A ring buffer on a budget sizes
+  * itself, it can't be resized. Neither can one with
+  * an acquired segment not yet committed.
+  * 
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param bufferSize is the new size for the buffer
+  * @param elementSize is the new elementSize
+  * 
+  * @return The total size of the buffer.
+  *************************************************/
+unsigned long int ringBufferResize(struct s_ringBuffer * const iop_ringBuffer, unsigned long int bufferSize, unsigned long int elementSize);
+/*********************************************//**
+  * @brief Blocking Write,
+  * write all data without destroying data in buffer.
+  *
+  * Write to ring buffer, but don't overwrite its
+  * contents. Will continually write till all is
+  * data is written. This also has a timeout available
+  * if it needs to end in a certain amount of time.
+  * There is also a endBlocking call which sets a
+  * bool that ends all blocking calls and calls
+  * non blocking write instead.
+  * 
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param ip_buffer an input buffer to use as input
+  * to the ring buffer (write to).
+  * @param len the length of the input buffer in elements.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferBlockingWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Write Until,
+  * same as ringBufferBlockingWrite, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. Waking up early and waiting
+  * again never moves it. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferBlockingWriteUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Blocking Read,
+  * read all data in buffer, wait till amount requested
+  * is reached.
+  *
+  * Read from ring buffer, but keep reading till
+  * we get all of the data. This also has a timeout
+  * available if it needs to end in a certain amount
+  * of time. There is also a endBlocking call which
+  * sets a bool that ends all blocking calls and calls
+  * non blocking read instead.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param op_buffer an output buffer that the ring
+  * buffer puts data into (read data from buffer).
+  * @param len the number of elements to be read.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferBlockingRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Read Until,
+  * same as ringBufferBlockingRead, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. Waking up early and waiting
+  * again never moves it. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferBlockingReadUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Blocking Write Range,
+  * wait till at least minElems fit, then write up
+  * to maxElems.
+  *
+  * Waits like ringBufferBlockingWrite, but only till
+  * there is room for minElems. Then writes as many as
+  * fit, up to maxElems, in the same critical section.
+  * If blocking is ended the rest is written with
+  * ringBufferWrite. If it times out nothing is written.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param ip_buffer an input buffer that the ring
+  * buffer takes data from (write data to buffer).
+  * @param minElems the number of elements to wait for room for.
+  * @param maxElems the max number of elements to write.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferBlockingWriteRange(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Write Range Until,
+  * same as ringBufferBlockingWriteRange, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. Waking up early and waiting
+  * again never moves it. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferBlockingWriteRangeUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Blocking Read Range,
+  * wait till at least minElems are available, then
+  * read up to maxElems.
+  *
+  * Waits like ringBufferBlockingRead, but only till
+  * minElems are in the buffer. Then reads as many as
+  * are there, up to maxElems, in the same critical
+  * section. Small minElems give low latency, large
+  * ones give big batches. If blocking is ended whatever
+  * is left is read. If it times out nothing is read.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param op_buffer an output buffer that the ring
+  * buffer puts data into (read data from buffer).
+  * @param minElems the number of elements to wait for.
+  * @param maxElems the max number of elements to read.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferBlockingReadRange(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Read Range Until,
+  * same as ringBufferBlockingReadRange, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. Waking up early and waiting
+  * again never moves it. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferBlockingReadRangeUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Write to the buffer,
+  * write all data regardless if it destroys data in buffer.
+  *
+  * Write to the buffer the amount of data provided
+  * by len. What happens when it doesn't fit is up to
+  * the overflow policy. RING_BUFFER_OVERWRITE_OLDEST
+  * (default) moves the tail past the oldest whole
+  * elements, so the buffer always holds the newest
+  * data. If len is larger then the buffer only the
+  * newest buffer worth is kept. While a read segment
+  * is acquired it drops the newest instead, the reader
+  * still owns the oldest data. RING_BUFFER_DROP_NEWEST
+  * writes what fits and drops the rest. RING_BUFFER_BLOCK
+  * calls ringBufferBlockingWrite. Dropped elements are
+  * counted, see getRingBufferDropped.
+  * Only blocking is waiting for the r/w shared
+  * mutex.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param ip_buffer an input buffer to use as input
+  * to the ring buffer (write to).
+  * @param len the length of the input buffer in elements.
+  * @return The number of elements written, dropped
+  * newest elements are not included.
+  *************************************************/
+unsigned long int ringBufferWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len);
+/*********************************************//**
+  * @brief Read from the buffer,
+  * read data available, up to length request.
+  *
+  * Read data up to length, if no more data exists
+  * just return the amount read and finish.
+  * Only blocking is waiting for the r/w shared
+  * mutex.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param op_buffer an output buffer that the ring
+  * buffer puts data into (read data from buffer).
+  * @param len the number of elements to be read.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len);
+/*********************************************//**
+  * @brief Set Overflow Policy,
+  * what ringBufferWrite does when data doesn't fit.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param policy RING_BUFFER_OVERWRITE_OLDEST,
+  * RING_BUFFER_DROP_NEWEST or RING_BUFFER_BLOCK.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+unsigned long int ringBufferSetOverflowPolicy(struct s_ringBuffer * const iop_ringBuffer, unsigned long int policy);
+/*********************************************//**
+  * @brief Get Dropped,
+  * total elements dropped by the overflow policy.
+  *
+  * @param ip_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The number of elements dropped since init.
+  *************************************************/
+unsigned long int getRingBufferDropped(struct s_ringBuffer * const ip_ringBuffer);
+/*********************************************//**
+  * @brief Lapped Test,
+  * did the writer overwrite data we had not read?
+  *
+  * Returns the number of unread elements overwritten
+  * since the last call, and clears it. Meant for the
+  * reader to find gaps in the stream.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The number of unread elements lost.
+  *************************************************/
+unsigned long int ringBufferLapped(struct s_ringBuffer * const iop_ringBuffer);
+/*********************************************//**
+  * @brief Set Fairness,
+  * serve blocked writers and readers in the order they wait.
+  *
+  * Off, a change wakes whichever thread the condition
+  * picks, and a large write can be passed forever by
+  * small writes that fit first. On, each blocked
+  * ringBufferBlockingWrite/Read (and the Until and
+  * Convert variants), range, drain, window and segment
+  * acquire call takes its place in line, and only the
+  * first in line is woken, once its minimum fits.
+  * No one waits on a waiter that came after it. Non-
+  * blocking calls don't wait, so they don't queue.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param b_enable 1 for first come first served, 0
+  * for the condition to pick (default).
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+int ringBufferSetFairness(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_enable);
+/*********************************************//**
+  * @brief Max Wait,
+  * longest a fair waiter waited for its turn.
+  *
+  * Time from when a blocked read or write got in
+  * line to when it could go, in fairness mode.
+  * Returns the longest since the last call, and
+  * clears it.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return The longest wait in microseconds.
+  *************************************************/
+unsigned long int ringBufferMaxWait(struct s_ringBuffer * const iop_ringBuffer);
+/*********************************************//**
+  * @brief Trace Start,
+  * record the reads and writes to a trace file.
+  *
+  * Every ringBufferWrite/Read, blocking read/write
+  * (Until and Convert variants) and blocking range
+  * call is written to the file as a
+  * s_ringBufferTraceRecord, after a
+  * s_ringBufferTraceHeader. Records are written in
+  * the order the calls finished, under the buffer
+  * lock, through a stdio buffer. When blocking ends
+  * during a blocking call, what it did blocking is
+  * one record, and the rest done by policy another.
+  * Drains, windows, segments and async calls are not
+  * traced. The trace_replay example plays a trace
+  * back against any ring buffer configuration.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param ip_fileName file to write the trace to,
+  * any trace already running is stopped first.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+int ringBufferTraceStart(struct s_ringBuffer * const iop_ringBuffer, char const * const ip_fileName);
+/*********************************************//**
+  * @brief Trace Stop,
+  * flush and close the trace file.
+  *
+  * freeRingBuffer stops a running trace.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  *
+  * @return Number of records written, 0 if not
+  * tracing.
+  *************************************************/
+unsigned long int ringBufferTraceStop(struct s_ringBuffer * const iop_ringBuffer);
+/*********************************************//**
+  * @brief Drain the buffer in place,
+  * process data available, up to length request,
+  * without copying it out.
+  *
+  * Calls p_drainFunc on the readable data where it
+  * sits in the buffer. Since the data may wrap around
+  * the end of the buffer, the function is called once
+  * per contiguous segment (at most twice, three times
+  * if an element straddles the wrap, that element is
+  * passed by itself in a temporary copy). The function
+  * returns how many of the elements given it consumed,
+  * the tail only advances by that much. If it consumes
+  * less then it was given draining stops there.
+  * The function runs with the ring buffer mutex held, it
+  * must not call into the ring buffer.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param maxElems the max number of elements to drain.
+  * @param p_drainFunc called with a pointer to the data,
+  * the number of elements there and p_context. Returns the
+  * number of elements consumed.
+  * @param p_context user data passed to p_drainFunc.
+  * @return The number of elements consumed.
+  *************************************************/
+unsigned long int ringBufferDrain(struct s_ringBuffer * const iop_ringBuffer, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context);
+/*********************************************//**
+  * @brief Blocking Drain,
+  * wait till at least minElems are available, then
+  * drain in place.
+  *
+  * Waits like ringBufferBlockingRead till minElems are
+  * in the buffer, then calls ringBufferDrain for up to
+  * maxElems in the same critical section. If blocking
+  * is ended whatever is left is drained. If it times out
+  * nothing is drained.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param minElems the number of elements to wait for.
+  * @param maxElems the max number of elements to drain.
+  * @param p_drainFunc see ringBufferDrain.
+  * @param p_context user data passed to p_drainFunc.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements consumed.
+  *************************************************/
+unsigned long int ringBufferBlockingDrain(struct s_ringBuffer * const iop_ringBuffer, unsigned long int minElems, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Drain Until,
+  * same as ringBufferBlockingDrain, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. Waking up early and waiting
+  * again never moves it. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return The number of elements consumed.
+  *************************************************/
+unsigned long int ringBufferBlockingDrainUntil(struct s_ringBuffer * const iop_ringBuffer, unsigned long int minElems, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Read Window,
+  * copy out a full window but only consume the hop.
+  *
+  * For overlapped framing, like FFT overlap-add. The
+  * window of windowElems elements at the tail is copied
+  * to op_buffer and the tail moves by hopElems, so the
+  * next call sees the last windowElems - hopElems
+  * elements again without the caller keeping a history
+  * buffer. A hop larger then the window skips the
+  * elements in between. Nothing is read unless the
+  * whole window (and hop) is in the buffer.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param op_buffer buffer of at least windowElems elements.
+  * @param windowElems the number of elements in a window.
+  * @param hopElems the number of elements to consume.
+  * @return windowElems, or 0 if there wasn't a full window.
+  *************************************************/
+unsigned long int ringBufferReadWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems);
+/*********************************************//**
+  * @brief Blocking Read Window,
+  * wait for a full window, then ringBufferReadWindow.
+  *
+  * If blocking is ended a window is still read if there
+  * is a full one left. If it times out nothing is read.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param op_buffer buffer of at least windowElems elements.
+  * @param windowElems the number of elements in a window.
+  * @param hopElems the number of elements to consume.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return windowElems, or 0 if there wasn't a full window.
+  *************************************************/
+unsigned long int ringBufferBlockingReadWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Read Window Until,
+  * same as ringBufferBlockingReadWindow, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return windowElems, or 0 if there wasn't a full window.
+  *************************************************/
+unsigned long int ringBufferBlockingReadWindowUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Drain Window,
+  * ringBufferReadWindow without the copy.
+  *
+  * Calls p_windowFunc with the window where it sits
+  * in the buffer, as one or two segments in bytes (an
+  * element may be split between them). If it returns
+  * non-zero the tail moves by hopElems, 0 leaves the
+  * buffer as it was so the window can be looked at
+  * without consuming it. The function runs with the
+  * ring buffer mutex held, it must not call into the
+  * ring buffer.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param windowElems the number of elements in a window.
+  * @param hopElems the number of elements to consume.
+  * @param p_windowFunc called with the window and p_context.
+  * @param p_context user data passed to p_windowFunc.
+  * @return windowElems, or 0 if there wasn't a full window.
+  *************************************************/
+unsigned long int ringBufferDrainWindow(struct s_ringBuffer * const iop_ringBuffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context);
+/*********************************************//**
+  * @brief Blocking Drain Window,
+  * wait for a full window, then ringBufferDrainWindow.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param windowElems the number of elements in a window.
+  * @param hopElems the number of elements to consume.
+  * @param p_windowFunc see ringBufferDrainWindow.
+  * @param p_context user data passed to p_windowFunc.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return windowElems, or 0 if there wasn't a full window.
+  *************************************************/
+unsigned long int ringBufferBlockingDrainWindow(struct s_ringBuffer * const iop_ringBuffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Drain Window Until,
+  * same as ringBufferBlockingDrainWindow, with an absolute deadline.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return windowElems, or 0 if there wasn't a full window.
+  *************************************************/
+unsigned long int ringBufferBlockingDrainWindowUntil(struct s_ringBuffer * const iop_ringBuffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Acquire Write,
+  * wait for free space at the head, in whole blocks.
+  *
+  * Gives the contiguous free space at the head, up
+  * to the end of the buffer, rounded down to a
+  * multiple of blockSize. If a partial commit or a
+  * plain write left the head off a block boundary,
+  * once a block is free in total the run of less then
+  * a block up to the end of the buffer is given, so
+  * the next segment starts on a block at the front
+  * again. Nothing moves till
+  * ringBufferCommitWrite, the caller fills the
+  * segment without the mutex, a read() or pread()
+  * can go straight into it. With initRingBufferAligned
+  * and commits of whole blocks every segment starts
+  * aligned. One writer at a time, and no overwriting
+  * writes while a segment is out.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param op_segment set to the start of the segment.
+  * @param blockSize bytes in a block, a multiple of the
+  * element size that divides the buffer size.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long, 0 time polls.
+  * @return bytes in the segment, 0 if there was no
+  * block free before blocking ended or timed out.
+  *************************************************/
+unsigned long int ringBufferAcquireWrite(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Acquire Write Until,
+  * same as ringBufferAcquireWrite, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return bytes in the segment, 0 if there was no
+  * block free before blocking ended or timed out.
+  *************************************************/
+unsigned long int ringBufferAcquireWriteUntil(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Commit Write,
+  * move the head past bytes written to an acquired segment.
+  *
+  * The data is readable once this returns. In
+  * integrity mode its CRC32C is recorded here.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param len bytes written, a multiple of the element
+  * size no larger then the segment.
+  * @return 1 on success, 0 on error.
+  *************************************************/
+unsigned long int ringBufferCommitWrite(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len);
+/*********************************************//**
+  * @brief Acquire Read,
+  * wait for data at the tail, in whole blocks.
+  *
+  * Gives the contiguous data at the tail, up to the
+  * end of the buffer, rounded down to a multiple of
+  * blockSize. If the tail is off a block boundary,
+  * once a block is readable in total the run of less
+  * then a block up to the end of the buffer is given,
+  * the same as ringBufferAcquireWrite. Once blocking
+  * ends whatever is left
+  * is given even if it is less then a block, so the
+  * end of a stream isn't stuck. Nothing moves till
+  * ringBufferCommitRead, the caller can write() the
+  * segment out without the mutex. One reader at a
+  * time.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param op_segment set to the start of the segment.
+  * @param blockSize bytes in a block, a multiple of the
+  * element size that divides the buffer size.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long, 0 time polls.
+  * @return bytes in the segment, 0 if blocking ended
+  * and the buffer is empty, or it timed out.
+  *************************************************/
+unsigned long int ringBufferAcquireRead(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Acquire Read Until,
+  * same as ringBufferAcquireRead, with an absolute deadline.
+  *
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. The other arguments are the
+  * same as the relative call.
+  *
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return bytes in the segment, 0 if blocking ended
+  * and the buffer is empty, or it timed out.
+  *************************************************/
+unsigned long int ringBufferAcquireReadUntil(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Commit Read,
+  * move the tail past bytes used from an acquired segment.
   *
-  * Creates ring buffer size based on buffSize,
-  * which serves as a minimum since this will find
-  * the closest power of two greater then it.
+  * The space is free for writers once this returns.
+  * In integrity mode the data is checked here, like
+  * any other read.
   *
-  * @param buffSize a minimum number of elements for
-  * the buffer.
-  * @param elementSize size of each element in the
-  * buffer.
-  * 
-  * @return  Initialized ring buffer object, or NULL
-  * on error.
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param len bytes used, a multiple of the element
+  * size no larger then the segment.
+  * @return 1 on success, 0 on error.
   *************************************************/
-struct s_ringBuffer *initRingBuffer(unsigned long int const buffSize, unsigned long int const elementSize);
+unsigned long int ringBufferCommitRead(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len);
 /*********************************************//**
-  * @brief Destroys ring buffer object.
-  * 
-  * Cleans up memory allocated to the ring buffer.
-  * 
-  * @param iopp_ringBuffer is a double pointer to
-  * the ring buffer object to be freed.
+  * @brief Write Convert,
+  * non-blocking write, converting the samples as they
+  * are copied in.
+  *
+  * Same as ringBufferWrite, but the input is in the
+  * user format of ip_convert and goes into the buffer
+  * in the ring format, in the same pass as the copy.
+  * len still counts ring buffer elements, each element
+  * is elementSize / (ring format size) samples, so
+  * ip_buffer holds that many samples of the user format
+  * per element. Integer formats are rounded to nearest
+  * and saturated. Only writes what fits, the overflow
+  * policy doesn't apply.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param ip_buffer samples in the user format.
+  * @param len number of elements to write.
+  * @param ip_convert formats and scale.
+  * @return The number of elements written.
   *************************************************/
-void freeRingBuffer(struct s_ringBuffer **iopp_ringBuffer);
+unsigned long int ringBufferWriteConvert(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert);
 /*********************************************//**
-  * @brief Empty Test,
-  * is the buffer empty?
+  * @brief Read Convert,
+  * non-blocking read, converting the samples as they
+  * are copied out.
   *
-  * Check if the ring buffer is empty by checking
-  * if the head index is equal to the tail index.
+  * Same as ringBufferRead, but the samples in the buffer
+  * in the ring format come out in the user format of
+  * ip_convert. len counts ring buffer elements, as for
+  * ringBufferWriteConvert.
   *
-  * @param ip_ringBuffer is the ring buffer object
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
-  * 
-  * @return Is the ring buffer empty.
+  * @param op_buffer space for the samples in the user format.
+  * @param len number of elements to read.
+  * @param ip_convert formats and scale.
+  * @return The number of elements read.
   *************************************************/
-unsigned long int ringBufferIsEmpty(struct s_ringBuffer * const ip_ringBuffer);
+unsigned long int ringBufferReadConvert(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert);
 /*********************************************//**
-  * @brief Full Test,
-  * is the buffer full?
+  * @brief Blocking Write Convert,
+  * ringBufferBlockingWrite that converts like
+  * ringBufferWriteConvert.
   *
-  * Check if the ring buffer is full by checking
-  * if the head index is one below the tail index.
-  * 
-  * @param ip_ringBuffer is the ring buffer object
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
+  * @param ip_buffer samples in the user format.
+  * @param len number of elements to write.
+  * @param ip_convert formats and scale.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferBlockingWriteConvert(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Write Convert Until,
+  * same as ringBufferBlockingWriteConvert, with an absolute deadline.
   *
-  * @return Is the ring buffer full.
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return The number of elements written.
   *************************************************/
-unsigned long int ringBufferIsFull(struct s_ringBuffer * const ip_ringBuffer);
-/********************************************//**
-  * @brief Check End Blocking Flag,
-  * have the blocking r/w methods been disabled?
+unsigned long int ringBufferBlockingWriteConvertUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Blocking Read Convert,
+  * ringBufferBlockingRead that converts like
+  * ringBufferReadConvert.
   *
-  * Return the flag that tells us if blocking is
-  * still allowed. True we are blocking, false
-  * the blocking is disabled.
-  * 
-  * @param ip_ringBuffer is the ring buffer object
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
+  * @param op_buffer space for the samples in the user format.
+  * @param len number of elements to read.
+  * @param ip_convert formats and scale.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferBlockingReadConvert(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Read Convert Until,
+  * same as ringBufferBlockingReadConvert, with an absolute deadline.
   *
-  * @return Has blocking functions been disabled.
-  ************************************************/
-unsigned long int ringBufferStillBlocking(struct s_ringBuffer * const ip_ringBuffer);
-/********************************************//**
-  * @brief Check if End Blocking flag is set and,
-  * there are any bytes in the buffer.
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferBlockingReadConvertUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Read Deinterleave,
+  * non-blocking read straight into one array per channel.
   *
-  * Return the flag that tells us if blocking is
-  * still allowed and there are bytes. True no
-  * more blocking, and no more bytes left.
+  * The buffer holds frames of numChannels samples of
+  * sampleSize bytes each, elementSize must be a whole
+  * number of frames. Each channel array gets the
+  * channel's samples of every frame read, in order, so
+  * len elements put len * elementSize / (numChannels *
+  * sampleSize) samples in each. A frame split by the
+  * end of the buffer is handled. 2, 4 and 8 channels
+  * of 2 or 4 byte samples use SIMD shuffles.
   *
-  * @param ip_ringBuffer is the ring buffer object
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
+  * @param op_channels numChannels pointers to the channel arrays.
+  * @param numChannels number of channels in a frame.
+  * @param sampleSize bytes in one sample.
+  * @param len number of elements to read.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferReadDeinterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *op_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len);
+/*********************************************//**
+  * @brief Write Interleave,
+  * non-blocking write straight from one array per channel.
   *
-  * @return True if blocking or data bytes exist.
-  ************************************************/
-unsigned long int ringBufferIsAlive(struct s_ringBuffer * const ip_ringBuffer);
+  * The reverse of ringBufferReadDeinterleave. Only
+  * writes what fits, the overflow policy doesn't apply.
+  *
+  * @param iop_ringBuffer is the ring buffer object
+  * to operate on.
+  * @param ip_channels numChannels pointers to the channel arrays.
+  * @param numChannels number of channels in a frame.
+  * @param sampleSize bytes in one sample.
+  * @param len number of elements to write.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferWriteInterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *ip_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len);
 /*********************************************//**
-  * @brief Get Write Size,
-  * the amount of available elements to write.
+  * @brief Integrity Mode,
+  * CRC32C the data on write and check it on read.
   *
-  * Uses a mutex lock to keep from getting stale
-  * data. Uses writeSize to get current write size.
-  * 
-  * @param ip_ringBuffer is the ring buffer object
+  * Each write records the CRC32C of its data, computed
+  * as it is copied in. Reads and drains check the data
+  * against it as it is copied out, a mismatch counts as a
+  * CRC error. Data already in the buffer when this is
+  * turned on, or partly overwritten by the overflow
+  * policy, isn't checked.
+  *
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
+  * @param b_enable true to turn integrity mode on.
   *
-  * @return The number of elements that can be written.
+  * @return 1 on success, 0 on error.
   *************************************************/
-unsigned long int getRingBufferWriteSize(struct s_ringBuffer * const ip_ringBuffer);
+int ringBufferSetIntegrity(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_enable);
 /*********************************************//**
-  * @brief Get Write Size,
-  * the amount of available bytes to write.
+  * @brief Get CRC Errors,
+  * total reads that failed the integrity check.
   *
-  * Uses a mutex lock to keep from getting stale
-  * data. Uses writeSize to get current write size.
-  * 
   * @param ip_ringBuffer is the ring buffer object
   * to operate on.
   *
-  * @return The number of elements that can be written.
+  * @return The number of CRC errors since init.
   *************************************************/
-unsigned long int getRingBufferWriteByteSize(struct s_ringBuffer * const ip_ringBuffer);
+unsigned long int getRingBufferCrcErrors(struct s_ringBuffer * const ip_ringBuffer);
 /*********************************************//**
-  * @brief Get Read Size,
-  * the amount of available elements to read.
+  * @brief Read with CRC,
+  * read data available, and its CRC32C.
   *
-  * Uses a mutex lock to keep from getting stale
-  * data. Uses readSize to get current read size.
+  * Same as ringBufferRead, op_crc is updated with the
+  * data read as it is copied out. Start it at 0, pass it
+  * back in to chain reads.
   *
-  * @param ip_ringBuffer is the ring buffer object
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
-  * 
-  * @return The number of elements that can be read.
+  * @param op_buffer output buffer to store read data.
+  * @param len length of the output buffer in elements.
+  * @param op_crc CRC32C to update, may be NULL.
+  *
+  * @return The number of elements read.
   *************************************************/
-unsigned long int getRingBufferReadSize(struct s_ringBuffer * const ip_ringBuffer);
+unsigned long int ringBufferReadCrc(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, unsigned long int *op_crc);
 /*********************************************//**
-  * @brief Get Read Size,
-  * the amount of available bytes to read.
+  * @brief CRC32C,
+  * Castagnoli CRC of a block of memory.
   *
-  * Uses a mutex lock to keep from getting stale
-  * data. Uses readSize to get current read size.
+  * Uses SSE4.2 or ARMv8 CRC instructions when it can.
+  * Start crc at 0, pass the result back in to continue
+  * over more data.
   *
-  * @param ip_ringBuffer is the ring buffer object
-  * to operate on.
-  * 
-  * @return The number of elements that can be read.
+  * @param crc CRC of the data before this block.
+  * @param ip_data data to checksum.
+  * @param len length of the data in bytes.
+  *
+  * @return The updated CRC.
   *************************************************/
-unsigned long int getRingBufferReadByteSize(struct s_ringBuffer * const ip_ringBuffer);
+unsigned long int ringBufferCrc32c(unsigned long int crc, void const *ip_data, unsigned long int len);
 /*********************************************//**
-  * @brief Get buffer element size in bytes.
+  * @brief CRC32C Copy,
+  * memcpy that returns the CRC32C of what it copied.
   *
-  * Return element size created by constructor.
-  * 
-  * @param ip_ringBuffer is the ring buffer object
-  * to operate on.
+  * The data is checksumed as it is copied, so it is
+  * only read once.
   *
-  * @return The size of the element in bytes.
+  * @param op_dest where to copy to.
+  * @param ip_src where to copy from.
+  * @param len length of the data in bytes.
+  * @param crc CRC of the data before this block.
+  *
+  * @return The updated CRC.
   *************************************************/
-unsigned long int getRingBufferElementSize(struct s_ringBuffer const * const ip_ringBuffer);
+unsigned long int ringBufferCrc32cCopy(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc);
 /*********************************************//**
-  * @brief Get Buffer Size, in bytes.
+  * @brief Set Copy Mode,
+  * pick how data is copied in and out of the buffer.
   *
-  * Return buffer size in bytes, created by constructor.
-  * 
-  * @param ip_ringBuffer is the ring buffer object
+  * RING_BUFFER_COPY_AUTO uses memcpy for small copies.
+  * Copies of threshold bytes or more are streamed into
+  * the buffer, so a buffer larger then the cache doesn't
+  * evict the producer's data, and prefetched out of it.
+  * The other modes are used for every copy. Integrity
+  * mode copies with its CRC kernel instead.
+  *
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
+  * @param mode one of the RING_BUFFER_COPY modes.
+  * @param threshold bytes for RING_BUFFER_COPY_AUTO, 0
+  * for RING_BUFFER_COPY_THRESHOLD.
   *
-  * @return The total size of the buffer in bytes.
+  * @return 1 on success, 0 on error.
   *************************************************/
-unsigned long int getRingBufferByteSize(struct s_ringBuffer const * const ip_ringBuffer);
+int ringBufferSetCopyMode(struct s_ringBuffer * const iop_ringBuffer, unsigned long int mode, unsigned long int threshold);
 /*********************************************//**
-  * @brief Get Buffer Size,
-  * the capacity in elements of the buffer.
+  * @brief Set Write Combining,
+  * flat combining for ringBufferWrite.
   *
-  * Return buffer size created by constructor.
-  * 
-  * @param ip_ringBuffer is the ring buffer object
+  * For many threads writing small records. Each
+  * write is published on a lock-free stack, whichever
+  * writer gets the mutex applies every published write
+  * in one critical section with one wakeup, the rest
+  * spin briefly till theirs is done. Each thread's
+  * writes stay in the order it made them, and the
+  * overflow policy applies to each write like before.
+  * With RING_BUFFER_BLOCK writes block as usual
+  * and aren't combined.
+  *
+  * @param iop_ringBuffer is the ring buffer object
   * to operate on.
+  * @param b_enable 1 to combine writes, 0 to lock for
+  * each one (default).
   *
-  * @return The total size of the buffer.
+  * @return 1 on success, 0 on error.
   *************************************************/
-unsigned long int getRingBufferSize(struct s_ringBuffer const * const ip_ringBuffer);
+int ringBufferSetWriteCombining(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_enable);
 /*********************************************//**
-  * @brief Resize Buffer,
-  * to fit a new capcity, or we run out of space.
-  * You can shrink the buffer, and the indexs will
-  * be updated.
-  * 
+  * @brief Copy,
+  * memcpy with the kernel for a copy mode.
+  *
+  * RING_BUFFER_COPY_STREAM uses the widest non-temporal
+  * store the CPU has (AVX-512, AVX2, SSE2), memcpy if
+  * there are none. RING_BUFFER_COPY_AUTO is memcpy here.
+  *
+  * @param op_dest where to copy to.
+  * @param ip_src where to copy from.
+  * @param len length of the data in bytes.
+  * @param mode one of the RING_BUFFER_COPY modes.
+  *
+  * @return op_dest
+  *************************************************/
+void *ringBufferCopy(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int mode);
+/*********************************************//**
+  * @brief Format Size,
+  * bytes in one sample.
+  *
+  * @param format RING_BUFFER_FORMAT_*.
+  * @return size in bytes, 0 if the format is unknown.
+  *************************************************/
+unsigned long int ringBufferFormatSize(unsigned long int format);
+/*********************************************//**
+  * @brief Convert,
+  * the conversion kernel the converting read and write
+  * use, for converting outside of a ring buffer.
+  *
+  * int16, int32 and float32 to float32, and float32 to
+  * int16, use the widest of SSE2, AVX2 or NEON the CPU
+  * has. Other pairs convert through double. Integer
+  * results are rounded to nearest, ties to even, and
+  * saturated.
+  *
+  * @param op_dest count samples of destFormat.
+  * @param destFormat RING_BUFFER_FORMAT_* to convert to.
+  * @param ip_src count samples of srcFormat.
+  * @param srcFormat RING_BUFFER_FORMAT_* to convert from.
+  * @param count number of samples.
+  * @param scale multiplied into every sample, 0 is taken as 1.
+  * @return op_dest
+  *************************************************/
+void *ringBufferConvert(void *op_dest, unsigned long int destFormat, void const *ip_src, unsigned long int srcFormat, unsigned long int count, double scale);
+/*********************************************//**
+  * @brief Deinterleave,
+  * the kernel ringBufferReadDeinterleave uses.
+  *
+  * @param op_channels numChannels pointers to the channel arrays.
+  * @param offset sample in each channel array to start at.
+  * @param ip_src interleaved frames.
+  * @param frames number of frames.
+  * @param numChannels number of channels in a frame.
+  * @param sampleSize bytes in one sample.
+  *************************************************/
+void ringBufferDeinterleave(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+/*********************************************//**
+  * @brief Interleave,
+  * the kernel ringBufferWriteInterleave uses.
+  *
+  * @param op_dest space for the interleaved frames.
+  * @param ip_channels numChannels pointers to the channel arrays.
+  * @param offset sample in each channel array to start at.
+  * @param frames number of frames.
+  * @param numChannels number of channels in a frame.
+  * @param sampleSize bytes in one sample.
+  *************************************************/
+void ringBufferInterleave(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+/*********************************************//**
+  * @brief Async Read,
+  * read all data requested without blocking the thread.
+  *
+  * Reads as much of op->len elements as is available
+  * right now. If that completes the request it returns
+  * RING_BUFFER_ASYNC_DONE and the callback is NOT called.
+  * Otherwise the op is queued in order behind other async
+  * reads and RING_BUFFER_ASYNC_PENDING is returned. Writers
+  * will then fill the op as data is published, and call
+  * op->p_callback from the writing thread once it is done,
+  * or once blocking is ended (RING_BUFFER_ASYNC_ENDED).
+  * The callback runs with the ring buffer mutex held, it
+  * must not call into the ring buffer, it should only hand
+  * the op back to the caller's scheduler (resume a coroutine,
+  * post to an executor). The op must stay valid till then.
+  *
   * @param iop_ringBuffer is the ring buffer object
   * to operate on.
-  * @param bufferSize is the new size for the buffer
-  * @param elementSize is the new elementSize
-  * 
-  * @return The total size of the buffer.
+  * @param iop_op the operation, p_buffer, len, p_callback
+  * and p_context must be set. count and status are outputs.
+  *
+  * @return RING_BUFFER_ASYNC_* status, RING_BUFFER_ASYNC_ERROR on error.
   *************************************************/
-unsigned long int ringBufferResize(struct s_ringBuffer * const iop_ringBuffer, unsigned long int bufferSize, unsigned long int elementSize);
+unsigned long int ringBufferAsyncRead(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferAsyncOp * const iop_op);
 /*********************************************//**
-  * @brief Blocking Write,
-  * write all data without destroying data in buffer.
+  * @brief Async Write,
+  * write all data without destroying data in buffer,
+  * and without blocking the thread.
+  *
+  * Mirror of ringBufferAsyncRead, writes as much of
+  * op->len elements as fits, queues the rest, and calls
+  * op->p_callback from the reading thread once all of
+  * it has been written or blocking is ended.
   *
-  * Write to ring buffer, but don't overwrite its
-  * contents. Will continually write till all is
-  * data is written. This also has a timeout available
-  * if it needs to end in a certain amount of time.
-  * There is also a endBlocking call which sets a
-  * bool that ends all blocking calls and calls
-  * non blocking write instead.
-  * 
   * @param iop_ringBuffer is the ring buffer object
   * to operate on.
-  * @param ip_buffer an input buffer to use as input
-  * to the ring buffer (write to).
-  * @param len the length of the input buffer in elements.
-  * @param p_timeToWait optional argument to use timeout
-  * if blocking for too long.
-  * @return The number of elements written.
+  * @param iop_op the operation, p_buffer, len, p_callback
+  * and p_context must be set. count and status are outputs.
+  *
+  * @return RING_BUFFER_ASYNC_* status, RING_BUFFER_ASYNC_ERROR on error.
   *************************************************/
-unsigned long int ringBufferBlockingWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait);
+unsigned long int ringBufferAsyncWrite(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferAsyncOp * const iop_op);
 /*********************************************//**
-  * @brief Blocking Read,
-  * read all data in buffer, wait till amount requested
-  * is reached.
+  * @brief Async Cancel,
+  * remove a pending async operation.
   *
-  * Read from ring buffer, but keep reading till
-  * we get all of the data. This also has a timeout
-  * available if it needs to end in a certain amount
-  * of time. There is also a endBlocking call which
-  * sets a bool that ends all blocking calls and calls
-  * non blocking read instead.
+  * Used for timeouts and shutdown. If the op is still
+  * queued it is removed, its status is set to the
+  * status given, and its callback is called. Elements
+  * already transferred stay transferred, see op->count.
   *
   * @param iop_ringBuffer is the ring buffer object
   * to operate on.
-  * @param op_buffer an output buffer that the ring
-  * buffer puts data into (read data from buffer).
-  * @param len the number of elements to be read.
+  * @param iop_op the operation to cancel.
+  * @param status status to complete with, usually
+  * RING_BUFFER_ASYNC_TIMEOUT or RING_BUFFER_ASYNC_CANCELLED.
+  *
+  * @return 1 if the op was pending and is now cancelled,
+  * 0 if it already completed.
+  *************************************************/
+unsigned long int ringBufferAsyncCancel(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferAsyncOp * const iop_op, unsigned long int status);
+/*********************************************//**
+  * @brief Initializes a wait set,
+  * used to wait on many ring buffers at once.
+  *
+  * @return Initialized wait set object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferWaitSet *initRingBufferWaitSet(void);
+/*********************************************//**
+  * @brief Destroys wait set object.
+  *
+  * Removes all ring buffers still registered and
+  * frees the wait set.
+  *
+  * @param iopp_waitSet is a double pointer to
+  * the wait set object to be freed.
+  *************************************************/
+void freeRingBufferWaitSet(struct s_ringBufferWaitSet **iopp_waitSet);
+/*********************************************//**
+  * @brief Add ring buffer to wait set.
+  *
+  * Registers the ring buffer, from now on each time
+  * its state changes and it is ready for one of the
+  * events, it is put on the wait set ready list.
+  *
+  * @param iop_waitSet wait set to add to.
+  * @param iop_ringBuffer ring buffer to watch.
+  * @param events RING_BUFFER_WAIT_READ and/or
+  * RING_BUFFER_WAIT_WRITE.
+  * @param p_userData returned with the ring buffer when
+  * it is ready.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+unsigned long int ringBufferWaitSetAdd(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBuffer * const iop_ringBuffer, unsigned long int events, void *p_userData);
+/*********************************************//**
+  * @brief Remove ring buffer from wait set.
+  *
+  * @param iop_waitSet wait set to remove from.
+  * @param iop_ringBuffer ring buffer to stop watching.
+  *
+  * @return 1 on success, 0 if it was not registered.
+  *************************************************/
+unsigned long int ringBufferWaitSetRemove(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBuffer * const iop_ringBuffer);
+/*********************************************//**
+  * @brief Wait Any,
+  * wait till any ring buffer in the set is ready.
+  *
+  * Blocks till at least one registered ring buffer
+  * is ready, or it times out. Only ring buffers that
+  * changed state are looked at, so the cost is in the
+  * number of ready ring buffers, not in the number
+  * registered. Ready is level triggered, a ring buffer
+  * that is still ready will be returned again on the
+  * next call. An ended ring buffer is always ready,
+  * remove it once it is no longer alive.
+  *
+  * @param iop_waitSet wait set to wait on.
+  * @param op_ready array filled with the ready ring buffers.
+  * @param maxReady size of the op_ready array.
   * @param p_timeToWait optional argument to use timeout
   * if blocking for too long.
-  * @return The number of elements read.
+  *
+  * @return number of ready ring buffers, 0 on timeout.
   *************************************************/
-unsigned long int ringBufferBlockingRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait);
+unsigned long int ringBufferWaitAny(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBufferReady *op_ready, unsigned long int maxReady, struct timespec *p_timeToWait);
 /*********************************************//**
-  * @brief Write to the buffer,
-  * write all data regardless if it destroys data in buffer.
+  * @brief Wait Any Until,
+  * same as ringBufferWaitAny, with an absolute deadline.
   *
-  * Write to the buffer the amount of data provided
-  * by len. This will write over data regardless
-  * if it has been read. If len is larger then the
-  * buffer it will simply keep writing that data
-  * (writing over data already written).
-  * Only blocking is waiting for the r/w shared
-  * mutex.
+  * The deadline is on CLOCK_MONOTONIC, see
+  * ringBufferDeadline. Waking up early and waiting
+  * again never moves it. The other arguments are the
+  * same as the relative call.
   *
-  * @param iop_ringBuffer is the ring buffer object
-  * to operate on.
-  * @param ip_buffer an input buffer to use as input
-  * to the ring buffer (write to).
-  * @param len the length of the input buffer in elements.
-  * @return The number of elements written.
+  * @param ip_deadline absolute time to give up, NULL
+  * waits forever.
+  * @return number of ready ring buffers, 0 on timeout.
   *************************************************/
-unsigned long int ringBufferWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len);
+unsigned long int ringBufferWaitAnyUntil(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBufferReady *op_ready, unsigned long int maxReady, struct timespec const *ip_deadline);
 /*********************************************//**
-  * @brief Read from the buffer,
-  * read data available, up to length request.
+  * @brief Deadline,
+  * turn a time to wait into a deadline for the Until calls.
   *
-  * Read data up to length, if no more data exists
-  * just return the amount read and finish.
-  * Only blocking is waiting for the r/w shared
-  * mutex.
+  * Reads CLOCK_MONOTONIC once and adds the time to
+  * wait. Use one deadline over several calls to bound
+  * the total wait.
   *
-  * @param iop_ringBuffer is the ring buffer object
-  * to operate on.
-  * @param op_buffer an output buffer that the ring
-  * buffer puts data into (read data from buffer).
-  * @param len the number of elements to be read.
-  * @return The number of elements read.
+  * @param op_deadline the deadline.
+  * @param ip_timeToWait time from now, NULL for now.
+  *
+  * @return 1 on success, 0 on error.
   *************************************************/
-unsigned long int ringBufferRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len);
+int ringBufferDeadline(struct timespec *op_deadline, struct timespec const *ip_timeToWait);
 /*********************************************//**
   * @brief Reset Buffer,
   * reset buffer indexs and end blocking.
@@ -0,0 +1,201 @@
+/***************************************************************************//**
+  * @file     ringBufferBudget.h
+  * @brief    ansi-C ring buffer memory budget
+  * @details  Memory budget shared by many ring buffers. Each ring buffer on it keeps a
+  * minimum reservation and grows into free budget under bursts, going back to
+  * its minimum once it stays drained. Total memory follows what is in use, not the sum
+  * of every worst case.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.30.0 - Initial version, ring buffer memory budget.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERBUDGET_HD
+#define __RINGBUFFERBUDGET_HD
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct s_ringBufferBudget
+ * @brief A struct type for a memory budget shared by ring buffers.
+ */
+struct s_ringBufferBudget
+{
+  /**
+  * @var s_ringBufferBudget::limit
+  * bytes of buffer the ring buffers on the budget may hold at once.
+  */
+  unsigned long int limit;
+  /**
+  * @var s_ringBufferBudget::used
+  * bytes taken, minimum reservations and growth.
+  */
+  unsigned long int used;
+  /**
+  * @var s_ringBufferBudget::peak
+  * most bytes ever taken at once.
+  */
+  unsigned long int peak;
+  /**
+  * @var s_ringBufferBudget::denied
+  * times a ring buffer was turned down.
+  */
+  unsigned long int denied;
+  /**
+  * @var s_ringBufferBudget::waiting
+  * threads waiting on the condition.
+  */
+  unsigned long int waiting;
+  /**
+  * @var s_ringBufferBudget::mutex
+  * protects the counts, always taken after a ring buffer mutex.
+  */
+  pthread_mutex_t mutex;
+  /**
+  * @var s_ringBufferBudget::condition
+  * writers turned down wait on it, signaled when bytes are given back
+  * or their own ring buffer changes.
+  */
+  pthread_cond_t condition;
+};
+
+/*********************************************//**
+  * @brief Initializes budget.
+  *
+  * @param limit bytes of buffer the ring buffers
+  * created on the budget may hold at once.
+  *
+  * @return  Initialized budget object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferBudget *initRingBufferBudget(unsigned long int limit);
+/*********************************************//**
+  * @brief Destroys budget object.
+  *
+  * Every ring buffer on it has to be freed first,
+  * if any are left it is not freed.
+  *
+  * @param iopp_ringBufferBudget is a double pointer to
+  * the budget object to be freed.
+  *************************************************/
+void freeRingBufferBudget(struct s_ringBufferBudget **iopp_ringBufferBudget);
+/*********************************************//**
+  * @brief Initializes a ring buffer on a budget.
+  *
+  * The minimum size is reserved from the budget and
+  * laid out with the ring buffer, it is always there.
+  * When a write doesn't fit the ring buffer grows,
+  * doubling, into free budget up to the maximum size.
+  * Writes by the overflow policy, blocking writes and
+  * blocking range writes grow it. Once it has stayed
+  * under half the minimum size for a run of reads and
+  * writes, and is drained with nothing waiting on it,
+  * it goes back to the minimum size and gives what it
+  * grew into back. A burst in the run starts it over,
+  * so a steady stream doesn't grow and shrink on every
+  * pass. If the budget turns anyone down meanwhile it
+  * doesn't wait out the run, and ringBufferRecycle
+  * shrinks it right away.
+  * If the budget is used up it doesn't grow, writes
+  * block or follow the overflow policy like they do
+  * on a full ring buffer, the minimum reservation keeps
+  * it moving. A blocked writer turned down by the
+  * budget wakes when any ring buffer on it gives
+  * bytes back. Free it with freeRingBuffer. Resize is
+  * not allowed on it.
+  *
+  * @param iop_ringBufferBudget budget to draw from.
+  * @param minSize minimum number of elements, reserved.
+  * @param maxSize most elements it may grow to.
+  * @param elementSize size of each element.
+  *
+  * @return  Initialized ring buffer object, or NULL
+  * on error or if the budget can't cover the minimum.
+  *************************************************/
+struct s_ringBuffer *initRingBufferOnBudget(struct s_ringBufferBudget * const iop_ringBufferBudget, unsigned long int minSize, unsigned long int maxSize, unsigned long int elementSize);
+/*********************************************//**
+  * @brief Take bytes from the budget,
+  * used by the ring buffers on it.
+  *
+  * @param iop_ringBufferBudget is the budget object
+  * to operate on.
+  * @param bytes number of bytes to take.
+  *
+  * @return 1 on success, 0 if the budget doesn't
+  * have them.
+  *************************************************/
+int ringBufferBudgetTake(struct s_ringBufferBudget * const iop_ringBufferBudget, unsigned long int bytes);
+/*********************************************//**
+  * @brief Give bytes back to the budget,
+  * used by the ring buffers on it. Wakes
+  * the writers the budget turned down.
+  *
+  * @param iop_ringBufferBudget is the budget object
+  * to operate on.
+  * @param bytes number of bytes taken before.
+  *************************************************/
+void ringBufferBudgetGive(struct s_ringBufferBudget * const iop_ringBufferBudget, unsigned long int bytes);
+/*********************************************//**
+  * @brief Get Used,
+  * bytes taken from the budget.
+  *
+  * @param ip_ringBufferBudget is the budget object
+  * to operate on.
+  *
+  * @return The number of bytes taken.
+  *************************************************/
+unsigned long int getRingBufferBudgetUsed(struct s_ringBufferBudget * const ip_ringBufferBudget);
+/*********************************************//**
+  * @brief Get Peak,
+  * most bytes ever taken from the budget at once.
+  *
+  * @param ip_ringBufferBudget is the budget object
+  * to operate on.
+  *
+  * @return The peak number of bytes taken.
+  *************************************************/
+unsigned long int getRingBufferBudgetPeak(struct s_ringBufferBudget * const ip_ringBufferBudget);
+/*********************************************//**
+  * @brief Get Denied,
+  * times a ring buffer couldn't grow or be created
+  * because the budget was used up.
+  *
+  * @param ip_ringBufferBudget is the budget object
+  * to operate on.
+  *
+  * @return The number of times it was turned down.
+  *************************************************/
+unsigned long int getRingBufferBudgetDenied(struct s_ringBufferBudget * const ip_ringBufferBudget);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,288 @@
+/***************************************************************************//**
+  * @file     ringBufferDescriptor.h
+  * @brief    ansi-C descriptor ring buffer
+  * @details  Hand off large buffers without copying them. A fixed pool of equal sized
+  * buffers is paired with a ring buffer of small descriptors (pointer, length,
+  * tag). Producers acquire a buffer, fill it and send its descriptor, consumers
+  * receive the descriptor and release the buffer when done. The free list is a
+  * lock-free bounded MPMC queue, acquire blocks when the pool is exhausted.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.20.0 - Initial version, descriptor ring with a lock-free buffer pool.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERDESCRIPTOR_HD
+#define __RINGBUFFERDESCRIPTOR_HD
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct s_ringBufferDescriptor
+ * @brief What goes through the ring, a buffer from the pool.
+ */
+struct s_ringBufferDescriptor
+{
+  /**
+  * @var s_ringBufferDescriptor::p_data
+  * buffer from ringBufferDescriptorsAcquire.
+  */
+  void *p_data;
+  /**
+  * @var s_ringBufferDescriptor::len
+  * bytes of p_data in use.
+  */
+  unsigned long int len;
+  /**
+  * @var s_ringBufferDescriptor::tag
+  * user value sent along with the buffer.
+  */
+  unsigned long int tag;
+};
+
+/**
+ * @struct s_ringBufferFreeCell
+ * @brief A slot in the free list queue.
+ */
+struct s_ringBufferFreeCell
+{
+  /**
+  * @var s_ringBufferFreeCell::sequence
+  * which lap of the queue the cell is ready for.
+  */
+  volatile unsigned long int sequence;
+  /**
+  * @var s_ringBufferFreeCell::index
+  * index of a free buffer.
+  */
+  unsigned long int index;
+};
+
+/**
+ * @struct s_ringBufferDescriptors
+ * @brief A struct type for a descriptor ring and its buffer pool.
+ */
+struct s_ringBufferDescriptors
+{
+  /**
+  * @var s_ringBufferDescriptors::p_ringBuffer
+  * ring buffer of s_ringBufferDescriptor elements, holds every buffer so sends never wait.
+  */
+  struct s_ringBuffer *p_ringBuffer;
+  /**
+  * @var s_ringBufferDescriptors::numBuffers
+  * number of buffers in the pool.
+  */
+  unsigned long int numBuffers;
+  /**
+  * @var s_ringBufferDescriptors::bufferSize
+  * size of each buffer in bytes.
+  */
+  unsigned long int bufferSize;
+  /**
+  * @var s_ringBufferDescriptors::bufferStride
+  * bufferSize rounded up to RING_BUFFER_ALIGN.
+  */
+  unsigned long int bufferStride;
+  /**
+  * @var s_ringBufferDescriptors::p_buffers
+  * one block holding every buffer.
+  */
+  void *p_buffers;
+  /**
+  * @var s_ringBufferDescriptors::p_cells
+  * free list queue, a power of two long.
+  */
+  struct s_ringBufferFreeCell *p_cells;
+  /**
+  * @var s_ringBufferDescriptors::p_inUse
+  * one flag per buffer, set while a buffer is out of the pool.
+  */
+  volatile unsigned char *p_inUse;
+  /**
+  * @var s_ringBufferDescriptors::cellMask
+  * mask to index p_cells.
+  */
+  unsigned long int cellMask;
+  /**
+  * @var s_ringBufferDescriptors::enqueuePos
+  * next free list position to put a buffer in.
+  */
+  volatile unsigned long int enqueuePos;
+  /**
+  * @var s_ringBufferDescriptors::pad
+  * keep acquire and release off of each others cache line.
+  */
+  char pad[RING_BUFFER_ALIGN];
+  /**
+  * @var s_ringBufferDescriptors::dequeuePos
+  * next free list position to take a buffer from.
+  */
+  volatile unsigned long int dequeuePos;
+  /**
+  * @var s_ringBufferDescriptors::waiters
+  * threads blocked in acquire, release only locks the mutex when there are some.
+  */
+  volatile unsigned long int waiters;
+  /**
+  * @var s_ringBufferDescriptors::b_blocking
+  * Boolean, false once blocking is ended.
+  */
+  volatile unsigned long int b_blocking;
+  /**
+  * @var s_ringBufferDescriptors::mutex
+  * for acquire to wait on an empty pool.
+  */
+  pthread_mutex_t mutex;
+  /**
+  * @var s_ringBufferDescriptors::condition
+  * signaled when a buffer is released to a waiting acquire.
+  */
+  pthread_cond_t condition;
+};
+
+/*********************************************//**
+  * @brief Initializes descriptors,
+  * creates the buffer pool and the descriptor ring.
+  *
+  * @param numBuffers number of buffers in the pool.
+  * @param bufferSize size of each buffer in bytes.
+  *
+  * @return  Initialized descriptors object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferDescriptors *initRingBufferDescriptors(unsigned long int numBuffers, unsigned long int bufferSize);
+/*********************************************//**
+  * @brief Destroys descriptors object,
+  * the pool and the ring.
+  *
+  * @param iopp_ringBufferDescriptors is a double pointer
+  * to the descriptors object to be freed.
+  *************************************************/
+void freeRingBufferDescriptors(struct s_ringBufferDescriptors **iopp_ringBufferDescriptors);
+/*********************************************//**
+  * @brief Acquire a buffer,
+  * wait for one if the pool is empty.
+  *
+  * Lock-free unless it has to wait.
+  *
+  * @param iop_ringBufferDescriptors is the descriptors
+  * object to operate on.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return a buffer of bufferSize bytes, NULL on timeout
+  * or once blocking is ended.
+  *************************************************/
+void *ringBufferDescriptorsAcquire(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Try Acquire a buffer,
+  * never waits.
+  *
+  * @param iop_ringBufferDescriptors is the descriptors
+  * object to operate on.
+  *
+  * @return a buffer of bufferSize bytes, NULL if the
+  * pool is empty.
+  *************************************************/
+void *ringBufferDescriptorsTryAcquire(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors);
+/*********************************************//**
+  * @brief Release a buffer,
+  * back to the pool.
+  *
+  * Lock-free unless an acquire is waiting.
+  *
+  * @param iop_ringBufferDescriptors is the descriptors
+  * object to operate on.
+  * @param ip_buffer buffer from acquire.
+  *
+  * @return 1 on success, 0 if it isn't from this pool
+  * or is already back in it.
+  *************************************************/
+int ringBufferDescriptorsRelease(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, void *ip_buffer);
+/*********************************************//**
+  * @brief Send a buffer,
+  * put its descriptor on the ring.
+  *
+  * Only the descriptor is copied, the buffer now
+  * belongs to whoever receives it.
+  *
+  * @param iop_ringBufferDescriptors is the descriptors
+  * object to operate on.
+  * @param ip_buffer buffer from acquire.
+  * @param len bytes of the buffer in use.
+  * @param tag user value sent with it.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+int ringBufferDescriptorsSend(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, void *ip_buffer, unsigned long int len, unsigned long int tag);
+/*********************************************//**
+  * @brief Receive a buffer,
+  * wait for a descriptor on the ring.
+  *
+  * The buffer belongs to the caller till it is
+  * released.
+  *
+  * @param iop_ringBufferDescriptors is the descriptors
+  * object to operate on.
+  * @param op_descriptor the descriptor received.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return 1 if one was received, 0 on timeout or once
+  * blocking is ended and the ring is empty.
+  *************************************************/
+int ringBufferDescriptorsReceive(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, struct s_ringBufferDescriptor *op_descriptor, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Is Alive,
+  * still blocking or descriptors left to receive.
+  *
+  * @param ip_ringBufferDescriptors is the descriptors
+  * object to operate on.
+  *
+  * @return True if blocking or descriptors are left.
+  *************************************************/
+unsigned long int ringBufferDescriptorsIsAlive(struct s_ringBufferDescriptors * const ip_ringBufferDescriptors);
+/*********************************************//**
+  * @brief End Blocking,
+  * on the ring and the pool.
+  *
+  * Receivers get what is left then 0, acquirers
+  * waiting on the pool get NULL.
+  *
+  * @param iop_ringBufferDescriptors is the descriptors
+  * object to operate on.
+  *************************************************/
+void ringBufferDescriptorsEndBlocking(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
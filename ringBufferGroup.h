@@ -0,0 +1,246 @@
+/***************************************************************************//**
+  * @file     ringBufferGroup.h
+  * @brief    ansi-C ring buffer group
+  * @details  Group of ring buffers, one shard per CPU or per lane. Producers write
+  * to their own shard so they never contend with producers on other cores.
+  * Consumers drain the shards they own first, and steal from the rest when
+  * they run dry. All functions return the number of elements.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.10.0 - Initial version, sharded ring buffer groups with work stealing.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERGROUP_HD
+#define __RINGBUFFERGROUP_HD
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct s_ringBufferGroupShard
+ * @brief A struct type for one shard of a ring buffer group.
+ */
+struct s_ringBufferGroupShard
+{
+  /**
+  * @var s_ringBufferGroupShard::p_ringBuffer
+  * ring buffer for this shard.
+  */
+  struct s_ringBuffer *p_ringBuffer;
+  /**
+  * @var s_ringBufferGroupShard::wrote
+  * number of elements written to this shard.
+  */
+  volatile unsigned long int wrote;
+  /**
+  * @var s_ringBufferGroupShard::read
+  * number of elements read from this shard by its owner.
+  */
+  volatile unsigned long int read;
+  /**
+  * @var s_ringBufferGroupShard::stolen
+  * number of elements read from this shard by other consumers.
+  */
+  volatile unsigned long int stolen;
+  /**
+  * @var s_ringBufferGroupShard::pad
+  * keep shards on their own cache lines.
+  */
+  char pad[64];
+};
+
+/**
+ * @struct s_ringBufferGroup
+ * @brief A struct type for a sharded group of ring buffers.
+ */
+struct s_ringBufferGroup
+{
+  /**
+  * @var s_ringBufferGroup::numShards
+  * number of shards (ring buffers) in the group.
+  */
+  unsigned long int numShards;
+  /**
+  * @var s_ringBufferGroup::numConsumers
+  * number of consumers, shard i is owned by consumer i % numConsumers.
+  */
+  unsigned long int numConsumers;
+  /**
+  * @var s_ringBufferGroup::p_shards
+  * array of shards.
+  */
+  struct s_ringBufferGroupShard *p_shards;
+  /**
+  * @var s_ringBufferGroup::p_waitSet
+  * wait set with every shard, used by idle consumers.
+  */
+  struct s_ringBufferWaitSet *p_waitSet;
+};
+
+/**
+ * @struct s_ringBufferGroupStats
+ * @brief A struct type for the totals of a ring buffer group.
+ */
+struct s_ringBufferGroupStats
+{
+  /**
+  * @var s_ringBufferGroupStats::wrote
+  * elements written to all shards.
+  */
+  unsigned long int wrote;
+  /**
+  * @var s_ringBufferGroupStats::read
+  * elements read from all shards, stolen included.
+  */
+  unsigned long int read;
+  /**
+  * @var s_ringBufferGroupStats::stolen
+  * elements read by a consumer that did not own the shard.
+  */
+  unsigned long int stolen;
+  /**
+  * @var s_ringBufferGroupStats::readSize
+  * elements currently waiting in all shards.
+  */
+  unsigned long int readSize;
+  /**
+  * @var s_ringBufferGroupStats::size
+  * capacity in elements of all shards.
+  */
+  unsigned long int size;
+};
+
+/*********************************************//**
+  * @brief Initializes ring buffer group,
+  * creates one ring buffer per shard.
+  *
+  * @param numShards number of shards, 0 for one
+  * per online CPU.
+  * @param numConsumers number of consumers that will
+  * read, each owns every numConsumers'th shard.
+  * @param buffSize a minimum number of elements for
+  * each shard.
+  * @param elementSize size of each element in the
+  * buffer.
+  *
+  * @return  Initialized ring buffer group, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferGroup *initRingBufferGroup(unsigned long int numShards, unsigned long int numConsumers, unsigned long int const buffSize, unsigned long int const elementSize);
+/*********************************************//**
+  * @brief Destroys ring buffer group.
+  *
+  * @param iopp_ringBufferGroup is a double pointer to
+  * the ring buffer group to be freed.
+  *************************************************/
+void freeRingBufferGroup(struct s_ringBufferGroup **iopp_ringBufferGroup);
+/*********************************************//**
+  * @brief Get the shard local to the calling thread.
+  *
+  * Uses the CPU the thread is running on where the
+  * platform can tell us, otherwise shard 0. Threads
+  * that know their lane should pass it directly.
+  *
+  * @param ip_ringBufferGroup is the ring buffer group
+  * to operate on.
+  *
+  * @return Shard index for the calling thread.
+  *************************************************/
+unsigned long int ringBufferGroupLocalShard(struct s_ringBufferGroup const * const ip_ringBufferGroup);
+/*********************************************//**
+  * @brief Blocking Write to a shard.
+  *
+  * Same as ringBufferBlockingWrite on the ring buffer
+  * of the shard given.
+  *
+  * @param iop_ringBufferGroup is the ring buffer group
+  * to operate on.
+  * @param shard shard to write to, usually from
+  * ringBufferGroupLocalShard. Taken modulo numShards.
+  * @param ip_buffer an input buffer to write.
+  * @param len the length of the input buffer in elements.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferGroupWrite(struct s_ringBufferGroup * const iop_ringBufferGroup, unsigned long int shard, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Read from the group.
+  *
+  * Reads up to len elements from the shards the
+  * consumer owns. If they are all empty it steals
+  * from the other shards. If every shard is empty it
+  * waits till one is not. Returns as soon as any data
+  * has been read, 0 on timeout or once every shard has
+  * ended and is empty.
+  *
+  * @param iop_ringBufferGroup is the ring buffer group
+  * to operate on.
+  * @param consumer index of the consumer, 0 to
+  * numConsumers - 1.
+  * @param op_buffer an output buffer to read into.
+  * @param len the max number of elements to be read.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferGroupRead(struct s_ringBufferGroup * const iop_ringBufferGroup, unsigned long int consumer, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Check if any shard in the group is alive.
+  *
+  * @param ip_ringBufferGroup is the ring buffer group
+  * to operate on.
+  *
+  * @return True if any shard is blocking or has data.
+  *************************************************/
+unsigned long int ringBufferGroupIsAlive(struct s_ringBufferGroup * const ip_ringBufferGroup);
+/*********************************************//**
+  * @brief Get totals for the whole group.
+  *
+  * @param ip_ringBufferGroup is the ring buffer group
+  * to operate on.
+  * @param op_stats filled with the totals.
+  *************************************************/
+void ringBufferGroupGetStats(struct s_ringBufferGroup * const ip_ringBufferGroup, struct s_ringBufferGroupStats *op_stats);
+/*********************************************//**
+  * @brief End Blocking on every shard.
+  *
+  * Same as ringBufferEndBlocking on every shard,
+  * consumers drain what is left then read returns 0.
+  *
+  * @param iop_ringBufferGroup is the ring buffer group
+  * to operate on.
+  *************************************************/
+void ringBufferGroupEndBlocking(struct s_ringBufferGroup * const iop_ringBufferGroup);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
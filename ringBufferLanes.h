@@ -0,0 +1,211 @@
+/***************************************************************************//**
+  * @file     ringBufferLanes.h
+  * @brief    ansi-C priority lane ring buffer
+  * @details  Ring buffer with priority lanes. Each lane is its own ring buffer with
+  * its own capacity, so bulk traffic can't take the space of control traffic.
+  * Readers drain lanes by strict priority (lane 0 first) or by weighted round
+  * robin. All functions return the number of elements.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.11.0 - Initial version, priority lanes with strict and weighted draining.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERLANES_HD
+#define __RINGBUFFERLANES_HD
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def RING_BUFFER_LANES_STRICT
+ * always read the lowest numbered lane with data.
+ */
+#define RING_BUFFER_LANES_STRICT   0
+/**
+ * @def RING_BUFFER_LANES_WEIGHTED
+ * weighted round robin, each lane reads up to its weight in elements per round.
+ */
+#define RING_BUFFER_LANES_WEIGHTED 1
+
+/**
+ * @struct s_ringBufferLanes
+ * @brief A struct type for a multi lane ring buffer.
+ */
+struct s_ringBufferLanes
+{
+  /**
+  * @var s_ringBufferLanes::numLanes
+  * number of lanes.
+  */
+  unsigned long int numLanes;
+  /**
+  * @var s_ringBufferLanes::policy
+  * RING_BUFFER_LANES_STRICT or RING_BUFFER_LANES_WEIGHTED.
+  */
+  unsigned long int policy;
+  /**
+  * @var s_ringBufferLanes::currentLane
+  * lane the weighted round robin is on.
+  */
+  unsigned long int currentLane;
+  /**
+  * @var s_ringBufferLanes::pp_lanes
+  * ring buffer for each lane.
+  */
+  struct s_ringBuffer **pp_lanes;
+  /**
+  * @var s_ringBufferLanes::p_weights
+  * elements each lane may read per round.
+  */
+  unsigned long int *p_weights;
+  /**
+  * @var s_ringBufferLanes::p_credits
+  * elements each lane has left this round.
+  */
+  unsigned long int *p_credits;
+  /**
+  * @var s_ringBufferLanes::p_waitSet
+  * wait set with every lane, wakes the reader.
+  */
+  struct s_ringBufferWaitSet *p_waitSet;
+  /**
+  * @var s_ringBufferLanes::mutex
+  * protects the round robin state.
+  */
+  pthread_mutex_t mutex;
+};
+
+/*********************************************//**
+  * @brief Initializes lanes,
+  * creates one ring buffer per lane.
+  *
+  * @param numLanes number of lanes, lane 0 is the
+  * highest priority.
+  * @param ip_buffSizes minimum number of elements for
+  * each lane, numLanes long.
+  * @param elementSize size of each element.
+  * @param policy RING_BUFFER_LANES_STRICT or
+  * RING_BUFFER_LANES_WEIGHTED.
+  * @param ip_weights elements per round for each lane,
+  * numLanes long, NULL for 1 each. Ignored for strict.
+  *
+  * @return  Initialized lanes object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferLanes *initRingBufferLanes(unsigned long int numLanes, unsigned long int const *ip_buffSizes, unsigned long int const elementSize, unsigned long int policy, unsigned long int const *ip_weights);
+/*********************************************//**
+  * @brief Destroys lanes object.
+  *
+  * @param iopp_ringBufferLanes is a double pointer to
+  * the lanes object to be freed.
+  *************************************************/
+void freeRingBufferLanes(struct s_ringBufferLanes **iopp_ringBufferLanes);
+/*********************************************//**
+  * @brief Blocking Write to a lane.
+  *
+  * Same as ringBufferBlockingWrite on the lane given,
+  * only space in that lane matters.
+  *
+  * @param iop_ringBufferLanes is the lanes object
+  * to operate on.
+  * @param lane lane to write to.
+  * @param ip_buffer an input buffer to write.
+  * @param len the length of the input buffer in elements.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferLanesBlockingWrite(struct s_ringBufferLanes * const iop_ringBufferLanes, unsigned long int lane, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Write to a lane.
+  *
+  * Same as ringBufferWrite on the lane given.
+  *
+  * @param iop_ringBufferLanes is the lanes object
+  * to operate on.
+  * @param lane lane to write to.
+  * @param ip_buffer an input buffer to write.
+  * @param len the length of the input buffer in elements.
+  * @return The number of elements written.
+  *************************************************/
+unsigned long int ringBufferLanesWrite(struct s_ringBufferLanes * const iop_ringBufferLanes, unsigned long int lane, void *ip_buffer, unsigned long int len);
+/*********************************************//**
+  * @brief Blocking Read from the lanes.
+  *
+  * Waits till any lane has data, then reads up to
+  * len elements from the lane picked by the policy.
+  * Data from different lanes is never mixed in one
+  * read. Returns 0 on timeout, or once every lane
+  * has ended and is empty.
+  *
+  * @param iop_ringBufferLanes is the lanes object
+  * to operate on.
+  * @param op_buffer an output buffer to read into.
+  * @param len the max number of elements to be read.
+  * @param op_lane optional, set to the lane read from.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferLanesBlockingRead(struct s_ringBufferLanes * const iop_ringBufferLanes, void *op_buffer, unsigned long int len, unsigned long int *op_lane, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Read from the lanes.
+  *
+  * Non-blocking version of ringBufferLanesBlockingRead.
+  *
+  * @param iop_ringBufferLanes is the lanes object
+  * to operate on.
+  * @param op_buffer an output buffer to read into.
+  * @param len the max number of elements to be read.
+  * @param op_lane optional, set to the lane read from.
+  * @return The number of elements read.
+  *************************************************/
+unsigned long int ringBufferLanesRead(struct s_ringBufferLanes * const iop_ringBufferLanes, void *op_buffer, unsigned long int len, unsigned long int *op_lane);
+/*********************************************//**
+  * @brief Check if any lane is alive.
+  *
+  * @param ip_ringBufferLanes is the lanes object
+  * to operate on.
+  *
+  * @return True if any lane is blocking or has data.
+  *************************************************/
+unsigned long int ringBufferLanesIsAlive(struct s_ringBufferLanes * const ip_ringBufferLanes);
+/*********************************************//**
+  * @brief End Blocking on every lane.
+  *
+  * @param iop_ringBufferLanes is the lanes object
+  * to operate on.
+  *************************************************/
+void ringBufferLanesEndBlocking(struct s_ringBufferLanes * const iop_ringBufferLanes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
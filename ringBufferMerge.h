@@ -0,0 +1,247 @@
+/***************************************************************************//**
+  * @file     ringBufferMerge.h
+  * @brief    ansi-C ring buffer merge reader
+  * @details  Key ordered merge of many ring buffers. Each ring buffer holds records in key
+  * order, say by timestamp, the merge reads them out as one stream in key order.
+  * The records at the heads are looked at in place, only the one read is copied.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.31.0 - Initial version, key ordered merge reader.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERMERGE_HD
+#define __RINGBUFFERMERGE_HD
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct s_ringBufferMerge
+ * @brief A struct type for a merge reader over many ring buffers.
+ */
+struct s_ringBufferMerge
+{
+  /**
+  * @var s_ringBufferMerge::numRings
+  * number of ring buffers merged.
+  */
+  unsigned long int numRings;
+  /**
+  * @var s_ringBufferMerge::elementSize
+  * size of a record, the same in every ring buffer.
+  */
+  unsigned long int elementSize;
+  /**
+  * @var s_ringBufferMerge::pp_rings
+  * the ring buffers, not owned by the merge.
+  */
+  struct s_ringBuffer **pp_rings;
+  /**
+  * @var s_ringBufferMerge::p_keyFunc
+  * returns the key of the record it is given.
+  */
+  unsigned long int (*p_keyFunc)(void const *p_record, void *p_context);
+  /**
+  * @var s_ringBufferMerge::p_context
+  * passed to p_keyFunc.
+  */
+  void *p_context;
+  /**
+  * @var s_ringBufferMerge::p_heap
+  * ring buffers with a record at the head, smallest key first.
+  */
+  unsigned long int *p_heap;
+  /**
+  * @var s_ringBufferMerge::heapSize
+  * number of ring buffers in the heap.
+  */
+  unsigned long int heapSize;
+  /**
+  * @var s_ringBufferMerge::p_keys
+  * key of the record at the head of each ring buffer in the heap.
+  */
+  unsigned long int *p_keys;
+  /**
+  * @var s_ringBufferMerge::p_lastKeys
+  * key of the last record taken from each ring buffer, the next is no smaller.
+  */
+  unsigned long int *p_lastKeys;
+  /**
+  * @var s_ringBufferMerge::p_states
+  * in the heap, empty or ended, for each ring buffer.
+  */
+  unsigned long int *p_states;
+  /**
+  * @var s_ringBufferMerge::p_pending
+  * ring buffers that are empty, but not ended.
+  */
+  unsigned long int *p_pending;
+  /**
+  * @var s_ringBufferMerge::numPending
+  * number of empty ring buffers.
+  */
+  unsigned long int numPending;
+  /**
+  * @var s_ringBufferMerge::p_waitSet
+  * wait set with the empty ring buffers.
+  */
+  struct s_ringBufferWaitSet *p_waitSet;
+  /**
+  * @var s_ringBufferMerge::mutex
+  * one merge reader at a time.
+  */
+  pthread_mutex_t mutex;
+};
+
+/*********************************************//**
+  * @brief Initializes merge reader.
+  *
+  * Each ring buffer has to hold records in key order,
+  * the merge reads them out in key order across all of
+  * them. Records with the same key come out in ring
+  * buffer order. The ring buffers have to outlive the
+  * merge, and only the merge may read them.
+  *
+  * @param ipp_rings array of ring buffers to merge, the
+  * array is copied.
+  * @param numRings number of ring buffers.
+  * @param p_keyFunc returns the key of a record, given
+  * a pointer to the record where it sits in the ring
+  * buffer and p_context. Called with the ring buffer
+  * mutex held, it must not call into the ring buffer.
+  * @param p_context passed to p_keyFunc.
+  *
+  * @return  Initialized merge object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferMerge *initRingBufferMerge(struct s_ringBuffer * const *ipp_rings, unsigned long int numRings, unsigned long int (*p_keyFunc)(void const *p_record, void *p_context), void *p_context);
+/*********************************************//**
+  * @brief Destroys merge object,
+  * the ring buffers are left as they are.
+  *
+  * @param iopp_ringBufferMerge is a double pointer to
+  * the merge object to be freed.
+  *************************************************/
+void freeRingBufferMerge(struct s_ringBufferMerge **iopp_ringBufferMerge);
+/*********************************************//**
+  * @brief Blocking Merge Read,
+  * read up to maxElems records in key order.
+  *
+  * The record with the smallest key can only be read
+  * once no empty ring buffer could still get a smaller
+  * one, that is one whose last record had a smaller key
+  * and that has not ended. Only then does it wait, on
+  * those ring buffers. Returns as soon as it would have
+  * to wait with a record read.
+  *
+  * @param iop_ringBufferMerge is the merge object
+  * to operate on.
+  * @param op_buffer an output buffer for the records.
+  * @param maxElems the max number of records to read.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return The number of records read, 0 on timeout or
+  * once every ring buffer has ended and been read.
+  *************************************************/
+unsigned long int ringBufferMergeRead(struct s_ringBufferMerge * const iop_ringBufferMerge, void *op_buffer, unsigned long int maxElems, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Merge Read,
+  * same as ringBufferMergeRead, waits till an absolute
+  * CLOCK_MONOTONIC deadline.
+  *
+  * @param iop_ringBufferMerge is the merge object
+  * to operate on.
+  * @param op_buffer an output buffer for the records.
+  * @param maxElems the max number of records to read.
+  * @param ip_deadline optional absolute CLOCK_MONOTONIC
+  * deadline, NULL waits forever.
+  *
+  * @return The number of records read, 0 on timeout or
+  * once every ring buffer has ended and been read.
+  *************************************************/
+unsigned long int ringBufferMergeReadUntil(struct s_ringBufferMerge * const iop_ringBufferMerge, void *op_buffer, unsigned long int maxElems, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Blocking Merge Drain,
+  * same as ringBufferMergeRead, the records are given
+  * to p_drainFunc in place instead of copied out.
+  *
+  * p_drainFunc is called once per record, with len 1,
+  * the same as ringBufferDrain. If it consumes nothing
+  * the merge stops there, the record stays.
+  *
+  * @param iop_ringBufferMerge is the merge object
+  * to operate on.
+  * @param maxElems the max number of records to drain.
+  * @param p_drainFunc called with a pointer to the record,
+  * the number of records there and p_context. Returns the
+  * number of records consumed.
+  * @param p_context passed to p_drainFunc.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return The number of records drained, 0 on timeout or
+  * once every ring buffer has ended and been drained.
+  *************************************************/
+unsigned long int ringBufferMergeDrain(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Blocking Merge Drain,
+  * same as ringBufferMergeDrain, waits till an absolute
+  * CLOCK_MONOTONIC deadline.
+  *
+  * @param iop_ringBufferMerge is the merge object
+  * to operate on.
+  * @param maxElems the max number of records to drain.
+  * @param p_drainFunc called with a pointer to the record,
+  * the number of records there and p_context.
+  * @param p_context passed to p_drainFunc.
+  * @param ip_deadline optional absolute CLOCK_MONOTONIC
+  * deadline, NULL waits forever.
+  *
+  * @return The number of records drained, 0 on timeout or
+  * once every ring buffer has ended and been drained.
+  *************************************************/
+unsigned long int ringBufferMergeDrainUntil(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec const *ip_deadline);
+/*********************************************//**
+  * @brief Is Alive,
+  * is any ring buffer still blocking or holding records.
+  *
+  * @param iop_ringBufferMerge is the merge object
+  * to operate on.
+  *
+  * @return 1 if there may be more records, 0 once every
+  * ring buffer has ended and been read.
+  *************************************************/
+unsigned long int ringBufferMergeIsAlive(struct s_ringBufferMerge * const iop_ringBufferMerge);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
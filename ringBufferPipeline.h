@@ -0,0 +1,392 @@
+/***************************************************************************//**
+  * @file     ringBufferPipeline.h
+  * @brief    ansi-C ring buffer pipeline
+  * @details  Multi stage pipeline built on chained ring buffers. Stages are functions
+  * run by one or more worker threads. The pipeline creates the ring buffers
+  * between stages, starts and joins the threads, ends blocking downstream
+  * when a stage finishes, and stops everything when a stage fails. Per stage
+  * throughput and stall time are kept to find the bottleneck stage.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.13.0 - Initial version, multi stage pipelines with stall statistics.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERPIPELINE_HD
+#define __RINGBUFFERPIPELINE_HD
+
+#include <stdio.h>
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @def RING_BUFFER_PIPELINE_NO_CPU
+ * do not pin the stage threads to a CPU.
+ */
+#define RING_BUFFER_PIPELINE_NO_CPU (-1)
+
+struct s_ringBufferPipeline;
+struct s_ringBufferStage;
+
+/**
+ * @struct s_ringBufferStageWorker
+ * @brief A struct type for one worker thread of a stage, passed to the stage function.
+ */
+struct s_ringBufferStageWorker
+{
+  /**
+  * @var s_ringBufferStageWorker::p_stage
+  * stage this worker belongs to.
+  */
+  struct s_ringBufferStage *p_stage;
+  /**
+  * @var s_ringBufferStageWorker::p_userData
+  * user data given to ringBufferPipelineAddStage.
+  */
+  void *p_userData;
+  /**
+  * @var s_ringBufferStageWorker::index
+  * index of this worker in its stage, 0 to numWorkers - 1.
+  */
+  unsigned long int index;
+  /**
+  * @var s_ringBufferStageWorker::thread
+  * thread running this worker.
+  */
+  pthread_t thread;
+  /**
+  * @var s_ringBufferStageWorker::elementsIn
+  * elements read from the input ring buffer.
+  */
+  unsigned long int elementsIn;
+  /**
+  * @var s_ringBufferStageWorker::elementsOut
+  * elements written to the output ring buffer.
+  */
+  unsigned long int elementsOut;
+  /**
+  * @var s_ringBufferStageWorker::runTime
+  * seconds the worker ran for.
+  */
+  double runTime;
+  /**
+  * @var s_ringBufferStageWorker::stallInTime
+  * seconds spent waiting on input.
+  */
+  double stallInTime;
+  /**
+  * @var s_ringBufferStageWorker::stallOutTime
+  * seconds spent waiting for space on the output.
+  */
+  double stallOutTime;
+  /**
+  * @var s_ringBufferStageWorker::error
+  * value the stage function returned.
+  */
+  int error;
+};
+
+/**
+ * @struct s_ringBufferStage
+ * @brief A struct type for one stage of a pipeline.
+ */
+struct s_ringBufferStage
+{
+  /**
+  * @var s_ringBufferStage::p_pipeline
+  * pipeline this stage belongs to.
+  */
+  struct s_ringBufferPipeline *p_pipeline;
+  /**
+  * @var s_ringBufferStage::p_name
+  * name of the stage for reports.
+  */
+  char const *p_name;
+  /**
+  * @var s_ringBufferStage::p_stageFunc
+  * function each worker runs, returns 0 when done, anything else is an error.
+  */
+  int (*p_stageFunc)(struct s_ringBufferStageWorker *p_worker);
+  /**
+  * @var s_ringBufferStage::p_input
+  * ring buffer from the stage before, NULL for the first stage.
+  */
+  struct s_ringBuffer *p_input;
+  /**
+  * @var s_ringBufferStage::p_output
+  * ring buffer to the stage after, NULL for the last stage.
+  */
+  struct s_ringBuffer *p_output;
+  /**
+  * @var s_ringBufferStage::numWorkers
+  * number of worker threads.
+  */
+  unsigned long int numWorkers;
+  /**
+  * @var s_ringBufferStage::numStarted
+  * worker threads started by the last start, the ones join waits on.
+  */
+  unsigned long int numStarted;
+  /**
+  * @var s_ringBufferStage::workersLeft
+  * workers still running, the output is ended when this gets to 0.
+  */
+  unsigned long int workersLeft;
+  /**
+  * @var s_ringBufferStage::cpu
+  * first CPU to pin workers to, RING_BUFFER_PIPELINE_NO_CPU for none.
+  */
+  long int cpu;
+  /**
+  * @var s_ringBufferStage::p_workers
+  * array of workers.
+  */
+  struct s_ringBufferStageWorker *p_workers;
+};
+
+/**
+ * @struct s_ringBufferPipeline
+ * @brief A struct type for a pipeline of stages.
+ */
+struct s_ringBufferPipeline
+{
+  /**
+  * @var s_ringBufferPipeline::buffSize
+  * minimum number of elements for ring buffers between stages.
+  */
+  unsigned long int buffSize;
+  /**
+  * @var s_ringBufferPipeline::elementSize
+  * size of each element in ring buffers between stages.
+  */
+  unsigned long int elementSize;
+  /**
+  * @var s_ringBufferPipeline::numStages
+  * number of stages.
+  */
+  unsigned long int numStages;
+  /**
+  * @var s_ringBufferPipeline::pp_stages
+  * array of stages, in order.
+  */
+  struct s_ringBufferStage **pp_stages;
+  /**
+  * @var s_ringBufferPipeline::error
+  * first error returned by a stage, 0 for none.
+  */
+  volatile int error;
+  /**
+  * @var s_ringBufferPipeline::b_running
+  * true between start and join.
+  */
+  unsigned long int b_running;
+  /**
+  * @var s_ringBufferPipeline::mutex
+  * protects workersLeft, and orders setting error, which is read without it.
+  */
+  pthread_mutex_t mutex;
+};
+
+/**
+ * @struct s_ringBufferStageStats
+ * @brief A struct type for the totals of all workers in a stage.
+ */
+struct s_ringBufferStageStats
+{
+  /**
+  * @var s_ringBufferStageStats::numWorkers
+  * number of worker threads.
+  */
+  unsigned long int numWorkers;
+  /**
+  * @var s_ringBufferStageStats::elementsIn
+  * elements read from the input ring buffer.
+  */
+  unsigned long int elementsIn;
+  /**
+  * @var s_ringBufferStageStats::elementsOut
+  * elements written to the output ring buffer.
+  */
+  unsigned long int elementsOut;
+  /**
+  * @var s_ringBufferStageStats::runTime
+  * seconds of all workers.
+  */
+  double runTime;
+  /**
+  * @var s_ringBufferStageStats::stallInTime
+  * seconds all workers waited on input.
+  */
+  double stallInTime;
+  /**
+  * @var s_ringBufferStageStats::stallOutTime
+  * seconds all workers waited on output.
+  */
+  double stallOutTime;
+};
+
+/*********************************************//**
+  * @brief Initializes a pipeline,
+  * with no stages.
+  *
+  * @param buffSize a minimum number of elements for
+  * the ring buffers between stages.
+  * @param elementSize size of each element in the
+  * ring buffers between stages.
+  *
+  * @return  Initialized pipeline, or NULL on error.
+  *************************************************/
+struct s_ringBufferPipeline *initRingBufferPipeline(unsigned long int const buffSize, unsigned long int const elementSize);
+/*********************************************//**
+  * @brief Destroys pipeline.
+  *
+  * Joins it if still running, then frees every
+  * stage and ring buffer.
+  *
+  * @param iopp_pipeline is a double pointer to
+  * the pipeline to be freed.
+  *************************************************/
+void freeRingBufferPipeline(struct s_ringBufferPipeline **iopp_pipeline);
+/*********************************************//**
+  * @brief Add a stage to the end of the pipeline.
+  *
+  * The stage function is run by each worker thread.
+  * It uses ringBufferStageRead to get input (unless
+  * it is the first stage) and ringBufferStageWrite for
+  * output (unless it is the last stage), and returns
+  * 0 once ringBufferStageRead returns 0 or it has no
+  * more to give. Any other return value stops the
+  * pipeline and is returned by ringBufferPipelineJoin.
+  * Workers of one stage share its input, so only use
+  * more then one where the order of data doesn't matter.
+  *
+  * @param iop_pipeline pipeline to add to.
+  * @param ip_name name of the stage, used for reports.
+  * @param p_stageFunc function the workers run.
+  * @param p_userData given to the function in the worker.
+  * @param numWorkers number of worker threads.
+  * @param cpu first CPU to pin the workers to, worker
+  * n goes on cpu + n. RING_BUFFER_PIPELINE_NO_CPU for none.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+unsigned long int ringBufferPipelineAddStage(struct s_ringBufferPipeline * const iop_pipeline, char const *ip_name, int (*p_stageFunc)(struct s_ringBufferStageWorker *p_worker), void *p_userData, unsigned long int numWorkers, long int cpu);
+/*********************************************//**
+  * @brief Start every stage's worker threads.
+  *
+  * @param iop_pipeline pipeline to start.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+unsigned long int ringBufferPipelineStart(struct s_ringBufferPipeline * const iop_pipeline);
+/*********************************************//**
+  * @brief Wait for every stage to finish.
+  *
+  * @param iop_pipeline pipeline to join.
+  *
+  * @return 0 if every stage finished, otherwise the
+  * first error returned by a stage.
+  *************************************************/
+int ringBufferPipelineJoin(struct s_ringBufferPipeline * const iop_pipeline);
+/*********************************************//**
+  * @brief Start the pipeline and wait for it to finish.
+  *
+  * @param iop_pipeline pipeline to run.
+  *
+  * @return 0 if every stage finished, otherwise the
+  * first error returned by a stage, -1 if it could
+  * not start.
+  *************************************************/
+int ringBufferPipelineRun(struct s_ringBufferPipeline * const iop_pipeline);
+/*********************************************//**
+  * @brief Stop the pipeline.
+  *
+  * Records the error and ends blocking on every ring
+  * buffer. Stage reads and writes return 0 from then on.
+  *
+  * @param iop_pipeline pipeline to stop.
+  * @param error error to record, 0 is ignored.
+  *************************************************/
+void ringBufferPipelineAbort(struct s_ringBufferPipeline * const iop_pipeline, int error);
+/*********************************************//**
+  * @brief Stage Read,
+  * blocking read from the stage input.
+  *
+  * Same as ringBufferBlockingRead with no timeout,
+  * counts the elements and the time spent waiting.
+  *
+  * @param iop_worker worker given to the stage function.
+  * @param op_buffer an output buffer to read into.
+  * @param len the number of elements to be read.
+  *
+  * @return The number of elements read, less then len
+  * or 0 once the stage before is done.
+  *************************************************/
+unsigned long int ringBufferStageRead(struct s_ringBufferStageWorker * const iop_worker, void *op_buffer, unsigned long int len);
+/*********************************************//**
+  * @brief Stage Write,
+  * blocking write to the stage output.
+  *
+  * Writes all of the data, counts the elements and
+  * the time spent waiting for space.
+  *
+  * @param iop_worker worker given to the stage function.
+  * @param ip_buffer an input buffer to write.
+  * @param len the length of the input buffer in elements.
+  *
+  * @return The number of elements written, less then
+  * len if the pipeline was stopped.
+  *************************************************/
+unsigned long int ringBufferStageWrite(struct s_ringBufferStageWorker * const iop_worker, void *ip_buffer, unsigned long int len);
+/*********************************************//**
+  * @brief Get the totals for one stage.
+  *
+  * @param ip_pipeline pipeline to look at.
+  * @param stage index of the stage.
+  * @param op_stats filled with the totals.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+unsigned long int ringBufferPipelineGetStats(struct s_ringBufferPipeline const * const ip_pipeline, unsigned long int stage, struct s_ringBufferStageStats *op_stats);
+/*********************************************//**
+  * @brief Print throughput and stall time per stage.
+  *
+  * The stage that stalls least is the bottleneck,
+  * it is marked so more workers can be given to it.
+  *
+  * @param ip_pipeline pipeline to report on.
+  * @param op_file where to print.
+  *************************************************/
+void ringBufferPipelineReport(struct s_ringBufferPipeline const * const ip_pipeline, FILE *op_file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,146 @@
+/***************************************************************************//**
+  * @file     ringBufferPool.h
+  * @brief    ansi-C ring buffer pool
+  * @details  Pool of ring buffers that are initialized once and recycled. Every ring is
+  * laid out in place in one allocation made by the pool, so getting one is a pop
+  * off of a free list, no malloc and no mutex or condition init.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.19.0 - Initial version, ring buffer pool.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERPOOL_HD
+#define __RINGBUFFERPOOL_HD
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct s_ringBufferPool
+ * @brief A struct type for a pool of ring buffers.
+ */
+struct s_ringBufferPool
+{
+  /**
+  * @var s_ringBufferPool::numRings
+  * number of ring buffers in the pool.
+  */
+  unsigned long int numRings;
+  /**
+  * @var s_ringBufferPool::numFree
+  * number of ring buffers on the free list.
+  */
+  unsigned long int numFree;
+  /**
+  * @var s_ringBufferPool::ringStride
+  * bytes of p_memory each ring buffer takes.
+  */
+  unsigned long int ringStride;
+  /**
+  * @var s_ringBufferPool::p_memory
+  * one block holding every ring buffer, aligned so each starts its stride.
+  */
+  void *p_memory;
+  /**
+  * @var s_ringBufferPool::pp_free
+  * free list, a stack of ring buffers ready to use.
+  */
+  struct s_ringBuffer **pp_free;
+  /**
+  * @var s_ringBufferPool::mutex
+  * protects the free list.
+  */
+  pthread_mutex_t mutex;
+};
+
+/*********************************************//**
+  * @brief Initializes pool,
+  * creates every ring buffer up front.
+  *
+  * @param numRings number of ring buffers.
+  * @param buffSize minimum number of elements for
+  * each ring buffer.
+  * @param elementSize size of each element.
+  *
+  * @return  Initialized pool object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferPool *initRingBufferPool(unsigned long int numRings, unsigned long int buffSize, unsigned long int elementSize);
+/*********************************************//**
+  * @brief Destroys pool object,
+  * and every ring buffer in it.
+  *
+  * Every ring buffer has to be back in the pool.
+  *
+  * @param iopp_ringBufferPool is a double pointer to
+  * the pool object to be freed.
+  *************************************************/
+void freeRingBufferPool(struct s_ringBufferPool **iopp_ringBufferPool);
+/*********************************************//**
+  * @brief Get a ring buffer from the pool.
+  *
+  * The ring buffer is in the state init leaves it in.
+  * Don't call freeRingBuffer on it, put it back.
+  *
+  * @param iop_ringBufferPool is the pool object
+  * to operate on.
+  *
+  * @return A ring buffer, NULL if the pool is empty.
+  *************************************************/
+struct s_ringBuffer *ringBufferPoolGet(struct s_ringBufferPool * const iop_ringBufferPool);
+/*********************************************//**
+  * @brief Put a ring buffer back in the pool.
+  *
+  * Recycles it with ringBufferRecycle, nothing may
+  * still be using it.
+  *
+  * @param iop_ringBufferPool is the pool object
+  * to operate on.
+  * @param iop_ringBuffer ring buffer from ringBufferPoolGet.
+  *
+  * @return 1 on success, 0 if it isn't
+  * from this pool.
+  *************************************************/
+int ringBufferPoolPut(struct s_ringBufferPool * const iop_ringBufferPool, struct s_ringBuffer * const iop_ringBuffer);
+/*********************************************//**
+  * @brief Get Free,
+  * number of ring buffers left in the pool.
+  *
+  * @param ip_ringBufferPool is the pool object
+  * to operate on.
+  *
+  * @return The number of free ring buffers.
+  *************************************************/
+unsigned long int getRingBufferPoolFree(struct s_ringBufferPool * const ip_ringBufferPool);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
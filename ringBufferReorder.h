@@ -0,0 +1,249 @@
+/***************************************************************************//**
+  * @file     ringBufferReorder.h
+  * @brief    ansi-C reorder ring buffer
+  * @details  Put chunks back in order. Producers write chunks tagged with a sequence
+  * number into the slot for it, in any order, the reader only gets the
+  * contiguous prefix of completed chunks. The window is a fixed number of
+  * slots, a producer more then a window ahead of the reader waits.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.25.0 - Initial version, sequence numbered reorder ring.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifndef __RINGBUFFERREORDER_HD
+#define __RINGBUFFERREORDER_HD
+
+#include <ringBuffer.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @struct s_ringBufferReorder
+ * @brief A struct type for a reorder ring, a window of chunk slots.
+ */
+struct s_ringBufferReorder
+{
+  /**
+  * @var s_ringBufferReorder::numSlots
+  * window size, number of chunks in flight at most.
+  */
+  unsigned long int numSlots;
+  /**
+  * @var s_ringBufferReorder::slotSize
+  * largest chunk in bytes.
+  */
+  unsigned long int slotSize;
+  /**
+  * @var s_ringBufferReorder::slotStride
+  * slotSize rounded up to RING_BUFFER_ALIGN.
+  */
+  unsigned long int slotStride;
+  /**
+  * @var s_ringBufferReorder::p_slots
+  * one block holding every slot.
+  */
+  void *p_slots;
+  /**
+  * @var s_ringBufferReorder::p_lens
+  * bytes in each slot, set by commit.
+  */
+  unsigned long int *p_lens;
+  /**
+  * @var s_ringBufferReorder::p_ready
+  * one flag per slot, set from commit till the reader is done with it.
+  */
+  unsigned char *p_ready;
+  /**
+  * @var s_ringBufferReorder::nextSeq
+  * sequence number the reader gets next, the start of the window.
+  */
+  volatile unsigned long int nextSeq;
+  /**
+  * @var s_ringBufferReorder::b_blocking
+  * Boolean, false once blocking is ended.
+  */
+  volatile unsigned long int b_blocking;
+  /**
+  * @var s_ringBufferReorder::mutex
+  * protects the window and the flags.
+  */
+  pthread_mutex_t mutex;
+  /**
+  * @var s_ringBufferReorder::writeCondition
+  * broadcast when the window moves, for producers that are too far ahead.
+  */
+  pthread_cond_t writeCondition;
+  /**
+  * @var s_ringBufferReorder::readCondition
+  * signaled when the chunk at the start of the window is committed.
+  */
+  pthread_cond_t readCondition;
+};
+
+/*********************************************//**
+  * @brief Initializes reorder ring,
+  * creates the window of slots.
+  *
+  * @param numSlots window size, how many chunks past
+  * the reader producers can be working on.
+  * @param slotSize largest chunk in bytes.
+  *
+  * @return  Initialized reorder object, or NULL
+  * on error.
+  *************************************************/
+struct s_ringBufferReorder *initRingBufferReorder(unsigned long int numSlots, unsigned long int slotSize);
+/*********************************************//**
+  * @brief Destroys reorder object,
+  * and its slots.
+  *
+  * @param iopp_ringBufferReorder is a double pointer
+  * to the reorder object to be freed.
+  *************************************************/
+void freeRingBufferReorder(struct s_ringBufferReorder **iopp_ringBufferReorder);
+/*********************************************//**
+  * @brief Acquire a slot,
+  * for the chunk with sequence number seq.
+  *
+  * Waits while seq is a window or more ahead of the
+  * reader. The slot belongs to the caller till it is
+  * committed, fill it in place (pread right into it).
+  * Every sequence number is acquired once.
+  *
+  * @param iop_ringBufferReorder is the reorder object
+  * to operate on.
+  * @param seq sequence number of the chunk, the
+  * first one is 0.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return a slot of slotSize bytes, NULL on timeout,
+  * once blocking is ended, or if seq was already read.
+  *************************************************/
+void *ringBufferReorderAcquire(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int seq, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Commit a slot,
+  * the chunk for seq is complete.
+  *
+  * If it is the next one the reader needs, the
+  * reader wakes and gets it along with any
+  * completed chunks after it.
+  *
+  * @param iop_ringBufferReorder is the reorder object
+  * to operate on.
+  * @param seq sequence number given to acquire.
+  * @param len bytes in the chunk, can be 0.
+  *
+  * @return 1 on success, 0 on error.
+  *************************************************/
+int ringBufferReorderCommit(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int seq, unsigned long int len);
+/*********************************************//**
+  * @brief Write a chunk,
+  * acquire, copy and commit in one call.
+  *
+  * @param iop_ringBufferReorder is the reorder object
+  * to operate on.
+  * @param seq sequence number of the chunk.
+  * @param ip_buffer chunk data.
+  * @param len bytes in the chunk, at most slotSize.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return 1 on success, 0 on error or timeout.
+  *************************************************/
+int ringBufferReorderWrite(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int seq, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Read,
+  * copy out the completed chunks in order.
+  *
+  * Waits for the next chunk, then copies it and the
+  * completed chunks right after it, as many whole
+  * chunks as fit in len. Once blocking ends what is
+  * completed is still read, a gap stops it. One
+  * reader at a time.
+  *
+  * @param iop_ringBufferReorder is the reorder object
+  * to operate on.
+  * @param op_buffer buffer to copy to.
+  * @param len size of op_buffer, at least slotSize.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return bytes read, 0 on timeout or once blocking
+  * is ended and the next chunk isn't there.
+  *************************************************/
+unsigned long int ringBufferReorderRead(struct s_ringBufferReorder * const iop_ringBufferReorder, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Drain,
+  * the completed chunks in order, without a copy.
+  *
+  * Waits for the next chunk, then calls p_drainFunc
+  * on it and every completed chunk right after it,
+  * where they sit. The mutex is not held, producers
+  * keep filling the rest of the window. The slots are
+  * given back once every call returns. One reader at
+  * a time.
+  *
+  * @param iop_ringBufferReorder is the reorder object
+  * to operate on.
+  * @param p_drainFunc called with each chunk, its length
+  * in bytes and p_context.
+  * @param p_context user data passed to p_drainFunc.
+  * @param p_timeToWait optional argument to use timeout
+  * if blocking for too long.
+  *
+  * @return number of chunks drained, 0 on timeout or
+  * once blocking is ended and the next chunk isn't there.
+  *************************************************/
+unsigned long int ringBufferReorderDrain(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec *p_timeToWait);
+/*********************************************//**
+  * @brief Is Alive,
+  * still blocking or the next chunk is waiting to be read.
+  *
+  * @param ip_ringBufferReorder is the reorder object
+  * to operate on.
+  *
+  * @return True if blocking or a chunk is ready.
+  *************************************************/
+unsigned long int ringBufferReorderIsAlive(struct s_ringBufferReorder * const ip_ringBufferReorder);
+/*********************************************//**
+  * @brief End Blocking,
+  * wake everyone.
+  *
+  * Acquires waiting on the window get NULL, the
+  * reader gets the completed prefix then 0.
+  *
+  * @param iop_ringBufferReorder is the reorder object
+  * to operate on.
+  *************************************************/
+void ringBufferReorderEndBlocking(struct s_ringBufferReorder * const iop_ringBufferReorder);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
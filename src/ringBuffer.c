@@ -9,7 +9,32 @@
   * @author  Jay Convertino(electrobs@gmail.com)
   * @date    12/01/2016
   * @version
-  * - 1.6.1 - Fixed examples build in cmake, Threads::Threads missing for Ubuntu 20.04.
+  * - 1.31.0 - Added key ordered merge reader over many ring buffers, merge_sensors example.
+  * 1.30.0 - Added memory budgets shared by ring buffers that grow and shrink, budget_streams example.
+  * 1.29.0 - Added optional USDT probes, RING_BUFFER_USDT cmake option.
+  * 1.28.0 - Added binary tracing of reads and writes, trace_replay example.
+  * 1.27.0 - Added fairness mode, blocked reads and writes served first come first served, max wait metric.
+  * 1.26.0 - Added flat combining for ringBufferWrite, combine_bench example.
+  * 1.25.0 - Added reorder ring for in order delivery from parallel producers, parallel_cp example.
+  * 1.24.0 - Added aligned ring buffers and block segment acquire/commit, file_cp O_DIRECT mode.
+  * 1.23.0 - Added planar read deinterleave and write interleave with SIMD kernels.
+  * 1.22.0 - Added sample format conversion fused into read and write, with SIMD kernels.
+  * 1.21.0 - Added sliding window reads, copied or in place, that only consume the hop.
+  * 1.20.0 - Added descriptor ring with a lock-free buffer pool.
+  * 1.19.0 - Added single allocation init, in place init, recycle and ring buffer pools.
+  * 1.18.0 - Size and status queries are lock-free.
+  * 1.17.0 - Added monotonic absolute deadlines, Until variants of the blocking calls.
+  * 1.16.0 - Added blocking read/write range calls, file_cp consumer uses them.
+  * 1.15.0 - Added streaming and prefetch copy kernels, with copy modes.
+  * 1.14.0 - Added CRC32C integrity checking fused into the copies.
+  * 1.13.0 - Added multi stage pipelines, end blocking now wakes every waiter.
+  * 1.12.0 - Added overflow policies for non-blocking write, overwrite now drops whole oldest elements.
+  * 1.11.0 - Added priority lanes with strict and weighted round robin draining.
+  * 1.10.0 - Added sharded ring buffer groups with work stealing consumers.
+  * 1.9.0 - Added wait sets to block on many ring buffers at once.
+  * 1.8.0 - Added in place drain with callback, blocking and timed.
+  * 1.7.0 - Added async read/write with completion callbacks for coroutine schedulers.
+  * 1.6.1 - Fixed examples build in cmake, Threads::Threads missing for Ubuntu 20.04.
   * 1.6.0 - Added new method for checking if the buffer is alive to help with mutex locks being abused.
   * 1.5.4 - Cast pointer to char so the library isn't using GCC void * math.
   * 1.5.3 - Element size was being put into buffer size twice... buffers too big.
@@ -46,56 +71,343 @@
   * IN THE SOFTWARE.
   *****************************************************************************/
 
+#define _GNU_SOURCE
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
 
 #include <ringBuffer.h>
+#include <ringBufferBudget.h>
 
 #define CONT_BLOCKING 1
 #define STOP_BLOCKING 0
 #define PROC_SUCC 1
 #define PROC_FAIL 0
+/* indexes and b_blocking are stored with release under the mutex, and loaded with acquire by the lock-free queries. */
+#define ATOMIC_LOAD(var)        __atomic_load_n(&(var), __ATOMIC_ACQUIRE)
+#define ATOMIC_STORE(var, val)  __atomic_store_n(&(var), (val), __ATOMIC_RELEASE)
+/* memFlags, what free and resize have to give back to malloc. */
+#define OWN_OBJECT 1
+#define OWN_BUFFER 2
+/* round up to the ring buffer alignment. */
+#define ALIGN_UP(val) (((val) + RING_BUFFER_ALIGN - 1) & ~(unsigned long int)(RING_BUFFER_ALIGN - 1))
+/* async op is being started by its owner, complete it without the callback. */
+#define ASYNC_IN_CALL (~0UL)
+/* times a combining writer checks its record before it waits on the mutex instead. */
+#define COMBINE_SPINS 256
+/* times the combiner takes the stack, so it isn't stuck combining for everyone forever. */
+#define COMBINE_PASSES 4
+/* changes in a row a grown budget buffer stays under its low water mark before it shrinks back. */
+#define BUDGET_IDLE_CHANGES 16
+/* USDT probes, provider ringbuffer. Without RING_BUFFER_USDT they and their arguments compile to nothing. */
+#ifdef RING_BUFFER_USDT
+#include <sys/sdt.h>
+#define PROBE2(name, a1, a2)         DTRACE_PROBE2(ringbuffer, name, a1, a2)
+#define PROBE3(name, a1, a2, a3)     DTRACE_PROBE3(ringbuffer, name, a1, a2, a3)
+#define PROBE4(name, a1, a2, a3, a4) DTRACE_PROBE4(ringbuffer, name, a1, a2, a3, a4)
+#else
+#define PROBE2(name, a1, a2)
+#define PROBE3(name, a1, a2, a3)
+#define PROBE4(name, a1, a2, a3, a4)
+#endif
+
+/* tell the core we are spinning. */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CPU_RELAX() __builtin_ia32_pause()
+#elif defined(__GNUC__) && defined(__aarch64__)
+#define CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define CPU_RELAX()
+#endif
 
 /*  private helper functions */
 /*  write size of the ring buffer, no thread protection */
 unsigned long int writeSize(struct s_ringBuffer const * const ip_ringBuffer);
 /*  read size of the ring buffer, no thread protection */
 unsigned long int readSize(struct s_ringBuffer const * const ip_ringBuffer);
+/*  load head and tail as a pair that was true at one point, no lock needed. */
+void loadIndexes(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int *op_headIndex, unsigned long int *op_tailIndex, unsigned long int *op_indexMask, unsigned long int *op_buffSize);
+/*  write size without the lock. */
+unsigned long int atomicWriteSize(struct s_ringBuffer const * const ip_ringBuffer);
+/*  read size without the lock. */
+unsigned long int atomicReadSize(struct s_ringBuffer const * const ip_ringBuffer);
 /*  raw write to the ring buffer. No thread protection. */
 unsigned long int rawWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len);
 /*  raw read to from the ring buffer. No thread protection. */
 unsigned long int rawRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len);
+/*  raw read that also updates op_crc, op_buffer NULL only advances the tail. No thread protection. */
+unsigned long int rawReadCrc(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, unsigned long int *op_crc);
+/*  blocking write loop, ip_convert NULL for a plain write. */
+unsigned long int blockingWriteUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline);
+/*  blocking read loop, ip_convert NULL for a plain read. */
+unsigned long int blockingReadUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline);
+/*  rawWrite, or rawWriteConvert if there is a conversion. No thread protection. */
+unsigned long int transferWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert);
+/*  rawRead, or rawReadConvert if there is a conversion. No thread protection. */
+unsigned long int transferRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert);
+/*  raw write converting from the user format, len is in ring bytes. No thread protection. */
+unsigned long int rawWriteConvert(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert);
+/*  raw read converting to the user format, len is in ring bytes. No thread protection. */
+unsigned long int rawReadConvert(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert);
+/*  check a conversion can be used with this ring buffer. */
+unsigned long int checkConvert(struct s_ringBuffer const * const ip_ringBuffer, struct s_ringBufferConvert const *ip_convert);
+/*  bytes of the user buffer for len bytes of the ring buffer. */
+unsigned long int userLength(struct s_ringBufferConvert const *ip_convert, unsigned long int len);
+/*  raw read into one array per channel, len is in bytes of whole frames. No thread protection. */
+unsigned long int rawReadDeinterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *op_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len);
+/*  raw write from one array per channel, len is in bytes of whole frames. No thread protection. */
+unsigned long int rawWriteInterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *ip_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len);
+/*  check the channel layout fits the elements. */
+unsigned long int checkFrames(struct s_ringBuffer const * const ip_ringBuffer, void * const *ip_channels, unsigned long int numChannels, unsigned long int sampleSize);
+/*  add a CRC record for a write to the integrity list. No thread protection. */
+unsigned long int appendCrcRecord(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len, unsigned long int crc, unsigned long int b_valid);
+/*  check the bytes read against the CRC records, copying them to op_dest if not NULL. No thread protection. */
+void consumeCrcRecords(struct s_ringBuffer * const iop_ringBuffer, void *op_dest, void const *ip_src, unsigned long int len);
+/*  the overflow policy threw away len bytes at the tail, drop them from the CRC records. No thread protection. */
+void dropCrcRecords(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len);
+/*  start the CRC records over, anything already in the buffer can't be checked. No thread protection. */
+void resetCrcRecords(struct s_ringBuffer * const iop_ringBuffer);
+/*  copy kernel to use for a copy of len bytes, autoMode is what RING_BUFFER_COPY_AUTO picks over the threshold. */
+unsigned long int pickCopyMode(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int len, unsigned long int autoMode);
 /*  General allocate method for the buffer. Used in the init and resize methods. */
 unsigned long int allocateBuffer(struct s_ringBuffer * const iop_ringBuffer, unsigned long int buffSize, unsigned long int elementSize);
 /*  check the state of blocking, have we timed out? Did we error out? */
-unsigned long int checkContinueBlocking(struct s_ringBuffer * const iop_ringBuffer, struct timespec *p_timeToWait);
+unsigned long int checkContinueBlocking(struct s_ringBuffer * const iop_ringBuffer, struct timespec const *ip_deadline);
+/*  write by the overflow policy, never waits. No thread protection. */
+unsigned long int policyWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len);
+/*  call the drain function on the data in place, advancing the tail by what it consumed. No thread protection. */
+unsigned long int rawDrain(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context);
+/*  show the window at the tail to the window function, or copy it out, then advance the tail by the hop. No thread protection. */
+unsigned long int rawWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int window, unsigned long int hop, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context);
+/*  non-blocking window read or drain. */
+unsigned long int lockedWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context);
+/*  blocking window read or drain, waits till the deadline for a full window. */
+unsigned long int windowUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context, struct timespec const *ip_deadline);
+/*  which of the wait set events is the ring buffer ready for. No thread protection. */
+unsigned long int readyEvents(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int events);
+/*  put a ready wait set entry on its ready list. No thread protection on the ring buffer. */
+void queueWaitEntry(struct s_ringBufferWaitEntry * const iop_entry);
+/*  publish a change in the buffer state to anyone waiting on it. No thread protection. */
+void notifyChange(struct s_ringBuffer * const iop_ringBuffer);
+/*  move data for queued async operations, completing what can be completed. No thread protection. */
+void serviceAsync(struct s_ringBuffer * const iop_ringBuffer);
+/*  pop the head async op off of a queue and call its callback. No thread protection. */
+void completeAsync(struct s_ringBufferAsyncOp **iopp_head, struct s_ringBufferAsyncOp **iopp_tail, unsigned long int status);
+/*  init a condition that times out against CLOCK_MONOTONIC, so deadlines don't move with the wall clock. */
+int initMonotonicCondition(pthread_cond_t *op_condition);
+/*  check the sizes, and return the power of two buffer size in bytes. 0 if they are no good. */
+unsigned long int roundBufferSize(unsigned long int buffSize, unsigned long int elementSize);
+/*  publish a write, then combine or wait for a combiner. len is in bytes. */
+unsigned long int combinedWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len);
+/*  apply the published writes in the order they were published. No thread protection. */
+unsigned long int combineWrites(struct s_ringBuffer * const iop_ringBuffer);
+/*  contiguous bytes free at the head, or used at the tail, up to the end of the buffer. */
+unsigned long int segmentSize(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int b_write);
+/*  check the block size and wait for a write or read segment of whole blocks. */
+unsigned long int acquireUntil(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, unsigned long int b_write, struct timespec const *ip_deadline);
+/*  is it this request's turn? In fairness mode it gets in line when it has to wait. No thread protection. */
+unsigned long int takeTurn(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferWaiter * const iop_waiter, unsigned long int need, unsigned long int b_write);
+/*  wait in line on the waiter's own condition, same results as checkContinueBlocking. */
+unsigned long int fairWait(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferWaiter * const iop_waiter, struct timespec const *ip_deadline);
+/*  get out of line, the next in line may have been waiting on us. No thread protection. */
+void leaveLine(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferWaiter * const iop_waiter, unsigned long int b_write);
+/*  wake the first writer and reader in line if their requests fit. No thread protection. */
+void wakeLines(struct s_ringBuffer * const iop_ringBuffer);
+/*  read the clock for a traced call, zero when not tracing. */
+void traceClock(struct s_ringBuffer const * const ip_ringBuffer, struct timespec *op_start);
+/*  write a trace record for a call that started at ip_start, lengths in elements. No thread protection. */
+void traceCall(struct s_ringBuffer * const iop_ringBuffer, unsigned long int op, unsigned long int outcome, unsigned long int len, unsigned long int minLen, unsigned long int result, struct timespec const *ip_deadline, struct timespec const *ip_start);
+/*  close the trace file, returns the records written. No thread protection. */
+unsigned long int closeTrace(struct s_ringBuffer * const iop_ringBuffer);
+/*  nanoseconds from ip_from to ip_to, 0 if ip_to is first. */
+unsigned long int elapsedNs(struct timespec const *ip_from, struct timespec const *ip_to);
+/*  grow a buffer on a budget till need bytes fit, if the budget has room. No thread protection. */
+unsigned long int budgetGrow(struct s_ringBuffer * const iop_ringBuffer, unsigned long int need);
+/*  put a drained buffer on a budget back to its reserved size. No thread protection. */
+void budgetShrink(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_now);
+/*  wait for the budget to give or the buffer to change, same results as checkContinueBlocking. */
+unsigned long int budgetWait(struct s_ringBuffer * const iop_ringBuffer, struct timespec const *ip_deadline);
+/*  geometry goes odd before the buffer and indexes are swapped. No thread protection. */
+void beginGeometry(struct s_ringBuffer * const iop_ringBuffer);
+/*  geometry goes even once the swap is published. No thread protection. */
+void endGeometry(struct s_ringBuffer * const iop_ringBuffer);
 
 /*  public  functions */
-/*  init, calls allocate buffer to setup the size. */
+/*  init, one allocation laid out by the in place init. */
 struct s_ringBuffer *initRingBuffer(unsigned long int const buffSize, unsigned long int const elementSize)
 {
+  return initRingBufferAligned(buffSize, elementSize, RING_BUFFER_ALIGN);
+}
+
+/*  init, one allocation on the alignment with the control block placed so the data after it lands on it too. */
+struct s_ringBuffer *initRingBufferAligned(unsigned long int const buffSize, unsigned long int const elementSize, unsigned long int const alignment)
+{
+  unsigned long int memSize = 0;
+  unsigned long int offset = 0;
+
+  void *p_memory = NULL;
+
   struct s_ringBuffer *p_tempBuffer = NULL;
 
-  p_tempBuffer = malloc(sizeof(struct s_ringBuffer));
+  if((alignment < RING_BUFFER_ALIGN) || (alignment & (alignment - 1)))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Alignment must be a power of two, at least %d.\n", RING_BUFFER_ALIGN);
+    return NULL;
+  }
+
+  memSize = ringBufferInPlaceSize(buffSize, elementSize);
+
+  if(!memSize)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Object Failed.\n");
+    return NULL;
+  }
+
+  /* both are multiples of RING_BUFFER_ALIGN, so the in place init uses the control block where we put it. */
+  offset = (ALIGN_UP(sizeof(struct s_ringBuffer)) + alignment - 1) / alignment * alignment - ALIGN_UP(sizeof(struct s_ringBuffer));
+
+  if(posix_memalign(&p_memory, alignment, offset + memSize)) p_memory = NULL;
   
-  if(!p_tempBuffer)
+  if(!p_memory)
   {
     perror("ANSI-C RING BUFFER: Could not allocate buffer object.");
     return NULL;
   }
-  
-  memset(p_tempBuffer, 0, sizeof(*p_tempBuffer));
 
-  if(!allocateBuffer(p_tempBuffer, buffSize, elementSize))
+  p_tempBuffer = ringBufferInitInPlace(((char *)p_memory) + offset, memSize, buffSize, elementSize);
+
+  if(!p_tempBuffer)
   {
     fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Object Failed.\n");
+    free(p_memory);
     return NULL;
   }
+
+  p_tempBuffer->p_memory = p_memory;
+  p_tempBuffer->memFlags = OWN_OBJECT;
+  p_tempBuffer->alignment = alignment;
   
   return p_tempBuffer;
 }
 
+/*  bytes ringBufferInitInPlace needs, control block and data, with room to align both. */
+unsigned long int ringBufferInPlaceSize(unsigned long int buffSize, unsigned long int elementSize)
+{
+  unsigned long int byteSize = 0;
+
+  byteSize = roundBufferSize(buffSize, elementSize);
+
+  if(!byteSize) return 0;
+
+  /* one more element after the data, scratch for an element split by the end of the buffer. */
+  return (RING_BUFFER_ALIGN - 1) + ALIGN_UP(sizeof(struct s_ringBuffer)) + byteSize + elementSize;
+}
+
+/*  init in memory we are given, control block first, data after it on an aligned boundary. */
+struct s_ringBuffer *ringBufferInitInPlace(void *iop_memory, unsigned long int memSize, unsigned long int buffSize, unsigned long int elementSize)
+{
+  unsigned long int byteSize = 0;
+
+  struct s_ringBuffer *p_tempBuffer = NULL;
+
+  if(!iop_memory)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Memory for the ring buffer is NULL.\n");
+    return NULL;
+  }
+
+  byteSize = roundBufferSize(buffSize, elementSize);
+
+  if(!byteSize) return NULL;
+
+  if(memSize < ringBufferInPlaceSize(buffSize, elementSize))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Memory for the ring buffer must be at least %lu bytes.\n", ringBufferInPlaceSize(buffSize, elementSize));
+    return NULL;
+  }
+
+  p_tempBuffer = (struct s_ringBuffer *)ALIGN_UP((unsigned long int)iop_memory);
+
+  memset(p_tempBuffer, 0, sizeof(*p_tempBuffer));
+
+  p_tempBuffer->copyThreshold = RING_BUFFER_COPY_THRESHOLD;
+  p_tempBuffer->alignment = RING_BUFFER_ALIGN;
+
+  if(pthread_mutex_init(&p_tempBuffer->rwMutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer mutex init failed.\n");
+    return NULL;
+  }
+
+  if(!initMonotonicCondition(&p_tempBuffer->condition))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer condition init failed.\n");
+    pthread_mutex_destroy(&p_tempBuffer->rwMutex);
+    return NULL;
+  }
+
+  p_tempBuffer->buffSize = byteSize;
+  /* we subtract one to create a mask of 01111 from the size of 1000, we include 0 remember! */
+  p_tempBuffer->indexMask = byteSize - 1;
+  p_tempBuffer->elementSize = elementSize;
+  p_tempBuffer->b_blocking = 1;
+  p_tempBuffer->p_buffer = ((char *)p_tempBuffer) + ALIGN_UP(sizeof(*p_tempBuffer));
+
+  return p_tempBuffer;
+}
+
+/*  back to the state init left it in, keeping the memory, mutex and condition. */
+void ringBufferRecycle(struct s_ringBuffer * const iop_ringBuffer)
+{
+  struct s_ringBufferWaitSet *p_waitSet = NULL;
+
+  if(!iop_ringBuffer) return;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  /* wait sets can't keep watching a buffer that is handed to someone else. The remove takes the mutex itself, only the look at the list is under ours. */
+  while(iop_ringBuffer->p_waitEntries)
+  {
+    p_waitSet = iop_ringBuffer->p_waitEntries->p_waitSet;
+
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+    ringBufferWaitSetRemove(p_waitSet, iop_ringBuffer);
+
+    pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+  }
+
+  while(iop_ringBuffer->p_asyncReadHead) completeAsync(&iop_ringBuffer->p_asyncReadHead, &iop_ringBuffer->p_asyncReadTail, RING_BUFFER_ASYNC_CANCELLED);
+
+  while(iop_ringBuffer->p_asyncWriteHead) completeAsync(&iop_ringBuffer->p_asyncWriteHead, &iop_ringBuffer->p_asyncWriteTail, RING_BUFFER_ASYNC_CANCELLED);
+
+  ATOMIC_STORE(iop_ringBuffer->headIndex, 0);
+  ATOMIC_STORE(iop_ringBuffer->tailIndex, 0);
+
+  budgetShrink(iop_ringBuffer, 1);
+
+  iop_ringBuffer->overflowPolicy = RING_BUFFER_OVERWRITE_OLDEST;
+  iop_ringBuffer->dropped = 0;
+  iop_ringBuffer->lapped = 0;
+  iop_ringBuffer->b_integrity = 0;
+  iop_ringBuffer->crcErrors = 0;
+  iop_ringBuffer->copyMode = RING_BUFFER_COPY_AUTO;
+  iop_ringBuffer->copyThreshold = RING_BUFFER_COPY_THRESHOLD;
+  iop_ringBuffer->b_combining = 0;
+  iop_ringBuffer->b_fair = 0;
+  iop_ringBuffer->maxWait = 0;
+
+  closeTrace(iop_ringBuffer);
+
+  resetCrcRecords(iop_ringBuffer);
+
+  ATOMIC_STORE(iop_ringBuffer->b_blocking, 1);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+}
+
 /*  free the resources allocated to the buffer */
 void freeRingBuffer(struct s_ringBuffer **iopp_ringBuffer)
 {
@@ -103,8 +415,26 @@ void freeRingBuffer(struct s_ringBuffer **iopp_ringBuffer)
   
   if(!*iopp_ringBuffer) return;
   
-  free((*iopp_ringBuffer)->p_buffer);
-  free(*iopp_ringBuffer);
+  /* wait sets can't hold on to a freed buffer. */
+  while((*iopp_ringBuffer)->p_waitEntries)
+  {
+    ringBufferWaitSetRemove((*iopp_ringBuffer)->p_waitEntries->p_waitSet, *iopp_ringBuffer);
+  }
+
+  ringBufferTraceStop(*iopp_ringBuffer);
+
+  /* the reservation, and a grown buffer if it has one. */
+  if((*iopp_ringBuffer)->p_budget) ringBufferBudgetGive((*iopp_ringBuffer)->p_budget, (*iopp_ringBuffer)->budgetMin + ((*iopp_ringBuffer)->buffSize > (*iopp_ringBuffer)->budgetMin ? (*iopp_ringBuffer)->buffSize : 0));
+
+  pthread_cond_destroy(&(*iopp_ringBuffer)->condition);
+  pthread_mutex_destroy(&(*iopp_ringBuffer)->rwMutex);
+
+  free((*iopp_ringBuffer)->p_crcRecords);
+
+  /* in place buffers only own what resize allocated. */
+  if((*iopp_ringBuffer)->memFlags & OWN_BUFFER) free((*iopp_ringBuffer)->p_buffer);
+
+  if((*iopp_ringBuffer)->memFlags & OWN_OBJECT) free((*iopp_ringBuffer)->p_memory);
 }
 
 /*  simple true false, are we empty. read size 0 equals 0, we are empty. */
@@ -126,97 +456,52 @@ unsigned long int ringBufferIsFull(struct s_ringBuffer * const ip_ringBuffer)
 /*  Simple true false are we blocking. bool is 1 and equals 1, we are blocking (true). */
 unsigned long int ringBufferStillBlocking(struct s_ringBuffer * const ip_ringBuffer)
 {
-  unsigned long int boolResult = 0;
-  
   if(!ip_ringBuffer) return ERROR_NULL;
   
-  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
-  
-  boolResult = ip_ringBuffer->b_blocking == 1;
-  
-  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
-  
-  return boolResult;
+  return ATOMIC_LOAD(ip_ringBuffer->b_blocking) == 1;
 }
 
 /* Are we still blocking or do we still have bytes? Either case should keep reading. */
 unsigned long int ringBufferIsAlive(struct s_ringBuffer * const ip_ringBuffer)
 {
-  unsigned long int boolResult = 0;
-
   if(!ip_ringBuffer) return ERROR_NULL;
 
-  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
-
-  boolResult = (ip_ringBuffer->b_blocking == 1) || (readSize(ip_ringBuffer) > 0);
-
-  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
+  /* blocking first, once it reads ended every write before the end is visible to the size. */
+  if(ATOMIC_LOAD(ip_ringBuffer->b_blocking) == 1) return 1;
 
-  return boolResult;
+  return atomicReadSize(ip_ringBuffer) > 0;
 }
 
 /*  What is the write size in elements? */
 unsigned long int getRingBufferWriteSize(struct s_ringBuffer * const ip_ringBuffer)
 {
-  unsigned long int tempSize = 0;
-  
   if(!ip_ringBuffer) return ERROR_NULL;
 
-  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
-  
-  tempSize = writeSize(ip_ringBuffer) / ip_ringBuffer->elementSize;
-  
-  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
-  
-  return tempSize;
+  return atomicWriteSize(ip_ringBuffer) / ATOMIC_LOAD(ip_ringBuffer->elementSize);
 }
 
 /*  What is the write size in bytes? */
 unsigned long int getRingBufferWriteByteSize(struct s_ringBuffer * const ip_ringBuffer)
 {
-  unsigned long int tempSize = 0;
-  
   if(!ip_ringBuffer) return ERROR_NULL;
 
-  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
-  
-  tempSize = writeSize(ip_ringBuffer);
-  
-  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
-  
-  return tempSize;
+  return atomicWriteSize(ip_ringBuffer);
 }
 
 /*  What is the read size in elements? */
 unsigned long int getRingBufferReadSize(struct s_ringBuffer * const ip_ringBuffer)
 {
-  unsigned long int tempSize = 0;
-  
   if(!ip_ringBuffer) return ERROR_NULL;
 
-  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
-  
-  tempSize = readSize(ip_ringBuffer) / ip_ringBuffer->elementSize; 
-  
-  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
-  
-  return tempSize;
+  return atomicReadSize(ip_ringBuffer) / ATOMIC_LOAD(ip_ringBuffer->elementSize);
 }
 
 /*  What is the read size in bytes? */
 unsigned long int getRingBufferReadByteSize(struct s_ringBuffer * const ip_ringBuffer)
 {
-  unsigned long int tempSize = 0;
-  
   if(!ip_ringBuffer) return ERROR_NULL;
 
-  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
-  
-  tempSize = readSize(ip_ringBuffer); 
-  
-  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
-  
-  return tempSize;
+  return atomicReadSize(ip_ringBuffer);
 }
 
 /*  What is the size of the elements? */
@@ -247,12 +532,33 @@ unsigned long int getRingBufferSize(struct s_ringBuffer const * const ip_ringBuf
 unsigned long int ringBufferResize(struct s_ringBuffer * const io_ringBuffer, unsigned long int bufferSize, unsigned long int elementSize)
 {
   if(!io_ringBuffer) return ERROR_NULL;
+
+  /* the budget sizes it. */
+  if(io_ringBuffer->p_budget)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer on a budget can't be resized.\n");
+    return ERROR_NULL;
+  }
   
   pthread_mutex_lock(&io_ringBuffer->rwMutex);
+
+  /* an acquired segment points into the buffer. */
+  if(io_ringBuffer->segmentsHeld)
+  {
+    pthread_mutex_unlock(&io_ringBuffer->rwMutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer can't be resized while a segment is acquired.\n");
+    return ERROR_NULL;
+  }
+
+  PROBE3(resize, io_ringBuffer, getRingBufferByteSize(io_ringBuffer), bufferSize * elementSize);
+
+  beginGeometry(io_ringBuffer);
   
   /* we return a 1 on success, 0 on failure... if we fail the buffer stays at its current size. */
   if(!allocateBuffer(io_ringBuffer, bufferSize, elementSize))
   {
+    endGeometry(io_ringBuffer);
     pthread_mutex_unlock(&io_ringBuffer->rwMutex);
     return ERROR_NULL;
   }
@@ -260,14 +566,21 @@ unsigned long int ringBufferResize(struct s_ringBuffer * const io_ringBuffer, un
   /* change index sizes */
   if(io_ringBuffer->headIndex >= io_ringBuffer->buffSize)
   {
-    io_ringBuffer->headIndex = io_ringBuffer->buffSize - 1;
+    ATOMIC_STORE(io_ringBuffer->headIndex, io_ringBuffer->buffSize - 1);
   }
   
   if(io_ringBuffer->tailIndex > io_ringBuffer->buffSize)
   {
-    io_ringBuffer->tailIndex = io_ringBuffer->buffSize;
+    ATOMIC_STORE(io_ringBuffer->tailIndex, io_ringBuffer->buffSize);
   }
+
+  endGeometry(io_ringBuffer);
   
+  /* the data moved, the records no longer line up with it. */
+  resetCrcRecords(io_ringBuffer);
+
+  notifyChange(io_ringBuffer);
+
   pthread_mutex_unlock(&io_ringBuffer->rwMutex);
   
   return getRingBufferSize(io_ringBuffer);
@@ -275,65 +588,159 @@ unsigned long int ringBufferResize(struct s_ringBuffer * const io_ringBuffer, un
 
 /*  Write to the buffer, blocking method, will not return till it writes, times out, or blocking is disabled. */
 unsigned long int ringBufferBlockingWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct timespec * p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingWriteUntil(iop_ringBuffer, ip_buffer, len, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingWriteUntil(iop_ringBuffer, ip_buffer, len, &deadline);
+}
+
+/*  same as ringBufferBlockingWrite, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingWriteUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct timespec const *ip_deadline)
+{
+  return blockingWriteUntil(iop_ringBuffer, ip_buffer, len, NULL, ip_deadline);
+}
+
+/*  Read from the buffer, blocking method, will not return till it reads, times out, or blocking is disabled. */
+unsigned long int ringBufferBlockingRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingReadUntil(iop_ringBuffer, op_buffer, len, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingReadUntil(iop_ringBuffer, op_buffer, len, &deadline);
+}
+
+/*  same as ringBufferBlockingRead, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingReadUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct timespec const *ip_deadline)
+{
+  return blockingReadUntil(iop_ringBuffer, op_buffer, len, NULL, ip_deadline);
+}
+
+/*  Write at least minElems, blocking till they fit, and as many more as fit up to maxElems. */
+unsigned long int ringBufferBlockingWriteRange(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingWriteRangeUntil(iop_ringBuffer, ip_buffer, minElems, maxElems, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingWriteRangeUntil(iop_ringBuffer, ip_buffer, minElems, maxElems, &deadline);
+}
+
+/*  same as ringBufferBlockingWriteRange, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingWriteRangeUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec const *ip_deadline)
 {
   unsigned long int totalWrote = 0;
-  unsigned long int wrote = 0;
-  unsigned long int writeLen = 0;
-  
+  unsigned long int askLen = maxElems;
+
+  struct timespec start;
+
+  struct s_ringBufferWaiter waiter;
+
   if(!iop_ringBuffer) return 0;
-  
+
   if(!ip_buffer)
   {
     fprintf(stderr, "ANSI-C RING BUFFER: Input buffer is NULL.\n");
     return 0;
   }
 
-  if(len <= 0) return totalWrote;
+  if(maxElems <= 0) return totalWrote;
+
+  if(!iop_ringBuffer->b_blocking) return ringBufferWrite(iop_ringBuffer, ip_buffer, maxElems);
 
-  if(!iop_ringBuffer->b_blocking) return ringBufferWrite(iop_ringBuffer, ip_buffer, len);
+  traceClock(iop_ringBuffer, &start);
 
   pthread_mutex_lock(&iop_ringBuffer->rwMutex);
 
-  len *= iop_ringBuffer->elementSize;
-  
-  do
+  minElems = (minElems < maxElems ? minElems : maxElems) * iop_ringBuffer->elementSize;
+  maxElems *= iop_ringBuffer->elementSize;
+
+  budgetGrow(iop_ringBuffer, maxElems);
+
+  /* can never have room for more then the buffer holds. */
+  if(minElems > writeSize(iop_ringBuffer) + readSize(iop_ringBuffer))
   {
-    writeLen = (len >= getRingBufferByteSize(iop_ringBuffer) ? getRingBufferByteSize(iop_ringBuffer) - 1 : len);
+    minElems = (writeSize(iop_ringBuffer) + readSize(iop_ringBuffer)) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  /* only gets in line if it has to wait in fairness mode. */
+  waiter.b_queued = 0;
+
+  while(!takeTurn(iop_ringBuffer, &waiter, minElems, 1))
+  {
+    /* the budget may have room now. */
+    if(budgetGrow(iop_ringBuffer, maxElems)) continue;
 
-    while(writeLen > writeSize(iop_ringBuffer))
+    if(!(waiter.b_queued ? fairWait(iop_ringBuffer, &waiter, ip_deadline) : checkContinueBlocking(iop_ringBuffer, ip_deadline)))
     {
-      if(!checkContinueBlocking(iop_ringBuffer, p_timeToWait))
+      leaveLine(iop_ringBuffer, &waiter, 1);
+
+      /* blocking ended, write by the overflow policy. */
+      if(!iop_ringBuffer->b_blocking)
       {
-        /* mirror read fix, could be an issue... needs testing */
-        if(!iop_ringBuffer->b_blocking) return ringBufferWrite(iop_ringBuffer, ip_buffer, len / iop_ringBuffer->elementSize);
+        traceCall(iop_ringBuffer, RING_BUFFER_TRACE_WRITE_RANGE, RING_BUFFER_TRACE_ENDED, askLen, minElems / iop_ringBuffer->elementSize, 0, ip_deadline, &start);
 
-        /* mirror read fix, doesn't seem like it would do much for the write case */
-        if(writeLen <= writeSize(iop_ringBuffer)) break;
-        
-        return totalWrote / iop_ringBuffer->elementSize;
+        pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+        return ringBufferWrite(iop_ringBuffer, ip_buffer, maxElems / iop_ringBuffer->elementSize);
       }
+
+      if(minElems <= writeSize(iop_ringBuffer)) break;
+
+      traceCall(iop_ringBuffer, RING_BUFFER_TRACE_WRITE_RANGE, RING_BUFFER_TRACE_TIMEOUT, askLen, minElems / iop_ringBuffer->elementSize, 0, ip_deadline, &start);
+
+      pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+      return 0;
     }
+  }
 
-    wrote = rawWrite(iop_ringBuffer, ip_buffer + totalWrote, writeLen);
-    totalWrote += wrote;
-    len -= wrote;
-    
-    pthread_cond_signal(&iop_ringBuffer->condition);
+  if(maxElems > writeSize(iop_ringBuffer))
+  {
+    maxElems = writeSize(iop_ringBuffer) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
   }
-  while(len > 0);
-  
+
+  totalWrote = (maxElems > 0 ? rawWrite(iop_ringBuffer, ip_buffer, maxElems) : 0);
+
+  traceCall(iop_ringBuffer, RING_BUFFER_TRACE_WRITE_RANGE, RING_BUFFER_TRACE_DONE, askLen, minElems / iop_ringBuffer->elementSize, totalWrote / iop_ringBuffer->elementSize, ip_deadline, &start);
+
+  notifyChange(iop_ringBuffer);
+  leaveLine(iop_ringBuffer, &waiter, 1);
   pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
 
   return totalWrote / iop_ringBuffer->elementSize;
 }
 
-/*  Read from the buffer, blocking method, will not return till it reads, times out, or blocking is disabled. */
-unsigned long int ringBufferBlockingRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait)
+/*  Read at least minElems, blocking till they are there, and as many more as are there up to maxElems. */
+unsigned long int ringBufferBlockingReadRange(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingReadRangeUntil(iop_ringBuffer, op_buffer, minElems, maxElems, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingReadRangeUntil(iop_ringBuffer, op_buffer, minElems, maxElems, &deadline);
+}
+
+/*  same as ringBufferBlockingReadRange, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingReadRangeUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int minElems, unsigned long int maxElems, struct timespec const *ip_deadline)
 {
   unsigned long int totalRead = 0;
-  unsigned long int read = 0;
-  unsigned long int readLen = 0;
-  
+  unsigned long int askLen = maxElems;
+
+  struct timespec start;
+
+  struct s_ringBufferWaiter waiter;
+
   if(!iop_ringBuffer) return 0;
 
   if(!op_buffer)
@@ -342,42 +749,65 @@ unsigned long int ringBufferBlockingRead(struct s_ringBuffer * const iop_ringBuf
     return 0;
   }
 
-  if(len <= 0) return totalRead;
-  
-  if(!iop_ringBuffer->b_blocking) return ringBufferRead(iop_ringBuffer,op_buffer, len);
+  if(maxElems <= 0) return totalRead;
+
+  if(!iop_ringBuffer->b_blocking) return ringBufferRead(iop_ringBuffer, op_buffer, maxElems);
+
+  traceClock(iop_ringBuffer, &start);
 
   pthread_mutex_lock(&iop_ringBuffer->rwMutex);
-  
-  len *= iop_ringBuffer->elementSize;
-  
-  do
+
+  minElems = (minElems < maxElems ? minElems : maxElems) * iop_ringBuffer->elementSize;
+  maxElems *= iop_ringBuffer->elementSize;
+
+  /* can never have more then the buffer holds. */
+  if(minElems > writeSize(iop_ringBuffer) + readSize(iop_ringBuffer))
   {
-    readLen = (len >= getRingBufferByteSize(iop_ringBuffer) ? getRingBufferByteSize(iop_ringBuffer) - 1 : len);
-    
-    while(readLen > readSize(iop_ringBuffer))
+    minElems = (writeSize(iop_ringBuffer) + readSize(iop_ringBuffer)) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  /* only gets in line if it has to wait in fairness mode. */
+  waiter.b_queued = 0;
+
+  while(!takeTurn(iop_ringBuffer, &waiter, minElems, 0))
+  {
+    if(!(waiter.b_queued ? fairWait(iop_ringBuffer, &waiter, ip_deadline) : checkContinueBlocking(iop_ringBuffer, ip_deadline)))
     {
-      if(!checkContinueBlocking(iop_ringBuffer, p_timeToWait))
+      leaveLine(iop_ringBuffer, &waiter, 0);
+
+      /* blocking ended, read what is left. */
+      if(!iop_ringBuffer->b_blocking)
       {
-        /* fix if read is larger then write and block is turned off */
-        if(!iop_ringBuffer->b_blocking) return ringBufferRead(iop_ringBuffer,op_buffer, len / iop_ringBuffer->elementSize);
+        traceCall(iop_ringBuffer, RING_BUFFER_TRACE_READ_RANGE, RING_BUFFER_TRACE_ENDED, askLen, minElems / iop_ringBuffer->elementSize, 0, ip_deadline, &start);
 
-        /* fix for conditions when a read/write maybe called out of order and exit early with enough data availible */
-        if(readLen <= readSize(iop_ringBuffer)) break;
+        pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
 
-        return totalRead / iop_ringBuffer->elementSize;
+        return ringBufferRead(iop_ringBuffer, op_buffer, maxElems / iop_ringBuffer->elementSize);
       }
-    }
-    
-    read = rawRead(iop_ringBuffer, op_buffer + totalRead, readLen);
-    totalRead += read;
-    len -= read;
-    
-    pthread_cond_signal(&iop_ringBuffer->condition);
+
+      if(minElems <= readSize(iop_ringBuffer)) break;
+
+      traceCall(iop_ringBuffer, RING_BUFFER_TRACE_READ_RANGE, RING_BUFFER_TRACE_TIMEOUT, askLen, minElems / iop_ringBuffer->elementSize, 0, ip_deadline, &start);
+
+      pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+      return 0;
+    }
   }
-  while(len > 0);
 
+  if(maxElems > readSize(iop_ringBuffer))
+  {
+    maxElems = readSize(iop_ringBuffer) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  totalRead = (maxElems > 0 ? rawRead(iop_ringBuffer, op_buffer, maxElems) : 0);
+
+  traceCall(iop_ringBuffer, RING_BUFFER_TRACE_READ_RANGE, RING_BUFFER_TRACE_DONE, askLen, minElems / iop_ringBuffer->elementSize, totalRead / iop_ringBuffer->elementSize, ip_deadline, &start);
+
+  notifyChange(iop_ringBuffer);
+  leaveLine(iop_ringBuffer, &waiter, 0);
   pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
-  
+
   return totalRead / iop_ringBuffer->elementSize;
 }
 
@@ -385,6 +815,8 @@ unsigned long int ringBufferBlockingRead(struct s_ringBuffer * const iop_ringBuf
 unsigned long int ringBufferWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len)
 {
   unsigned long int totalWrote = 0;
+
+  struct timespec start;
   
   if(!iop_ringBuffer) return 0;
 
@@ -396,13 +828,34 @@ unsigned long int ringBufferWrite(struct s_ringBuffer * const iop_ringBuffer, vo
 
   if(len <= 0) return totalWrote;
 
+  if(iop_ringBuffer->overflowPolicy == RING_BUFFER_BLOCK && iop_ringBuffer->b_blocking) return ringBufferBlockingWrite(iop_ringBuffer, ip_buffer, len, NULL);
+
+  traceClock(iop_ringBuffer, &start);
+
+  if(iop_ringBuffer->b_combining)
+  {
+    totalWrote = combinedWrite(iop_ringBuffer, ip_buffer, len * iop_ringBuffer->elementSize) / iop_ringBuffer->elementSize;
+
+    /* the combiner wrote it for us, the record needs the lock back. */
+    if(iop_ringBuffer->p_traceFile)
+    {
+      pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+      traceCall(iop_ringBuffer, RING_BUFFER_TRACE_WRITE, (totalWrote < len ? RING_BUFFER_TRACE_SHORT : RING_BUFFER_TRACE_DONE), len, len, totalWrote, NULL, &start);
+      pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+    }
+
+    return totalWrote;
+  }
+
   pthread_mutex_lock(&iop_ringBuffer->rwMutex);
 
   len *= iop_ringBuffer->elementSize;
   
-  totalWrote = rawWrite(iop_ringBuffer, ip_buffer, len);
+  totalWrote = policyWrite(iop_ringBuffer, ip_buffer, len);
 
-  pthread_cond_signal(&iop_ringBuffer->condition);
+  traceCall(iop_ringBuffer, RING_BUFFER_TRACE_WRITE, (totalWrote < len ? RING_BUFFER_TRACE_SHORT : RING_BUFFER_TRACE_DONE), len / iop_ringBuffer->elementSize, len / iop_ringBuffer->elementSize, totalWrote / iop_ringBuffer->elementSize, NULL, &start);
+
+  notifyChange(iop_ringBuffer);
   pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
 
   return totalWrote / iop_ringBuffer->elementSize;
@@ -412,6 +865,8 @@ unsigned long int ringBufferWrite(struct s_ringBuffer * const iop_ringBuffer, vo
 unsigned long int ringBufferRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len)
 {
   unsigned long int totalRead = 0;
+
+  struct timespec start;
   
   if(!iop_ringBuffer) return 0;
 
@@ -423,260 +878,3157 @@ unsigned long int ringBufferRead(struct s_ringBuffer * const iop_ringBuffer, voi
 
   if(len <= 0) return totalRead;
 
+  traceClock(iop_ringBuffer, &start);
+
   pthread_mutex_lock(&iop_ringBuffer->rwMutex);
   
   len *= iop_ringBuffer->elementSize;
 
-  if(len > readSize(iop_ringBuffer))
-  {
-    len = readSize(iop_ringBuffer);
-  }
-  
-  totalRead = rawRead(iop_ringBuffer, op_buffer, len);
+  totalRead = rawRead(iop_ringBuffer, op_buffer, (len > readSize(iop_ringBuffer) ? readSize(iop_ringBuffer) : len));
+
+  traceCall(iop_ringBuffer, RING_BUFFER_TRACE_READ, (totalRead < len ? RING_BUFFER_TRACE_SHORT : RING_BUFFER_TRACE_DONE), len / iop_ringBuffer->elementSize, len / iop_ringBuffer->elementSize, totalRead / iop_ringBuffer->elementSize, NULL, &start);
   
-  pthread_cond_signal(&iop_ringBuffer->condition);
+  notifyChange(iop_ringBuffer);
   pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
 
   return totalRead / iop_ringBuffer->elementSize;
 }
 
-/*  clear out data, and restart blocking on the ringbuffer */
-void ringBufferReset(struct s_ringBuffer * const iop_ringBuffer)
+/*  pick what ringBufferWrite does with data that doesn't fit */
+unsigned long int ringBufferSetOverflowPolicy(struct s_ringBuffer * const iop_ringBuffer, unsigned long int policy)
 {
-  if(!iop_ringBuffer) return;
+  if(!iop_ringBuffer) return ERROR_NULL;
+
+  if(policy > RING_BUFFER_BLOCK)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Unknown overflow policy %lu.\n", policy);
+    return ERROR_NULL;
+  }
 
   pthread_mutex_lock(&iop_ringBuffer->rwMutex);
 
-  iop_ringBuffer->headIndex = iop_ringBuffer->tailIndex = 0;
-  
-  iop_ringBuffer->b_blocking = 1;
-  
-  pthread_cond_signal(&iop_ringBuffer->condition);
+  iop_ringBuffer->overflowPolicy = policy;
+
   pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
 }
 
-/*  disable ring buffer blocking */
-void ringBufferEndBlocking(struct s_ringBuffer * const iop_ringBuffer)
+/*  How many elements have been dropped? */
+unsigned long int getRingBufferDropped(struct s_ringBuffer * const ip_ringBuffer)
 {
-  if(!iop_ringBuffer) return;
-  
+  unsigned long int tempSize = 0;
+
+  if(!ip_ringBuffer) return ERROR_NULL;
+
+  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
+
+  tempSize = ip_ringBuffer->dropped;
+
+  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
+
+  return tempSize;
+}
+
+/*  How many unread elements were overwritten since we last asked? */
+unsigned long int ringBufferLapped(struct s_ringBuffer * const iop_ringBuffer)
+{
+  unsigned long int tempSize = 0;
+
+  if(!iop_ringBuffer) return ERROR_NULL;
+
   pthread_mutex_lock(&iop_ringBuffer->rwMutex);
 
-  iop_ringBuffer->b_blocking = 0;
+  tempSize = iop_ringBuffer->lapped;
+
+  iop_ringBuffer->lapped = 0;
 
-  pthread_cond_signal(&iop_ringBuffer->condition);
   pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return tempSize;
 }
 
-/*  help function implimentation */
-/*  return the write size of the buffer, no thread protection. */
-unsigned long int writeSize(struct s_ringBuffer const * const ip_ringBuffer)
+/*  turn CRC32C checking of the data on or off */
+int ringBufferSetIntegrity(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_enable)
 {
-  unsigned long int writeSize = 0;
-  
-  /* using binary methods to roll the number back around if it is negative. */
-  /** 
-   * rememeber, this is using some binary tricks to do the math. If we have a negative,
-   * end up subtracting a value equal to the size of the buffer as an offset.
-   * Everything is powers of 2. So a buffer capable of 32 bytes would have a 2^6 size counter.
-   * The mask would be 011111, 2^4 downto 2^0 is the actual range of the counter. If it goes over
-   * to 2^5 (32) we mask it off, offsetting the value by 32.
-   * (TAIL - HEAD) & MASK
-   * 20 - 30 = -10 aka 110110
-   * 011111 & 110110 = 010110
-   * 010110 aka 22. Which is the real difference since this is a ring buffer.
-   */
-  writeSize = (ip_ringBuffer->tailIndex - ip_ringBuffer->headIndex) & ip_ringBuffer->indexMask;
-  writeSize = (writeSize != 0 ? writeSize : ip_ringBuffer->buffSize);
+  if(!iop_ringBuffer) return PROC_FAIL;
 
-  return (writeSize - 1);
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  iop_ringBuffer->b_integrity = (b_enable != 0);
+
+  resetCrcRecords(iop_ringBuffer);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
 }
 
-/*  return the read size of the buffer, no thread protection. */
-unsigned long int readSize(struct s_ringBuffer const * const ip_ringBuffer)
+/*  pick the copy kernels */
+int ringBufferSetCopyMode(struct s_ringBuffer * const iop_ringBuffer, unsigned long int mode, unsigned long int threshold)
 {
-  /* we are using binary methods to roll the number back around if it is negative. see write for how this actually works*/
-  return (ip_ringBuffer->headIndex - ip_ringBuffer->tailIndex) & ip_ringBuffer->indexMask;
-}
+  if(!iop_ringBuffer) return PROC_FAIL;
+
+  if(mode > RING_BUFFER_COPY_PREFETCH)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Unknown copy mode %lu.\n", mode);
+    return PROC_FAIL;
+  }
 
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
 
-/*  Write data to the buffer. */
-unsigned long int rawWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len)
+  iop_ringBuffer->copyMode = mode;
+  iop_ringBuffer->copyThreshold = (threshold ? threshold : RING_BUFFER_COPY_THRESHOLD);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
+}
+
+/*  set write combining on or off. */
+int ringBufferSetWriteCombining(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_enable)
 {
-  unsigned long int totalWrote = 0;
-  unsigned long int availLen = 0;
-  unsigned long int writeLen = 0;
-  
-  if(!iop_ringBuffer) return 0;
+  if(!iop_ringBuffer) return PROC_FAIL;
 
-  do
-  {
-    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->headIndex;
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
 
-    writeLen = (len < availLen ? len : availLen);
+  /* writes already published still get combined, their writers wait for them. */
+  iop_ringBuffer->b_combining = (b_enable != 0);
 
-    memcpy(((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->headIndex, ((char *)ip_buffer) + totalWrote, writeLen);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
 
-    len -= writeLen;
-    totalWrote += writeLen;
-    /* if we go over the max buffer size, we loop around */
-    iop_ringBuffer->headIndex = (iop_ringBuffer->headIndex + writeLen) & iop_ringBuffer->indexMask;
-  }
-  while(len > 0);
+  return PROC_SUCC;
+}
 
-  return totalWrote;
+/*  set fairness on or off. */
+int ringBufferSetFairness(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_enable)
+{
+  if(!iop_ringBuffer) return PROC_FAIL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  /* waiters already in line keep their place, new ones stop getting in line. */
+  iop_ringBuffer->b_fair = (b_enable != 0);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
 }
 
-/* Read data from the buffer. */
-unsigned long int rawRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len)
+/*  longest wait in line since we last asked. */
+unsigned long int ringBufferMaxWait(struct s_ringBuffer * const iop_ringBuffer)
 {
-  unsigned long int totalRead = 0;
-  unsigned long int availLen = 0;
-  unsigned long int readLen = 0;
-  
-  if(!iop_ringBuffer) return 0;
+  unsigned long int tempSize = 0;
 
-  do
-  {
-    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->tailIndex;
+  if(!iop_ringBuffer) return ERROR_NULL;
 
-    readLen = (len < availLen ? len : availLen);
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
 
-    memcpy(((char *)op_buffer) + totalRead, ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex, readLen);
+  tempSize = iop_ringBuffer->maxWait;
 
-    len -= readLen;
-    totalRead += readLen;
-    /* if we go over the maxBuffer size. We loop around. */
-    iop_ringBuffer->tailIndex = (iop_ringBuffer->tailIndex + readLen) & iop_ringBuffer->indexMask;
-  }
-  while(len > 0);
+  iop_ringBuffer->maxWait = 0;
 
-  return totalRead;
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return tempSize;
 }
 
-/*  allocate the buffer, will also preform reallocations if it is already allocated. */
-unsigned long int allocateBuffer(struct s_ringBuffer * const iop_ringBuffer, unsigned long int buffSize, unsigned long int elementSize)
+/*  start writing trace records to a file. */
+int ringBufferTraceStart(struct s_ringBuffer * const iop_ringBuffer, char const * const ip_fileName)
 {
-  unsigned long int maxBuffSize = 0;
-  unsigned long int back_buffersize = 0;
-  unsigned long int back_elementSize = 0;
-  
-  struct s_ringBuffer backupBuffer;
-  void *p_temp = NULL;
-  
-  /* The buffer can't be any larger then 0111111... since 1000... is are mask to loop the buffer around. */
-  maxBuffSize = (unsigned long int)~0 >> 1;
-  
-  if(!iop_ringBuffer)
-  {
-    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer pointer NULL.\n");
-    return PROC_FAIL;
-  }
-  
-  if(elementSize <= 0)
-  {
-    fprintf(stderr, "ANSI-C RING BUFFER: Element size less then or equal to 0.\n");
-    return PROC_FAIL;
-  }
+  FILE *p_file = NULL;
 
-  if(buffSize <= 0)
+  struct s_ringBufferTraceHeader header;
+
+  if(!iop_ringBuffer) return PROC_FAIL;
+
+  if(!ip_fileName)
   {
-    fprintf(stderr, ("ANSI-C RING BUFFER: Size must be greater then 0.\n"));
+    fprintf(stderr, "ANSI-C RING BUFFER: Trace file name is NULL.\n");
     return PROC_FAIL;
   }
-  
-  if((buffSize * elementSize) > maxBuffSize)
+
+  p_file = fopen(ip_fileName, "wb");
+
+  if(!p_file)
   {
-    fprintf(stderr, "ANSI-C RING BUFFER: Size is too large, must be equal to or less then %lu.\n", maxBuffSize);
+    perror("ANSI-C RING BUFFER: Could not open trace file.");
     return PROC_FAIL;
   }
-  
-  /* keep a copy of the buffer incase realloc fails */
-  memcpy(&backupBuffer, iop_ringBuffer, sizeof(backupBuffer));
-  
-  back_buffersize = iop_ringBuffer->buffSize;
-  back_elementSize = elementSize;
-  
-  iop_ringBuffer->buffSize = 1;
-  
-  /* find the greatest binary bit */
-  while((iop_ringBuffer->buffSize <<= 1) < (buffSize * elementSize));
-  
-  /* create a index mask to get rid of all bits over buffsize. */
-  /* we subtract one to create a mask of 01111 from the size of 1000, we include 0 remember! */
-  iop_ringBuffer->indexMask = iop_ringBuffer->buffSize - 1;
-  iop_ringBuffer->elementSize = elementSize;
-  iop_ringBuffer->b_blocking = 1;
 
-  /* realloc will allocate NULL buffers */
-  p_temp = realloc(iop_ringBuffer->p_buffer, iop_ringBuffer->buffSize);
-  
-  if(!p_temp)
+  memset(&header, 0, sizeof(header));
+
+  strcpy(header.magic, RING_BUFFER_TRACE_MAGIC);
+
+  header.version = RING_BUFFER_TRACE_VERSION;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  closeTrace(iop_ringBuffer);
+
+  header.bufferSize = getRingBufferByteSize(iop_ringBuffer) / iop_ringBuffer->elementSize;
+  header.elementSize = iop_ringBuffer->elementSize;
+  header.overflowPolicy = iop_ringBuffer->overflowPolicy;
+
+  if(fwrite(&header, sizeof(header), 1, p_file) != 1)
   {
-    perror("ANSI-C RING BUFFER: Could not allocate buffer.");
-    /* copy original sizes back to the ring buffer object */
-    memcpy(iop_ringBuffer, &backupBuffer, sizeof(*iop_ringBuffer));
-    
-    /* restore buffer size */
-    iop_ringBuffer->buffSize = back_buffersize;
-    iop_ringBuffer->indexMask = iop_ringBuffer->buffSize - 1;
-    iop_ringBuffer->elementSize = back_elementSize;
-    iop_ringBuffer->b_blocking = 1;
-    
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+    perror("ANSI-C RING BUFFER: Could not write trace file.");
+    fclose(p_file);
     return PROC_FAIL;
   }
-  
-  iop_ringBuffer->p_buffer = p_temp;
+
+  clock_gettime(CLOCK_MONOTONIC, &iop_ringBuffer->traceStart);
+
+  iop_ringBuffer->traceRecords = 0;
+  iop_ringBuffer->p_traceFile = p_file;
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
 
   return PROC_SUCC;
 }
 
-/* deal with the blocking check in the function. The method is the same for read and write. */
-unsigned long int checkContinueBlocking(struct s_ringBuffer * const iop_ringBuffer, struct timespec *p_timeToWait)
+/*  stop tracing, flushing the file. */
+unsigned long int ringBufferTraceStop(struct s_ringBuffer * const iop_ringBuffer)
 {
-  if(!iop_ringBuffer) return STOP_BLOCKING;
-  
-  /* if we pass it a time to wait, do a timed wait. Otherwise we just wait. */
-  if(p_timeToWait)
-  {
-    struct timeval timeNow;
-    
-    /* current time of day. */
-    if(gettimeofday(&timeNow, NULL))
-    { 
-      pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
-      return STOP_BLOCKING;
-    }
-    
-    /* add our offset time to wait, convert micro to milli */
-    p_timeToWait->tv_sec += timeNow.tv_sec;
-    p_timeToWait->tv_nsec += timeNow.tv_usec * 1000UL;
+  unsigned long int tempSize = 0;
 
-    /* wait for timed wait, if we time out, we return. */
-    if(pthread_cond_timedwait(&iop_ringBuffer->condition, &iop_ringBuffer->rwMutex, p_timeToWait))
-    {
-      pthread_cond_signal(&iop_ringBuffer->condition);
-      return STOP_BLOCKING;
-    }
-  }
-  else
-  {
-    /* if we don't have a wait time, and not enough space to read data we 
-     * are going to wait. This method will release the mutex, and wait for
-     * the condition to be signaled. If this is successful, a 0 value is returned.
-     * if it fails, we signal such and return what we did read.
-     */
-    if(pthread_cond_wait(&iop_ringBuffer->condition, &iop_ringBuffer->rwMutex))
-    {
-      pthread_cond_signal(&iop_ringBuffer->condition);
-      return STOP_BLOCKING;
-    }
-  }
+  if(!iop_ringBuffer) return ERROR_NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  tempSize = closeTrace(iop_ringBuffer);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return tempSize;
+}
+
+/*  How many reads failed the CRC check? */
+unsigned long int getRingBufferCrcErrors(struct s_ringBuffer * const ip_ringBuffer)
+{
+  unsigned long int tempSize = 0;
+
+  if(!ip_ringBuffer) return ERROR_NULL;
+
+  pthread_mutex_lock(&ip_ringBuffer->rwMutex);
+
+  tempSize = ip_ringBuffer->crcErrors;
+
+  pthread_mutex_unlock(&ip_ringBuffer->rwMutex);
+
+  return tempSize;
+}
+
+/*  non-blocking read, with the CRC32C of what was read */
+unsigned long int ringBufferReadCrc(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, unsigned long int *op_crc)
+{
+  unsigned long int totalRead = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  if(len <= 0) return totalRead;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  len *= iop_ringBuffer->elementSize;
+
+  if(len > readSize(iop_ringBuffer))
+  {
+    len = readSize(iop_ringBuffer);
+  }
+
+  totalRead = rawReadCrc(iop_ringBuffer, op_buffer, len, op_crc);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalRead / iop_ringBuffer->elementSize;
+}
+
+/*  drain in place, non-blocking */
+unsigned long int ringBufferDrain(struct s_ringBuffer * const iop_ringBuffer, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context)
+{
+  unsigned long int totalDrained = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  if(!p_drainFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Drain function is NULL.\n");
+    return 0;
+  }
+
+  if(maxElems <= 0) return totalDrained;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  maxElems *= iop_ringBuffer->elementSize;
+
+  if(maxElems > readSize(iop_ringBuffer))
+  {
+    maxElems = readSize(iop_ringBuffer);
+  }
+
+  totalDrained = rawDrain(iop_ringBuffer, maxElems, p_drainFunc, p_context);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalDrained / iop_ringBuffer->elementSize;
+}
+
+/*  drain in place, wait for the minimum first. */
+unsigned long int ringBufferBlockingDrain(struct s_ringBuffer * const iop_ringBuffer, unsigned long int minElems, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingDrainUntil(iop_ringBuffer, minElems, maxElems, p_drainFunc, p_context, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingDrainUntil(iop_ringBuffer, minElems, maxElems, p_drainFunc, p_context, &deadline);
+}
+
+/*  same as ringBufferBlockingDrain, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingDrainUntil(struct s_ringBuffer * const iop_ringBuffer, unsigned long int minElems, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec const *ip_deadline)
+{
+  unsigned long int totalDrained = 0;
+
+  struct s_ringBufferWaiter waiter;
+
+  if(!iop_ringBuffer) return 0;
+
+  if(!p_drainFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Drain function is NULL.\n");
+    return 0;
+  }
+
+  if(maxElems <= 0) return totalDrained;
+
+  if(!iop_ringBuffer->b_blocking) return ringBufferDrain(iop_ringBuffer, maxElems, p_drainFunc, p_context);
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  minElems = (minElems < maxElems ? minElems : maxElems) * iop_ringBuffer->elementSize;
+  maxElems *= iop_ringBuffer->elementSize;
+
+  /* can never have more then the buffer holds. */
+  if(minElems > writeSize(iop_ringBuffer) + readSize(iop_ringBuffer))
+  {
+    minElems = (writeSize(iop_ringBuffer) + readSize(iop_ringBuffer)) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  /* only gets in line if it has to wait in fairness mode. */
+  waiter.b_queued = 0;
+
+  while(!takeTurn(iop_ringBuffer, &waiter, minElems, 0))
+  {
+    if(!(waiter.b_queued ? fairWait(iop_ringBuffer, &waiter, ip_deadline) : checkContinueBlocking(iop_ringBuffer, ip_deadline)))
+    {
+      leaveLine(iop_ringBuffer, &waiter, 0);
+
+      /* blocking ended, drain what is left. */
+      if(!iop_ringBuffer->b_blocking)
+      {
+        pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+        return ringBufferDrain(iop_ringBuffer, maxElems / iop_ringBuffer->elementSize, p_drainFunc, p_context);
+      }
+
+      if(minElems <= readSize(iop_ringBuffer)) break;
+
+      pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+      return 0;
+    }
+  }
+
+  if(maxElems > readSize(iop_ringBuffer))
+  {
+    maxElems = readSize(iop_ringBuffer);
+  }
+
+  totalDrained = rawDrain(iop_ringBuffer, maxElems, p_drainFunc, p_context);
+
+  notifyChange(iop_ringBuffer);
+  leaveLine(iop_ringBuffer, &waiter, 0);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalDrained / iop_ringBuffer->elementSize;
+}
+
+/*  non-blocking write, converting on the way in. Only writes what fits. */
+unsigned long int ringBufferWriteConvert(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert)
+{
+  unsigned long int totalWrote = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  if(!ip_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Input buffer is NULL.\n");
+    return 0;
+  }
+
+  if(!checkConvert(iop_ringBuffer, ip_convert)) return 0;
+
+  if(len <= 0) return totalWrote;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  len *= iop_ringBuffer->elementSize;
+
+  /* a buffer on a budget grows before the write is cut short. */
+  budgetGrow(iop_ringBuffer, len);
+
+  if(len > writeSize(iop_ringBuffer))
+  {
+    len = writeSize(iop_ringBuffer) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  totalWrote = (len > 0 ? rawWriteConvert(iop_ringBuffer, ip_buffer, len, ip_convert) : 0);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalWrote / iop_ringBuffer->elementSize;
+}
+
+/*  non-blocking read, converting on the way out. */
+unsigned long int ringBufferReadConvert(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert)
+{
+  unsigned long int totalRead = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  if(!checkConvert(iop_ringBuffer, ip_convert)) return 0;
+
+  if(len <= 0) return totalRead;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  len *= iop_ringBuffer->elementSize;
+
+  if(len > readSize(iop_ringBuffer))
+  {
+    len = readSize(iop_ringBuffer) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  totalRead = (len > 0 ? rawReadConvert(iop_ringBuffer, op_buffer, len, ip_convert) : 0);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalRead / iop_ringBuffer->elementSize;
+}
+
+/*  blocking write, converting on the way in. */
+unsigned long int ringBufferBlockingWriteConvert(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingWriteConvertUntil(iop_ringBuffer, ip_buffer, len, ip_convert, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingWriteConvertUntil(iop_ringBuffer, ip_buffer, len, ip_convert, &deadline);
+}
+
+/*  same as ringBufferBlockingWriteConvert, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingWriteConvertUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline)
+{
+  if(!iop_ringBuffer) return 0;
+
+  if(!checkConvert(iop_ringBuffer, ip_convert)) return 0;
+
+  return blockingWriteUntil(iop_ringBuffer, ip_buffer, len, ip_convert, ip_deadline);
+}
+
+/*  blocking read, converting on the way out. */
+unsigned long int ringBufferBlockingReadConvert(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingReadConvertUntil(iop_ringBuffer, op_buffer, len, ip_convert, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingReadConvertUntil(iop_ringBuffer, op_buffer, len, ip_convert, &deadline);
+}
+
+/*  same as ringBufferBlockingReadConvert, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingReadConvertUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline)
+{
+  if(!iop_ringBuffer) return 0;
+
+  if(!checkConvert(iop_ringBuffer, ip_convert)) return 0;
+
+  return blockingReadUntil(iop_ringBuffer, op_buffer, len, ip_convert, ip_deadline);
+}
+
+/*  non-blocking read, one array per channel. */
+unsigned long int ringBufferReadDeinterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *op_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len)
+{
+  unsigned long int totalRead = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  if(!checkFrames(iop_ringBuffer, op_channels, numChannels, sampleSize)) return 0;
+
+  if(len <= 0) return totalRead;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  len *= iop_ringBuffer->elementSize;
+
+  if(len > readSize(iop_ringBuffer))
+  {
+    len = readSize(iop_ringBuffer) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  totalRead = (len > 0 ? rawReadDeinterleave(iop_ringBuffer, op_channels, numChannels, sampleSize, len) : 0);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalRead / iop_ringBuffer->elementSize;
+}
+
+/*  non-blocking write, one array per channel. Only writes what fits. */
+unsigned long int ringBufferWriteInterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *ip_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len)
+{
+  unsigned long int totalWrote = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  if(!checkFrames(iop_ringBuffer, ip_channels, numChannels, sampleSize)) return 0;
+
+  if(len <= 0) return totalWrote;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  len *= iop_ringBuffer->elementSize;
+
+  /* a buffer on a budget grows before the write is cut short. */
+  budgetGrow(iop_ringBuffer, len);
+
+  if(len > writeSize(iop_ringBuffer))
+  {
+    len = writeSize(iop_ringBuffer) / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+  }
+
+  totalWrote = (len > 0 ? rawWriteInterleave(iop_ringBuffer, ip_channels, numChannels, sampleSize, len) : 0);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalWrote / iop_ringBuffer->elementSize;
+}
+
+/*  copy out a window, only consume the hop */
+unsigned long int ringBufferReadWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems)
+{
+  if(!iop_ringBuffer) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  return lockedWindow(iop_ringBuffer, op_buffer, windowElems, hopElems, NULL, NULL);
+}
+
+/*  wait for a full window, then copy it out. */
+unsigned long int ringBufferBlockingReadWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingReadWindowUntil(iop_ringBuffer, op_buffer, windowElems, hopElems, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingReadWindowUntil(iop_ringBuffer, op_buffer, windowElems, hopElems, &deadline);
+}
+
+/*  same as ringBufferBlockingReadWindow, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingReadWindowUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, struct timespec const *ip_deadline)
+{
+  if(!iop_ringBuffer) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  return windowUntil(iop_ringBuffer, op_buffer, windowElems, hopElems, NULL, NULL, ip_deadline);
+}
+
+/*  window in place, non-blocking */
+unsigned long int ringBufferDrainWindow(struct s_ringBuffer * const iop_ringBuffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context)
+{
+  if(!iop_ringBuffer) return 0;
+
+  if(!p_windowFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Window function is NULL.\n");
+    return 0;
+  }
+
+  return lockedWindow(iop_ringBuffer, NULL, windowElems, hopElems, p_windowFunc, p_context);
+}
+
+/*  window in place, wait for a full window first. */
+unsigned long int ringBufferBlockingDrainWindow(struct s_ringBuffer * const iop_ringBuffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferBlockingDrainWindowUntil(iop_ringBuffer, windowElems, hopElems, p_windowFunc, p_context, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferBlockingDrainWindowUntil(iop_ringBuffer, windowElems, hopElems, p_windowFunc, p_context, &deadline);
+}
+
+/*  same as ringBufferBlockingDrainWindow, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferBlockingDrainWindowUntil(struct s_ringBuffer * const iop_ringBuffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context, struct timespec const *ip_deadline)
+{
+  if(!iop_ringBuffer) return 0;
+
+  if(!p_windowFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Window function is NULL.\n");
+    return 0;
+  }
+
+  return windowUntil(iop_ringBuffer, NULL, windowElems, hopElems, p_windowFunc, p_context, ip_deadline);
+}
+
+/*  segment to fill at the head, wait for at least one block. */
+unsigned long int ringBufferAcquireWrite(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferAcquireWriteUntil(iop_ringBuffer, op_segment, blockSize, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferAcquireWriteUntil(iop_ringBuffer, op_segment, blockSize, &deadline);
+}
+
+/*  same as ringBufferAcquireWrite, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferAcquireWriteUntil(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec const *ip_deadline)
+{
+  if(!iop_ringBuffer) return 0;
+
+  return acquireUntil(iop_ringBuffer, op_segment, blockSize, 1, ip_deadline);
+}
+
+/*  the caller filled len bytes of the segment, hand them to the readers. */
+unsigned long int ringBufferCommitWrite(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len)
+{
+  unsigned long int crc = 0;
+
+  if(!iop_ringBuffer) return ERROR_NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  if((len % iop_ringBuffer->elementSize) || (len > segmentSize(iop_ringBuffer, 1)))
+  {
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Commit must be whole elements inside the segment.\n");
+    return PROC_FAIL;
+  }
+
+  iop_ringBuffer->segmentsHeld &= ~1UL;
+
+  if(len <= 0)
+  {
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+    return PROC_SUCC;
+  }
+
+  if(iop_ringBuffer->b_integrity)
+  {
+    crc = ringBufferCrc32c(crc, ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->headIndex, len);
+
+    if(!appendCrcRecord(iop_ringBuffer, len, crc, 1))
+    {
+      fprintf(stderr, "ANSI-C RING BUFFER: Could not record CRC, integrity checking disabled.\n");
+
+      iop_ringBuffer->b_integrity = 0;
+
+      resetCrcRecords(iop_ringBuffer);
+    }
+  }
+
+  ATOMIC_STORE(iop_ringBuffer->headIndex, (iop_ringBuffer->headIndex + len) & iop_ringBuffer->indexMask);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
+}
+
+/*  segment to use at the tail, wait for at least one block or the end of the stream. */
+unsigned long int ringBufferAcquireRead(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferAcquireReadUntil(iop_ringBuffer, op_segment, blockSize, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferAcquireReadUntil(iop_ringBuffer, op_segment, blockSize, &deadline);
+}
+
+/*  same as ringBufferAcquireRead, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferAcquireReadUntil(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, struct timespec const *ip_deadline)
+{
+  if(!iop_ringBuffer) return 0;
+
+  return acquireUntil(iop_ringBuffer, op_segment, blockSize, 0, ip_deadline);
+}
+
+/*  the caller is done with len bytes of the segment, give the space back to the writers. */
+unsigned long int ringBufferCommitRead(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len)
+{
+  if(!iop_ringBuffer) return ERROR_NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  if((len % iop_ringBuffer->elementSize) || (len > segmentSize(iop_ringBuffer, 0)))
+  {
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Commit must be whole elements inside the segment.\n");
+    return PROC_FAIL;
+  }
+
+  iop_ringBuffer->segmentsHeld &= ~2UL;
+
+  if(len <= 0)
+  {
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+    return PROC_SUCC;
+  }
+
+  /* no copy, moves the tail and checks the records in integrity mode. */
+  rawRead(iop_ringBuffer, NULL, len);
+
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
+}
+
+/*  async read, complete now if we can, otherwise queue it for the writers to finish. */
+unsigned long int ringBufferAsyncRead(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferAsyncOp * const iop_op)
+{
+  if(!iop_ringBuffer) return RING_BUFFER_ASYNC_ERROR;
+
+  if(!iop_op || !iop_op->p_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return RING_BUFFER_ASYNC_ERROR;
+  }
+
+  iop_op->count = 0;
+  iop_op->status = RING_BUFFER_ASYNC_PENDING;
+  iop_op->p_next = NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  /* queue it, servicing will complete it right away if it is the only one and the data is there. */
+  if(iop_ringBuffer->p_asyncReadTail)
+  {
+    iop_ringBuffer->p_asyncReadTail->p_next = iop_op;
+  }
+  else
+  {
+    iop_ringBuffer->p_asyncReadHead = iop_op;
+  }
+
+  iop_ringBuffer->p_asyncReadTail = iop_op;
+
+  /* mark it so a completion in line doesn't call back the caller, who is still here. */
+  iop_op->status = ASYNC_IN_CALL;
+
+  notifyChange(iop_ringBuffer);
+
+  if(iop_op->status == ASYNC_IN_CALL) iop_op->status = RING_BUFFER_ASYNC_PENDING;
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return iop_op->status;
+}
+
+/*  async write, complete now if we can, otherwise queue it for the readers to finish. */
+unsigned long int ringBufferAsyncWrite(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferAsyncOp * const iop_op)
+{
+  if(!iop_ringBuffer) return RING_BUFFER_ASYNC_ERROR;
+
+  if(!iop_op || !iop_op->p_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Input buffer is NULL.\n");
+    return RING_BUFFER_ASYNC_ERROR;
+  }
+
+  iop_op->count = 0;
+  iop_op->status = RING_BUFFER_ASYNC_PENDING;
+  iop_op->p_next = NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  if(iop_ringBuffer->p_asyncWriteTail)
+  {
+    iop_ringBuffer->p_asyncWriteTail->p_next = iop_op;
+  }
+  else
+  {
+    iop_ringBuffer->p_asyncWriteHead = iop_op;
+  }
+
+  iop_ringBuffer->p_asyncWriteTail = iop_op;
+
+  iop_op->status = ASYNC_IN_CALL;
+
+  notifyChange(iop_ringBuffer);
+
+  if(iop_op->status == ASYNC_IN_CALL) iop_op->status = RING_BUFFER_ASYNC_PENDING;
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return iop_op->status;
+}
+
+/*  remove a pending async op, used for timeouts. */
+unsigned long int ringBufferAsyncCancel(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferAsyncOp * const iop_op, unsigned long int status)
+{
+  struct s_ringBufferAsyncOp **pp_head = NULL;
+  struct s_ringBufferAsyncOp **pp_tail = NULL;
+  struct s_ringBufferAsyncOp *p_prev = NULL;
+  struct s_ringBufferAsyncOp *p_op = NULL;
+
+  if(!iop_ringBuffer) return ERROR_NULL;
+
+  if(!iop_op) return ERROR_NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  /* find which queue it is in, if any. */
+  for(p_op = iop_ringBuffer->p_asyncReadHead; p_op && p_op != iop_op; p_op = p_op->p_next) p_prev = p_op;
+
+  if(p_op)
+  {
+    pp_head = &iop_ringBuffer->p_asyncReadHead;
+    pp_tail = &iop_ringBuffer->p_asyncReadTail;
+  }
+  else
+  {
+    p_prev = NULL;
+
+    for(p_op = iop_ringBuffer->p_asyncWriteHead; p_op && p_op != iop_op; p_op = p_op->p_next) p_prev = p_op;
+
+    pp_head = &iop_ringBuffer->p_asyncWriteHead;
+    pp_tail = &iop_ringBuffer->p_asyncWriteTail;
+  }
+
+  if(!p_op)
+  {
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+    return ERROR_NULL;
+  }
+
+  /* unlink it, then complete it as if it was the head of its own queue. */
+  if(p_prev)
+  {
+    p_prev->p_next = p_op->p_next;
+  }
+  else
+  {
+    *pp_head = p_op->p_next;
+  }
+
+  if(*pp_tail == p_op) *pp_tail = p_prev;
+
+  p_op->p_next = NULL;
+
+  pp_head = &p_op;
+  p_prev = p_op;
+
+  completeAsync(pp_head, &p_prev, status);
+
+  /* a cancelled head may have been holding others up. */
+  notifyChange(iop_ringBuffer);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
+}
+
+/*  create a wait set, nothing registered. */
+struct s_ringBufferWaitSet *initRingBufferWaitSet(void)
+{
+  struct s_ringBufferWaitSet *p_tempWaitSet = NULL;
+
+  p_tempWaitSet = malloc(sizeof(struct s_ringBufferWaitSet));
+
+  if(!p_tempWaitSet)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate wait set object.");
+    return NULL;
+  }
+
+  memset(p_tempWaitSet, 0, sizeof(*p_tempWaitSet));
+
+  if(pthread_mutex_init(&p_tempWaitSet->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Wait set mutex init failed.\n");
+    free(p_tempWaitSet);
+    return NULL;
+  }
+
+  if(!initMonotonicCondition(&p_tempWaitSet->condition))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Wait set condition init failed.\n");
+    pthread_mutex_destroy(&p_tempWaitSet->mutex);
+    free(p_tempWaitSet);
+    return NULL;
+  }
+
+  return p_tempWaitSet;
+}
+
+/*  remove everything and free the wait set. */
+void freeRingBufferWaitSet(struct s_ringBufferWaitSet **iopp_waitSet)
+{
+  if(!iopp_waitSet) return;
+
+  if(!*iopp_waitSet) return;
+
+  /* ring buffer lock comes first, so never hold ours while removing. */
+  while((*iopp_waitSet)->p_entries)
+  {
+    ringBufferWaitSetRemove(*iopp_waitSet, (*iopp_waitSet)->p_entries->p_ringBuffer);
+  }
+
+  pthread_cond_destroy(&(*iopp_waitSet)->condition);
+  pthread_mutex_destroy(&(*iopp_waitSet)->mutex);
+
+  free(*iopp_waitSet);
+
+  *iopp_waitSet = NULL;
+}
+
+/*  register a ring buffer, queue it right away if it is already ready. */
+unsigned long int ringBufferWaitSetAdd(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBuffer * const iop_ringBuffer, unsigned long int events, void *p_userData)
+{
+  struct s_ringBufferWaitEntry *p_entry = NULL;
+
+  if(!iop_ringBuffer) return ERROR_NULL;
+
+  if(!iop_waitSet)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Wait set is NULL.\n");
+    return ERROR_NULL;
+  }
+
+  p_entry = malloc(sizeof(struct s_ringBufferWaitEntry));
+
+  if(!p_entry)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate wait set entry.");
+    return ERROR_NULL;
+  }
+
+  memset(p_entry, 0, sizeof(*p_entry));
+
+  p_entry->p_ringBuffer = iop_ringBuffer;
+  p_entry->p_waitSet = iop_waitSet;
+  p_entry->events = events;
+  p_entry->p_userData = p_userData;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+  pthread_mutex_lock(&iop_waitSet->mutex);
+
+  p_entry->p_ringNext = iop_ringBuffer->p_waitEntries;
+  iop_ringBuffer->p_waitEntries = p_entry;
+
+  p_entry->p_setNext = iop_waitSet->p_entries;
+  iop_waitSet->p_entries = p_entry;
+
+  pthread_mutex_unlock(&iop_waitSet->mutex);
+
+  queueWaitEntry(p_entry);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return PROC_SUCC;
+}
+
+/*  unregister a ring buffer, pulling it off of the ready list if needed. */
+unsigned long int ringBufferWaitSetRemove(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBuffer * const iop_ringBuffer)
+{
+  struct s_ringBufferWaitEntry **pp_entry = NULL;
+  struct s_ringBufferWaitEntry *p_entry = NULL;
+  struct s_ringBufferWaitEntry *p_prev = NULL;
+
+  if(!iop_ringBuffer) return ERROR_NULL;
+
+  if(!iop_waitSet) return ERROR_NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+  pthread_mutex_lock(&iop_waitSet->mutex);
+
+  for(pp_entry = &iop_ringBuffer->p_waitEntries; *pp_entry && (*pp_entry)->p_waitSet != iop_waitSet; pp_entry = &(*pp_entry)->p_ringNext);
+
+  p_entry = *pp_entry;
+
+  if(!p_entry)
+  {
+    pthread_mutex_unlock(&iop_waitSet->mutex);
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+    return ERROR_NULL;
+  }
+
+  *pp_entry = p_entry->p_ringNext;
+
+  for(pp_entry = &iop_waitSet->p_entries; *pp_entry != p_entry; pp_entry = &(*pp_entry)->p_setNext);
+
+  *pp_entry = p_entry->p_setNext;
+
+  if(p_entry->b_queued)
+  {
+    for(pp_entry = &iop_waitSet->p_readyHead; *pp_entry != p_entry; pp_entry = &(*pp_entry)->p_readyNext) p_prev = *pp_entry;
+
+    *pp_entry = p_entry->p_readyNext;
+
+    if(iop_waitSet->p_readyTail == p_entry) iop_waitSet->p_readyTail = p_prev;
+  }
+
+  pthread_mutex_unlock(&iop_waitSet->mutex);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  free(p_entry);
+
+  return PROC_SUCC;
+}
+
+/*  wait for a ready ring buffer, relative timeout. */
+unsigned long int ringBufferWaitAny(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBufferReady *op_ready, unsigned long int maxReady, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferWaitAnyUntil(iop_waitSet, op_ready, maxReady, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferWaitAnyUntil(iop_waitSet, op_ready, maxReady, &deadline);
+}
+
+/*  wait for the ready list to have something on it, only ready entries are ever looked at. */
+unsigned long int ringBufferWaitAnyUntil(struct s_ringBufferWaitSet * const iop_waitSet, struct s_ringBufferReady *op_ready, unsigned long int maxReady, struct timespec const *ip_deadline)
+{
+  unsigned long int numReady = 0;
+  unsigned long int readyNow = 0;
+  unsigned long int b_timedOut = 0;
+
+  struct s_ringBufferWaitEntry *p_entry = NULL;
+  struct s_ringBufferWaitEntry *p_keepHead = NULL;
+  struct s_ringBufferWaitEntry *p_keepTail = NULL;
+
+  if(!iop_waitSet) return 0;
+
+  if(!op_ready)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  if(maxReady <= 0) return numReady;
+
+  pthread_mutex_lock(&iop_waitSet->mutex);
+
+  for(;;)
+  {
+    while(numReady < maxReady && (p_entry = iop_waitSet->p_readyHead) != NULL)
+    {
+      iop_waitSet->p_readyHead = p_entry->p_readyNext;
+
+      if(!iop_waitSet->p_readyHead) iop_waitSet->p_readyTail = NULL;
+
+      p_entry->p_readyNext = NULL;
+      p_entry->b_queued = 0;
+
+      /* state can only change after the ring buffer queues it again, a stale entry is dropped here. */
+      readyNow = readyEvents(p_entry->p_ringBuffer, p_entry->events);
+
+      if(!readyNow) continue;
+
+      op_ready[numReady].p_ringBuffer = p_entry->p_ringBuffer;
+      op_ready[numReady].events = readyNow;
+      op_ready[numReady].p_userData = p_entry->p_userData;
+      numReady++;
+
+      /* level triggered, keep it to be checked again next call. */
+      if(p_keepTail)
+      {
+        p_keepTail->p_readyNext = p_entry;
+      }
+      else
+      {
+        p_keepHead = p_entry;
+      }
+
+      p_keepTail = p_entry;
+    }
+
+    if(numReady > 0 || b_timedOut) break;
+
+    if(ip_deadline)
+    {
+      b_timedOut = (pthread_cond_timedwait(&iop_waitSet->condition, &iop_waitSet->mutex, ip_deadline) != 0);
+    }
+    else
+    {
+      pthread_cond_wait(&iop_waitSet->condition, &iop_waitSet->mutex);
+    }
+  }
+
+  /* kept entries go to the back, so every ready ring buffer gets its turn. */
+  for(p_entry = p_keepHead; p_entry; p_entry = p_entry->p_readyNext) p_entry->b_queued = 1;
+
+  if(p_keepHead)
+  {
+    if(iop_waitSet->p_readyTail)
+    {
+      iop_waitSet->p_readyTail->p_readyNext = p_keepHead;
+    }
+    else
+    {
+      iop_waitSet->p_readyHead = p_keepHead;
+    }
+
+    iop_waitSet->p_readyTail = p_keepTail;
+  }
+
+  /* entries are left for the next waiter, pass the wake up on. */
+  if(iop_waitSet->p_readyHead) pthread_cond_signal(&iop_waitSet->condition);
+
+  pthread_mutex_unlock(&iop_waitSet->mutex);
+
+  return numReady;
+}
+
+/*  now on CLOCK_MONOTONIC plus the time to wait, for the Until calls */
+int ringBufferDeadline(struct timespec *op_deadline, struct timespec const *ip_timeToWait)
+{
+  if(!op_deadline) return PROC_FAIL;
+
+  if(clock_gettime(CLOCK_MONOTONIC, op_deadline))
+  {
+    perror("ANSI-C RING BUFFER: Could not read the monotonic clock.");
+    return PROC_FAIL;
+  }
+
+  if(!ip_timeToWait) return PROC_SUCC;
+
+  op_deadline->tv_sec += ip_timeToWait->tv_sec + ip_timeToWait->tv_nsec / 1000000000L;
+  op_deadline->tv_nsec += ip_timeToWait->tv_nsec % 1000000000L;
+
+  if(op_deadline->tv_nsec >= 1000000000L)
+  {
+    op_deadline->tv_sec++;
+    op_deadline->tv_nsec -= 1000000000L;
+  }
+
+  return PROC_SUCC;
+}
+
+/*  clear out data, and restart blocking on the ringbuffer */
+void ringBufferReset(struct s_ringBuffer * const iop_ringBuffer)
+{
+  if(!iop_ringBuffer) return;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  ATOMIC_STORE(iop_ringBuffer->headIndex, 0);
+  ATOMIC_STORE(iop_ringBuffer->tailIndex, 0);
+  iop_ringBuffer->lapped = 0;
+
+  resetCrcRecords(iop_ringBuffer);
+  
+  ATOMIC_STORE(iop_ringBuffer->b_blocking, 1);
+  
+  notifyChange(iop_ringBuffer);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+}
+
+/*  disable ring buffer blocking */
+void ringBufferEndBlocking(struct s_ringBuffer * const iop_ringBuffer)
+{
+  struct s_ringBufferWaiter *p_waiter = NULL;
+
+  if(!iop_ringBuffer) return;
+  
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  ATOMIC_STORE(iop_ringBuffer->b_blocking, 0);
+
+  PROBE2(end_blocking, iop_ringBuffer, readSize(iop_ringBuffer));
+
+  notifyChange(iop_ringBuffer);
+  /* every waiter has to see it, not just one. */
+  pthread_cond_broadcast(&iop_ringBuffer->condition);
+
+  for(p_waiter = iop_ringBuffer->p_writeWaiters; p_waiter; p_waiter = p_waiter->p_next) pthread_cond_signal(&p_waiter->condition);
+
+  for(p_waiter = iop_ringBuffer->p_readWaiters; p_waiter; p_waiter = p_waiter->p_next) pthread_cond_signal(&p_waiter->condition);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+}
+
+/*  help function implimentation */
+/*  return the write size of the buffer, no thread protection. */
+unsigned long int writeSize(struct s_ringBuffer const * const ip_ringBuffer)
+{
+  unsigned long int writeSize = 0;
+  
+  /* using binary methods to roll the number back around if it is negative. */
+  /** 
+   * rememeber, this is using some binary tricks to do the math. If we have a negative,
+   * end up subtracting a value equal to the size of the buffer as an offset.
+   * Everything is powers of 2. So a buffer capable of 32 bytes would have a 2^6 size counter.
+   * The mask would be 011111, 2^4 downto 2^0 is the actual range of the counter. If it goes over
+   * to 2^5 (32) we mask it off, offsetting the value by 32.
+   * (TAIL - HEAD) & MASK
+   * 20 - 30 = -10 aka 110110
+   * 011111 & 110110 = 010110
+   * 010110 aka 22. Which is the real difference since this is a ring buffer.
+   */
+  writeSize = (ip_ringBuffer->tailIndex - ip_ringBuffer->headIndex) & ip_ringBuffer->indexMask;
+  writeSize = (writeSize != 0 ? writeSize : ip_ringBuffer->buffSize);
+
+  return (writeSize - 1);
+}
+
+/*  tail, head, then tail again. If the tail didn't move the head was loaded while the tail had that value. A geometry change in between, a budget buffer swap, loads it all again. */
+void loadIndexes(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int *op_headIndex, unsigned long int *op_tailIndex, unsigned long int *op_indexMask, unsigned long int *op_buffSize)
+{
+  unsigned long int geometry = 0;
+
+  for(;;)
+  {
+    geometry = ATOMIC_LOAD(ip_ringBuffer->geometry);
+
+    if(!(geometry & 1))
+    {
+      *op_tailIndex = ATOMIC_LOAD(ip_ringBuffer->tailIndex);
+      *op_headIndex = ATOMIC_LOAD(ip_ringBuffer->headIndex);
+      *op_indexMask = ATOMIC_LOAD(ip_ringBuffer->indexMask);
+      *op_buffSize = ATOMIC_LOAD(ip_ringBuffer->buffSize);
+
+      if((*op_tailIndex == ATOMIC_LOAD(ip_ringBuffer->tailIndex)) && (geometry == ATOMIC_LOAD(ip_ringBuffer->geometry))) return;
+    }
+
+    CPU_RELAX();
+  }
+}
+
+/*  same math as writeSize, on loaded indexes. */
+unsigned long int atomicWriteSize(struct s_ringBuffer const * const ip_ringBuffer)
+{
+  unsigned long int headIndex = 0;
+  unsigned long int tailIndex = 0;
+  unsigned long int indexMask = 0;
+  unsigned long int buffSize = 0;
+  unsigned long int writeSize = 0;
+
+  loadIndexes(ip_ringBuffer, &headIndex, &tailIndex, &indexMask, &buffSize);
+
+  writeSize = (tailIndex - headIndex) & indexMask;
+  writeSize = (writeSize != 0 ? writeSize : buffSize);
+
+  return (writeSize - 1);
+}
+
+/*  same math as readSize, on loaded indexes. */
+unsigned long int atomicReadSize(struct s_ringBuffer const * const ip_ringBuffer)
+{
+  unsigned long int headIndex = 0;
+  unsigned long int tailIndex = 0;
+  unsigned long int indexMask = 0;
+  unsigned long int buffSize = 0;
+
+  loadIndexes(ip_ringBuffer, &headIndex, &tailIndex, &indexMask, &buffSize);
+
+  return (headIndex - tailIndex) & indexMask;
+}
+
+/*  return the read size of the buffer, no thread protection. */
+unsigned long int readSize(struct s_ringBuffer const * const ip_ringBuffer)
+{
+  /* we are using binary methods to roll the number back around if it is negative. see write for how this actually works*/
+  return (ip_ringBuffer->headIndex - ip_ringBuffer->tailIndex) & ip_ringBuffer->indexMask;
+}
+
+
+/*  Write data to the buffer. */
+unsigned long int rawWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len)
+{
+  unsigned long int totalWrote = 0;
+  unsigned long int availLen = 0;
+  unsigned long int writeLen = 0;
+  unsigned long int crc = 0;
+  
+  if(!iop_ringBuffer) return 0;
+
+  do
+  {
+    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->headIndex;
+
+    writeLen = (len < availLen ? len : availLen);
+
+    if(iop_ringBuffer->b_integrity)
+    {
+      crc = ringBufferCrc32cCopy(((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->headIndex, ((char *)ip_buffer) + totalWrote, writeLen, crc);
+    }
+    else
+    {
+      ringBufferCopy(((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->headIndex, ((char *)ip_buffer) + totalWrote, writeLen, pickCopyMode(iop_ringBuffer, writeLen, RING_BUFFER_COPY_STREAM));
+    }
+
+    len -= writeLen;
+    totalWrote += writeLen;
+    /* if we go over the max buffer size, we loop around */
+    ATOMIC_STORE(iop_ringBuffer->headIndex, (iop_ringBuffer->headIndex + writeLen) & iop_ringBuffer->indexMask);
+  }
+  while(len > 0);
+
+  if(iop_ringBuffer->b_integrity && !appendCrcRecord(iop_ringBuffer, totalWrote, crc, 1))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Could not record CRC, integrity checking disabled.\n");
+
+    iop_ringBuffer->b_integrity = 0;
+
+    resetCrcRecords(iop_ringBuffer);
+  }
+
+  PROBE3(write, iop_ringBuffer, totalWrote, readSize(iop_ringBuffer));
+
+  return totalWrote;
+}
+
+/* Blocking write, the loop for the plain and converting writes. */
+unsigned long int blockingWriteUntil(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline)
+{
+  unsigned long int totalWrote = 0;
+  unsigned long int wrote = 0;
+  unsigned long int writeLen = 0;
+
+  struct timespec start;
+
+  struct s_ringBufferWaiter waiter;
+  
+  if(!iop_ringBuffer) return 0;
+  
+  if(!ip_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Input buffer is NULL.\n");
+    return 0;
+  }
+
+  if(len <= 0) return totalWrote;
+
+  if(!iop_ringBuffer->b_blocking) return (ip_convert ? ringBufferWriteConvert(iop_ringBuffer, ip_buffer, len, ip_convert) : ringBufferWrite(iop_ringBuffer, ip_buffer, len));
+
+  traceClock(iop_ringBuffer, &start);
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  /* only gets in line if it has to wait in fairness mode. */
+  waiter.b_queued = 0;
+
+  len *= iop_ringBuffer->elementSize;
+
+  PROBE3(blocking_write_start, iop_ringBuffer, len, readSize(iop_ringBuffer));
+  
+  do
+  {
+    /* on a budget, grow into it before splitting the write. */
+    budgetGrow(iop_ringBuffer, len);
+
+    writeLen = (len >= getRingBufferByteSize(iop_ringBuffer) ? getRingBufferByteSize(iop_ringBuffer) - 1 : len);
+
+    /* a converted sample can't be split between two writes. */
+    if(ip_convert) writeLen = writeLen / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+
+    while(!takeTurn(iop_ringBuffer, &waiter, writeLen, 1))
+    {
+      /* the budget may have room now. */
+      if(budgetGrow(iop_ringBuffer, writeLen)) continue;
+
+      if(!(waiter.b_queued ? fairWait(iop_ringBuffer, &waiter, ip_deadline) : checkContinueBlocking(iop_ringBuffer, ip_deadline)))
+      {
+        leaveLine(iop_ringBuffer, &waiter, 1);
+
+        /* blocking ended, write the rest by the overflow policy. */
+        if(!iop_ringBuffer->b_blocking)
+        {
+          traceCall(iop_ringBuffer, RING_BUFFER_TRACE_BLOCKING_WRITE, RING_BUFFER_TRACE_ENDED, (totalWrote + len) / iop_ringBuffer->elementSize, (totalWrote + len) / iop_ringBuffer->elementSize, totalWrote / iop_ringBuffer->elementSize, ip_deadline, &start);
+          PROBE4(blocking_write_done, iop_ringBuffer, totalWrote + len, totalWrote, readSize(iop_ringBuffer));
+
+          pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+          if(ip_convert) return (totalWrote / iop_ringBuffer->elementSize) + ringBufferWriteConvert(iop_ringBuffer, ((char *)ip_buffer) + userLength(ip_convert, totalWrote), len / iop_ringBuffer->elementSize, ip_convert);
+
+          return (totalWrote / iop_ringBuffer->elementSize) + ringBufferWrite(iop_ringBuffer, ((char *)ip_buffer) + totalWrote, len / iop_ringBuffer->elementSize);
+        }
+
+        /* mirror read fix, doesn't seem like it would do much for the write case */
+        if(writeLen <= writeSize(iop_ringBuffer)) break;
+
+        traceCall(iop_ringBuffer, RING_BUFFER_TRACE_BLOCKING_WRITE, RING_BUFFER_TRACE_TIMEOUT, (totalWrote + len) / iop_ringBuffer->elementSize, (totalWrote + len) / iop_ringBuffer->elementSize, totalWrote / iop_ringBuffer->elementSize, ip_deadline, &start);
+        PROBE4(blocking_write_done, iop_ringBuffer, totalWrote + len, totalWrote, readSize(iop_ringBuffer));
+
+        pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+        
+        return totalWrote / iop_ringBuffer->elementSize;
+      }
+    }
+
+    wrote = transferWrite(iop_ringBuffer, ((char *)ip_buffer) + userLength(ip_convert, totalWrote), writeLen, ip_convert);
+    totalWrote += wrote;
+    len -= wrote;
+    
+    notifyChange(iop_ringBuffer);
+  }
+  while(len > 0);
+
+  leaveLine(iop_ringBuffer, &waiter, 1);
+
+  traceCall(iop_ringBuffer, RING_BUFFER_TRACE_BLOCKING_WRITE, RING_BUFFER_TRACE_DONE, totalWrote / iop_ringBuffer->elementSize, totalWrote / iop_ringBuffer->elementSize, totalWrote / iop_ringBuffer->elementSize, ip_deadline, &start);
+  PROBE4(blocking_write_done, iop_ringBuffer, totalWrote, totalWrote, readSize(iop_ringBuffer));
+  
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return totalWrote / iop_ringBuffer->elementSize;
+}
+
+/* Blocking read, the loop for the plain and converting reads. */
+unsigned long int blockingReadUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert, struct timespec const *ip_deadline)
+{
+  unsigned long int totalRead = 0;
+  unsigned long int read = 0;
+  unsigned long int readLen = 0;
+
+  struct timespec start;
+
+  struct s_ringBufferWaiter waiter;
+  
+  if(!iop_ringBuffer) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  if(len <= 0) return totalRead;
+  
+  if(!iop_ringBuffer->b_blocking) return (ip_convert ? ringBufferReadConvert(iop_ringBuffer, op_buffer, len, ip_convert) : ringBufferRead(iop_ringBuffer, op_buffer, len));
+
+  traceClock(iop_ringBuffer, &start);
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  /* only gets in line if it has to wait in fairness mode. */
+  waiter.b_queued = 0;
+  
+  len *= iop_ringBuffer->elementSize;
+
+  PROBE3(blocking_read_start, iop_ringBuffer, len, readSize(iop_ringBuffer));
+  
+  do
+  {
+    readLen = (len >= getRingBufferByteSize(iop_ringBuffer) ? getRingBufferByteSize(iop_ringBuffer) - 1 : len);
+
+    if(ip_convert) readLen = readLen / iop_ringBuffer->elementSize * iop_ringBuffer->elementSize;
+    
+    while(!takeTurn(iop_ringBuffer, &waiter, readLen, 0))
+    {
+      if(!(waiter.b_queued ? fairWait(iop_ringBuffer, &waiter, ip_deadline) : checkContinueBlocking(iop_ringBuffer, ip_deadline)))
+      {
+        leaveLine(iop_ringBuffer, &waiter, 0);
+
+        /* fix if read is larger then write and block is turned off */
+        if(!iop_ringBuffer->b_blocking)
+        {
+          traceCall(iop_ringBuffer, RING_BUFFER_TRACE_BLOCKING_READ, RING_BUFFER_TRACE_ENDED, (totalRead + len) / iop_ringBuffer->elementSize, (totalRead + len) / iop_ringBuffer->elementSize, totalRead / iop_ringBuffer->elementSize, ip_deadline, &start);
+          PROBE4(blocking_read_done, iop_ringBuffer, totalRead + len, totalRead, readSize(iop_ringBuffer));
+
+          pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+          if(ip_convert) return (totalRead / iop_ringBuffer->elementSize) + ringBufferReadConvert(iop_ringBuffer, ((char *)op_buffer) + userLength(ip_convert, totalRead), len / iop_ringBuffer->elementSize, ip_convert);
+
+          return (totalRead / iop_ringBuffer->elementSize) + ringBufferRead(iop_ringBuffer, ((char *)op_buffer) + totalRead, len / iop_ringBuffer->elementSize);
+        }
+
+        /* fix for conditions when a read/write maybe called out of order and exit early with enough data availible */
+        if(readLen <= readSize(iop_ringBuffer)) break;
+
+        traceCall(iop_ringBuffer, RING_BUFFER_TRACE_BLOCKING_READ, RING_BUFFER_TRACE_TIMEOUT, (totalRead + len) / iop_ringBuffer->elementSize, (totalRead + len) / iop_ringBuffer->elementSize, totalRead / iop_ringBuffer->elementSize, ip_deadline, &start);
+        PROBE4(blocking_read_done, iop_ringBuffer, totalRead + len, totalRead, readSize(iop_ringBuffer));
+
+        pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+        return totalRead / iop_ringBuffer->elementSize;
+      }
+    }
+    
+    read = transferRead(iop_ringBuffer, ((char *)op_buffer) + userLength(ip_convert, totalRead), readLen, ip_convert);
+    totalRead += read;
+    len -= read;
+    
+    notifyChange(iop_ringBuffer);
+  }
+  while(len > 0);
+
+  leaveLine(iop_ringBuffer, &waiter, 0);
+
+  traceCall(iop_ringBuffer, RING_BUFFER_TRACE_BLOCKING_READ, RING_BUFFER_TRACE_DONE, totalRead / iop_ringBuffer->elementSize, totalRead / iop_ringBuffer->elementSize, totalRead / iop_ringBuffer->elementSize, ip_deadline, &start);
+  PROBE4(blocking_read_done, iop_ringBuffer, totalRead, totalRead, readSize(iop_ringBuffer));
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+  
+  return totalRead / iop_ringBuffer->elementSize;
+}
+
+/* Plain write, or converting write. */
+unsigned long int transferWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert)
+{
+  return (ip_convert ? rawWriteConvert(iop_ringBuffer, ip_buffer, len, ip_convert) : rawWrite(iop_ringBuffer, ip_buffer, len));
+}
+
+/* Plain read, or converting read. */
+unsigned long int transferRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert)
+{
+  return (ip_convert ? rawReadConvert(iop_ringBuffer, op_buffer, len, ip_convert) : rawRead(iop_ringBuffer, op_buffer, len));
+}
+
+/* Convert each contiguous piece into the buffer. The CRC is taken over the converted bytes, still in cache. */
+unsigned long int rawWriteConvert(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert)
+{
+  unsigned long int totalWrote = 0;
+  unsigned long int availLen = 0;
+  unsigned long int writeLen = 0;
+  unsigned long int crc = 0;
+
+  char *p_dest = NULL;
+
+  if(!iop_ringBuffer) return 0;
+
+  do
+  {
+    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->headIndex;
+
+    writeLen = (len < availLen ? len : availLen);
+
+    p_dest = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->headIndex;
+
+    ringBufferConvert(p_dest, ip_convert->ringFormat, ((char *)ip_buffer) + userLength(ip_convert, totalWrote), ip_convert->userFormat, writeLen / ringBufferFormatSize(ip_convert->ringFormat), ip_convert->scale);
+
+    if(iop_ringBuffer->b_integrity) crc = ringBufferCrc32c(crc, p_dest, writeLen);
+
+    len -= writeLen;
+    totalWrote += writeLen;
+
+    ATOMIC_STORE(iop_ringBuffer->headIndex, (iop_ringBuffer->headIndex + writeLen) & iop_ringBuffer->indexMask);
+  }
+  while(len > 0);
+
+  if(iop_ringBuffer->b_integrity && !appendCrcRecord(iop_ringBuffer, totalWrote, crc, 1))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Could not record CRC, integrity checking disabled.\n");
+
+    iop_ringBuffer->b_integrity = 0;
+
+    resetCrcRecords(iop_ringBuffer);
+  }
+
+  return totalWrote;
+}
+
+/* Convert each contiguous piece out of the buffer, checking the CRC records first. */
+unsigned long int rawReadConvert(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, struct s_ringBufferConvert const *ip_convert)
+{
+  unsigned long int totalRead = 0;
+  unsigned long int availLen = 0;
+  unsigned long int readLen = 0;
+
+  char *p_src = NULL;
+
+  if(!iop_ringBuffer) return 0;
+
+  do
+  {
+    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->tailIndex;
+
+    readLen = (len < availLen ? len : availLen);
+
+    p_src = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex;
+
+    if(iop_ringBuffer->crcRecordsCount > 0) consumeCrcRecords(iop_ringBuffer, NULL, p_src, readLen);
+
+    ringBufferConvert(((char *)op_buffer) + userLength(ip_convert, totalRead), ip_convert->userFormat, p_src, ip_convert->ringFormat, readLen / ringBufferFormatSize(ip_convert->ringFormat), ip_convert->scale);
+
+    len -= readLen;
+    totalRead += readLen;
+
+    ATOMIC_STORE(iop_ringBuffer->tailIndex, (iop_ringBuffer->tailIndex + readLen) & iop_ringBuffer->indexMask);
+  }
+  while(len > 0);
+
+  return totalRead;
+}
+
+/* Formats have to be known, and the elements whole samples of the ring format. */
+unsigned long int checkConvert(struct s_ringBuffer const * const ip_ringBuffer, struct s_ringBufferConvert const *ip_convert)
+{
+  if(!ip_convert)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Conversion is NULL.\n");
+    return PROC_FAIL;
+  }
+
+  if(!ringBufferFormatSize(ip_convert->ringFormat) || !ringBufferFormatSize(ip_convert->userFormat))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Unknown sample format.\n");
+    return PROC_FAIL;
+  }
+
+  if(ip_ringBuffer->elementSize % ringBufferFormatSize(ip_convert->ringFormat))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Element size %lu is not a whole number of samples.\n", ip_ringBuffer->elementSize);
+    return PROC_FAIL;
+  }
+
+  return PROC_SUCC;
+}
+
+/* Ring bytes to user bytes, the same number of samples in the user format. */
+unsigned long int userLength(struct s_ringBufferConvert const *ip_convert, unsigned long int len)
+{
+  if(!ip_convert) return len;
+
+  return len / ringBufferFormatSize(ip_convert->ringFormat) * ringBufferFormatSize(ip_convert->userFormat);
+}
+
+/* Deinterleave each contiguous run of whole frames, a frame split by the end of the buffer goes through a copy. */
+unsigned long int rawReadDeinterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *op_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len)
+{
+  unsigned long int totalRead = 0;
+  unsigned long int availLen = 0;
+  unsigned long int readLen = 0;
+  unsigned long int frames = 0;
+  unsigned long int frameSize = 0;
+
+  char *p_src = NULL;
+  char *p_frame = NULL;
+
+  if(!iop_ringBuffer) return 0;
+
+  frameSize = numChannels * sampleSize;
+
+  while(len >= frameSize)
+  {
+    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->tailIndex;
+
+    frames = (len < availLen ? len : availLen) / frameSize;
+
+    p_src = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex;
+
+    if(frames > 0)
+    {
+      readLen = frames * frameSize;
+
+      if(iop_ringBuffer->crcRecordsCount > 0) consumeCrcRecords(iop_ringBuffer, NULL, p_src, readLen);
+
+      ringBufferDeinterleave(op_channels, totalRead / frameSize, p_src, frames, numChannels, sampleSize);
+    }
+    else
+    {
+      /* a frame is no bigger then an element, the scratch element after the data holds it. */
+      p_frame = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->buffSize;
+
+      readLen = frameSize;
+
+      if(iop_ringBuffer->crcRecordsCount > 0)
+      {
+        consumeCrcRecords(iop_ringBuffer, NULL, p_src, availLen);
+        consumeCrcRecords(iop_ringBuffer, NULL, iop_ringBuffer->p_buffer, frameSize - availLen);
+      }
+
+      memcpy(p_frame, p_src, availLen);
+      memcpy(p_frame + availLen, iop_ringBuffer->p_buffer, frameSize - availLen);
+
+      ringBufferDeinterleave(op_channels, totalRead / frameSize, p_frame, 1, numChannels, sampleSize);
+    }
+
+    len -= readLen;
+    totalRead += readLen;
+
+    ATOMIC_STORE(iop_ringBuffer->tailIndex, (iop_ringBuffer->tailIndex + readLen) & iop_ringBuffer->indexMask);
+  }
+
+  return totalRead;
+}
+
+/* Interleave into each contiguous run of whole frames, a frame split by the end of the buffer goes through a copy. */
+unsigned long int rawWriteInterleave(struct s_ringBuffer * const iop_ringBuffer, void * const *ip_channels, unsigned long int numChannels, unsigned long int sampleSize, unsigned long int len)
+{
+  unsigned long int totalWrote = 0;
+  unsigned long int availLen = 0;
+  unsigned long int writeLen = 0;
+  unsigned long int frames = 0;
+  unsigned long int frameSize = 0;
+  unsigned long int crc = 0;
+
+  char *p_dest = NULL;
+  char *p_frame = NULL;
+
+  if(!iop_ringBuffer) return 0;
+
+  frameSize = numChannels * sampleSize;
+
+  while(len >= frameSize)
+  {
+    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->headIndex;
+
+    frames = (len < availLen ? len : availLen) / frameSize;
+
+    p_dest = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->headIndex;
+
+    if(frames > 0)
+    {
+      writeLen = frames * frameSize;
+
+      ringBufferInterleave(p_dest, ip_channels, totalWrote / frameSize, frames, numChannels, sampleSize);
+
+      if(iop_ringBuffer->b_integrity) crc = ringBufferCrc32c(crc, p_dest, writeLen);
+    }
+    else
+    {
+      /* a frame is no bigger then an element, the scratch element after the data holds it. */
+      p_frame = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->buffSize;
+
+      writeLen = frameSize;
+
+      ringBufferInterleave(p_frame, ip_channels, totalWrote / frameSize, 1, numChannels, sampleSize);
+
+      memcpy(p_dest, p_frame, availLen);
+      memcpy(iop_ringBuffer->p_buffer, p_frame + availLen, frameSize - availLen);
+
+      if(iop_ringBuffer->b_integrity) crc = ringBufferCrc32c(crc, p_frame, frameSize);
+    }
+
+    len -= writeLen;
+    totalWrote += writeLen;
+
+    ATOMIC_STORE(iop_ringBuffer->headIndex, (iop_ringBuffer->headIndex + writeLen) & iop_ringBuffer->indexMask);
+  }
+
+  if(iop_ringBuffer->b_integrity && !appendCrcRecord(iop_ringBuffer, totalWrote, crc, 1))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Could not record CRC, integrity checking disabled.\n");
+
+    iop_ringBuffer->b_integrity = 0;
+
+    resetCrcRecords(iop_ringBuffer);
+  }
+
+  return totalWrote;
+}
+
+/* Channels have to be there, and the elements whole frames. */
+unsigned long int checkFrames(struct s_ringBuffer const * const ip_ringBuffer, void * const *ip_channels, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int index = 0;
+
+  if(!ip_channels || numChannels <= 0 || sampleSize <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Channels are NULL or empty.\n");
+    return PROC_FAIL;
+  }
+
+  for(index = 0; index < numChannels; index++)
+  {
+    if(!ip_channels[index])
+    {
+      fprintf(stderr, "ANSI-C RING BUFFER: Channel %lu is NULL.\n", index);
+      return PROC_FAIL;
+    }
+  }
+
+  if(ip_ringBuffer->elementSize % (numChannels * sampleSize))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Element size %lu is not a whole number of frames.\n", ip_ringBuffer->elementSize);
+    return PROC_FAIL;
+  }
+
+  return PROC_SUCC;
+}
+
+/* Read data from the buffer. */
+unsigned long int rawRead(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len)
+{
+  return rawReadCrc(iop_ringBuffer, op_buffer, len, NULL);
+}
+
+/* Read data from the buffer, checking it against the CRC records and updating op_crc. */
+unsigned long int rawReadCrc(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int len, unsigned long int *op_crc)
+{
+  unsigned long int totalRead = 0;
+  unsigned long int availLen = 0;
+  unsigned long int readLen = 0;
+
+  char *p_src = NULL;
+  char *p_dest = NULL;
+  
+  if(!iop_ringBuffer) return 0;
+
+  do
+  {
+    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->tailIndex;
+
+    readLen = (len < availLen ? len : availLen);
+
+    p_src = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex;
+    p_dest = (op_buffer ? ((char *)op_buffer) + totalRead : NULL);
+
+    if(iop_ringBuffer->crcRecordsCount > 0)
+    {
+      /* the records checksum the copy, the caller's CRC takes a second pass over data still in cache. */
+      consumeCrcRecords(iop_ringBuffer, p_dest, p_src, readLen);
+
+      if(op_crc) *op_crc = ringBufferCrc32c(*op_crc, p_src, readLen);
+    }
+    else if(op_crc && p_dest)
+    {
+      *op_crc = ringBufferCrc32cCopy(p_dest, p_src, readLen, *op_crc);
+    }
+    else if(p_dest)
+    {
+      ringBufferCopy(p_dest, p_src, readLen, pickCopyMode(iop_ringBuffer, readLen, RING_BUFFER_COPY_PREFETCH));
+    }
+
+    len -= readLen;
+    totalRead += readLen;
+    /* if we go over the maxBuffer size. We loop around. */
+    ATOMIC_STORE(iop_ringBuffer->tailIndex, (iop_ringBuffer->tailIndex + readLen) & iop_ringBuffer->indexMask);
+  }
+  while(len > 0);
+
+  PROBE3(read, iop_ringBuffer, totalRead, readSize(iop_ringBuffer));
+
+  return totalRead;
+}
+
+/* Write with the overflow policy, only whole elements are ever dropped. */
+unsigned long int policyWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len)
+{
+  unsigned long int capacity = 0;
+  unsigned long int skipLen = 0;
+  unsigned long int overLen = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  /* a buffer on a budget grows before anything is dropped. */
+  budgetGrow(iop_ringBuffer, len);
+
+  /* largest number of whole elements the buffer can hold, in bytes. */
+  capacity = ((iop_ringBuffer->buffSize - 1) / iop_ringBuffer->elementSize) * iop_ringBuffer->elementSize;
+
+  /* a held read segment is the oldest data, it can't be overwritten under the reader, so drop newest instead. */
+  if(iop_ringBuffer->overflowPolicy != RING_BUFFER_OVERWRITE_OLDEST || (iop_ringBuffer->segmentsHeld & 2))
+  {
+    /* drop newest, or block when blocking has been ended. */
+    skipLen = (writeSize(iop_ringBuffer) / iop_ringBuffer->elementSize) * iop_ringBuffer->elementSize;
+
+    if(len > skipLen)
+    {
+      iop_ringBuffer->dropped += (len - skipLen) / iop_ringBuffer->elementSize;
+      len = skipLen;
+    }
+
+    return (len > 0 ? rawWrite(iop_ringBuffer, ip_buffer, len) : 0);
+  }
+
+  /* more then the buffer holds, only the newest of the input is kept. */
+  if(len > capacity)
+  {
+    skipLen = len - capacity;
+    iop_ringBuffer->dropped += skipLen / iop_ringBuffer->elementSize;
+    len = capacity;
+  }
+
+  /* move the tail past enough whole elements to make room. */
+  if(len > writeSize(iop_ringBuffer))
+  {
+    overLen = len - writeSize(iop_ringBuffer);
+    overLen = (overLen + iop_ringBuffer->elementSize - 1) / iop_ringBuffer->elementSize;
+
+    dropCrcRecords(iop_ringBuffer, overLen * iop_ringBuffer->elementSize);
+
+    ATOMIC_STORE(iop_ringBuffer->tailIndex, (iop_ringBuffer->tailIndex + (overLen * iop_ringBuffer->elementSize)) & iop_ringBuffer->indexMask);
+
+    iop_ringBuffer->dropped += overLen;
+    iop_ringBuffer->lapped += overLen;
+  }
+
+  return (len > 0 ? rawWrite(iop_ringBuffer, ((char *)ip_buffer) + skipLen, len) : 0);
+}
+
+/* Drain data in place, the function is given each contiguous run of whole elements. */
+unsigned long int rawDrain(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context)
+{
+  unsigned long int totalDrained = 0;
+  unsigned long int availLen = 0;
+  unsigned long int drainLen = 0;
+  unsigned long int consumed = 0;
+
+  if(!iop_ringBuffer) return 0;
+
+  while(len >= iop_ringBuffer->elementSize)
+  {
+    availLen = iop_ringBuffer->buffSize - iop_ringBuffer->tailIndex;
+
+    drainLen = (len < availLen ? len : availLen) / iop_ringBuffer->elementSize;
+
+    if(drainLen > 0)
+    {
+      consumed = p_drainFunc(((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex, drainLen, p_context);
+
+      consumed = (consumed < drainLen ? consumed : drainLen);
+
+      /* no copy, only checks the records and moves the tail. */
+      rawReadCrc(iop_ringBuffer, NULL, consumed * iop_ringBuffer->elementSize, NULL);
+    }
+    else
+    {
+      /* element is split by the end of the buffer, hand it over in a copy in the scratch element after the data. */
+      char *p_element = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->buffSize;
+
+      memcpy(p_element, ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex, availLen);
+      memcpy(p_element + availLen, iop_ringBuffer->p_buffer, iop_ringBuffer->elementSize - availLen);
+
+      drainLen = 1;
+
+      consumed = (p_drainFunc(p_element, drainLen, p_context) > 0);
+
+      if(consumed) rawReadCrc(iop_ringBuffer, NULL, iop_ringBuffer->elementSize, NULL);
+    }
+
+    len -= consumed * iop_ringBuffer->elementSize;
+    totalDrained += consumed * iop_ringBuffer->elementSize;
+
+    if(consumed < drainLen) break;
+  }
+
+  return totalDrained;
+}
+
+/* Window at the tail, in one or two pieces. Copied out if there is a buffer, otherwise shown to the function in place. */
+unsigned long int rawWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int window, unsigned long int hop, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context)
+{
+  unsigned long int availLen = 0;
+  unsigned long int b_consume = 0;
+
+  struct s_ringBufferWindow tempWindow;
+
+  if(!iop_ringBuffer) return 0;
+
+  availLen = iop_ringBuffer->buffSize - iop_ringBuffer->tailIndex;
+
+  tempWindow.p_first = ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex;
+  tempWindow.firstLen = (window < availLen ? window : availLen);
+  tempWindow.p_second = (window > availLen ? iop_ringBuffer->p_buffer : NULL);
+  tempWindow.secondLen = window - tempWindow.firstLen;
+
+  if(op_buffer)
+  {
+    ringBufferCopy(op_buffer, tempWindow.p_first, tempWindow.firstLen, pickCopyMode(iop_ringBuffer, window, RING_BUFFER_COPY_PREFETCH));
+
+    if(tempWindow.secondLen > 0) ringBufferCopy(((char *)op_buffer) + tempWindow.firstLen, tempWindow.p_second, tempWindow.secondLen, pickCopyMode(iop_ringBuffer, window, RING_BUFFER_COPY_PREFETCH));
+
+    b_consume = 1;
+  }
+  else
+  {
+    b_consume = (p_windowFunc(&tempWindow, p_context) != 0);
+  }
+
+  /* only the hop is consumed, the overlap stays for the next window. */
+  if(b_consume && hop > 0) rawReadCrc(iop_ringBuffer, NULL, hop, NULL);
+
+  return b_consume;
+}
+
+/* Read or drain a window if the whole window and hop are there. */
+unsigned long int lockedWindow(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context)
+{
+  unsigned long int window = 0;
+  unsigned long int hop = 0;
+  unsigned long int b_shown = 0;
+
+  if(windowElems <= 0) return 0;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  window = windowElems * iop_ringBuffer->elementSize;
+  hop = hopElems * iop_ringBuffer->elementSize;
+
+  if((window > hop ? window : hop) <= readSize(iop_ringBuffer))
+  {
+    rawWindow(iop_ringBuffer, op_buffer, window, hop, p_windowFunc, p_context);
+
+    b_shown = 1;
+
+    notifyChange(iop_ringBuffer);
+  }
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return (b_shown ? windowElems : 0);
+}
+
+/* Wait for the whole window and hop, then read or drain it. */
+unsigned long int windowUntil(struct s_ringBuffer * const iop_ringBuffer, void *op_buffer, unsigned long int windowElems, unsigned long int hopElems, unsigned long int (*p_windowFunc)(struct s_ringBufferWindow const *ip_window, void *p_context), void *p_context, struct timespec const *ip_deadline)
+{
+  unsigned long int needLen = 0;
+
+  struct s_ringBufferWaiter waiter;
+
+  if(windowElems <= 0) return 0;
+
+  if(!iop_ringBuffer->b_blocking) return lockedWindow(iop_ringBuffer, op_buffer, windowElems, hopElems, p_windowFunc, p_context);
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  needLen = (windowElems > hopElems ? windowElems : hopElems) * iop_ringBuffer->elementSize;
+
+  /* would wait forever. */
+  if(needLen > writeSize(iop_ringBuffer) + readSize(iop_ringBuffer))
+  {
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Window is larger then the buffer.\n");
+    return 0;
+  }
+
+  /* only gets in line if it has to wait in fairness mode. */
+  waiter.b_queued = 0;
+
+  while(!takeTurn(iop_ringBuffer, &waiter, needLen, 0))
+  {
+    if(!(waiter.b_queued ? fairWait(iop_ringBuffer, &waiter, ip_deadline) : checkContinueBlocking(iop_ringBuffer, ip_deadline)))
+    {
+      leaveLine(iop_ringBuffer, &waiter, 0);
+
+      /* blocking ended, there may still be a full window left. */
+      if(!iop_ringBuffer->b_blocking)
+      {
+        pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+        return lockedWindow(iop_ringBuffer, op_buffer, windowElems, hopElems, p_windowFunc, p_context);
+      }
+
+      if(needLen <= readSize(iop_ringBuffer)) break;
+
+      pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+      return 0;
+    }
+  }
+
+  rawWindow(iop_ringBuffer, op_buffer, windowElems * iop_ringBuffer->elementSize, hopElems * iop_ringBuffer->elementSize, p_windowFunc, p_context);
+
+  notifyChange(iop_ringBuffer);
+  leaveLine(iop_ringBuffer, &waiter, 0);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return windowElems;
+}
+
+/* Push the record, then whoever gets the mutex applies it. Spin a little on the flag first, the combiner is usually quick. */
+unsigned long int combinedWrite(struct s_ringBuffer * const iop_ringBuffer, void *ip_buffer, unsigned long int len)
+{
+  unsigned long int spins = 0;
+
+  struct s_ringBufferCombineRecord record;
+
+  /* no one has the mutex, write without publishing and take whatever else is waiting along with it. */
+  if(!pthread_mutex_trylock(&iop_ringBuffer->rwMutex))
+  {
+    record.result = policyWrite(iop_ringBuffer, ip_buffer, len);
+
+    if(__atomic_load_n(&iop_ringBuffer->p_combineHead, __ATOMIC_RELAXED)) combineWrites(iop_ringBuffer);
+
+    notifyChange(iop_ringBuffer);
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+    return record.result;
+  }
+
+  record.p_buffer = ip_buffer;
+  record.len = len;
+  record.result = 0;
+  record.b_done = 0;
+  record.p_next = __atomic_load_n(&iop_ringBuffer->p_combineHead, __ATOMIC_RELAXED);
+
+  while(!__atomic_compare_exchange_n(&iop_ringBuffer->p_combineHead, &record.p_next, &record, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+  for(;;)
+  {
+    if(ATOMIC_LOAD(record.b_done)) return record.result;
+
+    /* out of spins, wait on the mutex. We combine when we get it, if no one did it first. */
+    if(spins++ >= COMBINE_SPINS)
+    {
+      pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+      break;
+    }
+
+    if(!pthread_mutex_trylock(&iop_ringBuffer->rwMutex)) break;
+
+    CPU_RELAX();
+  }
+
+  /* a combiner that took our record finished it before it let go of the mutex. */
+  if(!ATOMIC_LOAD(record.b_done) && combineWrites(iop_ringBuffer) > 0) notifyChange(iop_ringBuffer);
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return record.result;
+}
+
+/* Take the whole stack, flip it to publication order, write each. A thread only has one record out, so its order holds. */
+unsigned long int combineWrites(struct s_ringBuffer * const iop_ringBuffer)
+{
+  unsigned long int passes = 0;
+  unsigned long int numCombined = 0;
+
+  struct s_ringBufferCombineRecord *p_record = NULL;
+  struct s_ringBufferCombineRecord *p_next = NULL;
+  struct s_ringBufferCombineRecord *p_ordered = NULL;
+
+  for(passes = 0; passes < COMBINE_PASSES; passes++)
+  {
+    p_record = __atomic_exchange_n(&iop_ringBuffer->p_combineHead, NULL, __ATOMIC_ACQUIRE);
+
+    if(!p_record) break;
+
+    p_ordered = NULL;
+
+    while(p_record)
+    {
+      p_next = p_record->p_next;
+      p_record->p_next = p_ordered;
+      p_ordered = p_record;
+      p_record = p_next;
+    }
+
+    while(p_ordered)
+    {
+      /* the record is on its writer's stack, done with it once b_done is set. */
+      p_next = p_ordered->p_next;
+
+      p_ordered->result = policyWrite(iop_ringBuffer, p_ordered->p_buffer, p_ordered->len);
+
+      ATOMIC_STORE(p_ordered->b_done, 1);
+
+      numCombined++;
+
+      p_ordered = p_next;
+    }
+  }
+
+  return numCombined;
+}
+
+/* Free space from the head or data from the tail, stopping at the end of the buffer. */
+unsigned long int segmentSize(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int b_write)
+{
+  unsigned long int totalLen = 0;
+  unsigned long int endLen = 0;
+
+  totalLen = (b_write ? writeSize(ip_ringBuffer) : readSize(ip_ringBuffer));
+  endLen = ip_ringBuffer->buffSize - (b_write ? ip_ringBuffer->headIndex : ip_ringBuffer->tailIndex);
+
+  return (totalLen < endLen ? totalLen : endLen);
+}
+
+/* Wait for a segment of whole blocks, or the short run to the end of the buffer. Once blocking ends a reader gets the last partial block. */
+unsigned long int acquireUntil(struct s_ringBuffer * const iop_ringBuffer, void **op_segment, unsigned long int blockSize, unsigned long int b_write, struct timespec const *ip_deadline)
+{
+  unsigned long int segLen = 0;
+
+  struct s_ringBufferWaiter waiter;
+
+  if(!op_segment)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Segment pointer is NULL.\n");
+    return 0;
+  }
+
+  *op_segment = NULL;
+
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  /* blocks have to tile the buffer, or one would straddle the wrap. */
+  if((blockSize <= 0) || (blockSize % iop_ringBuffer->elementSize) || (iop_ringBuffer->buffSize % blockSize))
+  {
+    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Block size must be whole elements and divide the buffer size.\n");
+    return 0;
+  }
+
+  /* only gets in line if it has to wait in fairness mode. */
+  waiter.b_queued = 0;
+
+  for(;;)
+  {
+    /* a buffer on a budget grows into a block, unless a segment is still out. */
+    if(b_write) budgetGrow(iop_ringBuffer, blockSize);
+
+    /* our turn needs a block in total. Short of a block before the end of the buffer, after a partial commit or a plain read or write, that short run is the segment, so the next one starts back on a block at the front. */
+    if(takeTurn(iop_ringBuffer, &waiter, blockSize, b_write))
+    {
+      segLen = segmentSize(iop_ringBuffer, b_write);
+
+      if(segLen >= blockSize) segLen = segLen / blockSize * blockSize;
+
+      if(segLen > 0) break;
+    }
+
+    if(!iop_ringBuffer->b_blocking)
+    {
+      segLen = (b_write ? 0 : segmentSize(iop_ringBuffer, 0));
+      break;
+    }
+
+    /* timed out, take one more look. If blocking ended the top of the loop deals with it. */
+    if(!(waiter.b_queued ? fairWait(iop_ringBuffer, &waiter, ip_deadline) : checkContinueBlocking(iop_ringBuffer, ip_deadline)) && iop_ringBuffer->b_blocking)
+    {
+      segLen = segmentSize(iop_ringBuffer, b_write) / blockSize * blockSize;
+      break;
+    }
+  }
+
+  leaveLine(iop_ringBuffer, &waiter, b_write);
+
+  if(segLen > 0)
+  {
+    *op_segment = ((char *)iop_ringBuffer->p_buffer) + (b_write ? iop_ringBuffer->headIndex : iop_ringBuffer->tailIndex);
+
+    /* the buffer can't move under the segment till it is committed. */
+    iop_ringBuffer->segmentsHeld |= (b_write ? 1 : 2);
+  }
+
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  return segLen;
+}
+
+/* Writes stream so the ring doesn't take over the cache, reads prefetch since the ring isn't in it. */
+unsigned long int pickCopyMode(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int len, unsigned long int autoMode)
+{
+  if(ip_ringBuffer->copyMode != RING_BUFFER_COPY_AUTO) return ip_ringBuffer->copyMode;
+
+  return (len >= ip_ringBuffer->copyThreshold ? autoMode : RING_BUFFER_COPY_MEMCPY);
+}
+
+/* Add a record to the end of the circular list, doubling it when full. */
+unsigned long int appendCrcRecord(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len, unsigned long int crc, unsigned long int b_valid)
+{
+  unsigned long int index = 0;
+  unsigned long int newSize = 0;
+
+  struct s_ringBufferCrcRecord *p_record = NULL;
+  struct s_ringBufferCrcRecord *p_temp = NULL;
+
+  if(!iop_ringBuffer) return PROC_FAIL;
+
+  if(len <= 0) return PROC_SUCC;
+
+  if(iop_ringBuffer->crcRecordsCount >= iop_ringBuffer->crcRecordsSize)
+  {
+    newSize = (iop_ringBuffer->crcRecordsSize ? iop_ringBuffer->crcRecordsSize * 2 : 16);
+
+    p_temp = malloc(newSize * sizeof(*p_temp));
+
+    if(!p_temp)
+    {
+      perror("ANSI-C RING BUFFER: Could not allocate CRC records.");
+      return PROC_FAIL;
+    }
+
+    /* unroll the old list so the oldest is at 0. */
+    for(index = 0; index < iop_ringBuffer->crcRecordsCount; index++)
+    {
+      p_temp[index] = iop_ringBuffer->p_crcRecords[(iop_ringBuffer->crcRecordsHead + index) % iop_ringBuffer->crcRecordsSize];
+    }
+
+    free(iop_ringBuffer->p_crcRecords);
+
+    iop_ringBuffer->p_crcRecords = p_temp;
+    iop_ringBuffer->crcRecordsSize = newSize;
+    iop_ringBuffer->crcRecordsHead = 0;
+  }
+
+  p_record = &iop_ringBuffer->p_crcRecords[(iop_ringBuffer->crcRecordsHead + iop_ringBuffer->crcRecordsCount) % iop_ringBuffer->crcRecordsSize];
+
+  p_record->len = len;
+  p_record->crc = crc;
+  p_record->runningCrc = 0;
+  p_record->b_valid = b_valid;
+
+  iop_ringBuffer->crcRecordsCount++;
+
+  return PROC_SUCC;
+}
+
+/* Walk the records over the bytes read, a record is checked once all of its bytes are read. */
+void consumeCrcRecords(struct s_ringBuffer * const iop_ringBuffer, void *op_dest, void const *ip_src, unsigned long int len)
+{
+  unsigned long int pieceLen = 0;
+
+  char *p_dest = (char *)op_dest;
+  char const *p_src = (char const *)ip_src;
+
+  struct s_ringBufferCrcRecord *p_record = NULL;
+
+  if(!iop_ringBuffer) return;
+
+  while(len > 0)
+  {
+    /* more data then records, nothing left to check. */
+    if(!iop_ringBuffer->crcRecordsCount)
+    {
+      if(p_dest) memcpy(p_dest, p_src, len);
+      return;
+    }
+
+    p_record = &iop_ringBuffer->p_crcRecords[iop_ringBuffer->crcRecordsHead];
+
+    pieceLen = (len < p_record->len ? len : p_record->len);
+
+    if(p_record->b_valid && p_dest)
+    {
+      p_record->runningCrc = ringBufferCrc32cCopy(p_dest, p_src, pieceLen, p_record->runningCrc);
+    }
+    else if(p_record->b_valid)
+    {
+      p_record->runningCrc = ringBufferCrc32c(p_record->runningCrc, p_src, pieceLen);
+    }
+    else if(p_dest)
+    {
+      memcpy(p_dest, p_src, pieceLen);
+    }
+
+    p_record->len -= pieceLen;
+
+    if(!p_record->len)
+    {
+      if(p_record->b_valid && (p_record->runningCrc != p_record->crc)) iop_ringBuffer->crcErrors++;
+
+      iop_ringBuffer->crcRecordsHead = (iop_ringBuffer->crcRecordsHead + 1) % iop_ringBuffer->crcRecordsSize;
+      iop_ringBuffer->crcRecordsCount--;
+    }
+
+    if(p_dest) p_dest += pieceLen;
+
+    p_src += pieceLen;
+    len -= pieceLen;
+  }
+}
+
+/* Drop bytes off the front of the records, a record only partly dropped can't be checked. */
+void dropCrcRecords(struct s_ringBuffer * const iop_ringBuffer, unsigned long int len)
+{
+  unsigned long int pieceLen = 0;
+
+  struct s_ringBufferCrcRecord *p_record = NULL;
+
+  if(!iop_ringBuffer) return;
+
+  while((len > 0) && iop_ringBuffer->crcRecordsCount)
+  {
+    p_record = &iop_ringBuffer->p_crcRecords[iop_ringBuffer->crcRecordsHead];
+
+    pieceLen = (len < p_record->len ? len : p_record->len);
+
+    p_record->len -= pieceLen;
+    p_record->b_valid = 0;
+
+    if(!p_record->len)
+    {
+      iop_ringBuffer->crcRecordsHead = (iop_ringBuffer->crcRecordsHead + 1) % iop_ringBuffer->crcRecordsSize;
+      iop_ringBuffer->crcRecordsCount--;
+    }
+
+    len -= pieceLen;
+  }
+}
+
+/* Empty the records, if integrity is on whatever is in the buffer gets one unchecked record. */
+void resetCrcRecords(struct s_ringBuffer * const iop_ringBuffer)
+{
+  if(!iop_ringBuffer) return;
+
+  iop_ringBuffer->crcRecordsHead = 0;
+  iop_ringBuffer->crcRecordsCount = 0;
+
+  if(!iop_ringBuffer->b_integrity) return;
+
+  if(!appendCrcRecord(iop_ringBuffer, readSize(iop_ringBuffer), 0, 0))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Could not record CRC, integrity checking disabled.\n");
+
+    iop_ringBuffer->b_integrity = 0;
+  }
+}
+
+/*  allocate the buffer, will also preform reallocations if it is already allocated. */
+unsigned long int allocateBuffer(struct s_ringBuffer * const iop_ringBuffer, unsigned long int buffSize, unsigned long int elementSize)
+{
+  unsigned long int byteSize = 0;
+  
+  void *p_temp = NULL;
+  
+  if(!iop_ringBuffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer pointer NULL.\n");
+    return PROC_FAIL;
+  }
+  
+  byteSize = roundBufferSize(buffSize, elementSize);
+
+  if(!byteSize) return PROC_FAIL;
+
+  /* realloc would lose the alignment, allocate aligned and move what fits. The scratch element goes after the data. */
+  if(posix_memalign(&p_temp, iop_ringBuffer->alignment, byteSize + elementSize)) p_temp = NULL;
+  
+  if(!p_temp)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate buffer.");
+    return PROC_FAIL;
+  }
+
+  memcpy(p_temp, iop_ringBuffer->p_buffer, (byteSize < iop_ringBuffer->buffSize ? byteSize : iop_ringBuffer->buffSize));
+
+  /* the buffer may be in memory we don't own, only free one we do. */
+  if(iop_ringBuffer->memFlags & OWN_BUFFER) free(iop_ringBuffer->p_buffer);
+  
+  iop_ringBuffer->p_buffer = p_temp;
+  iop_ringBuffer->memFlags |= OWN_BUFFER;
+
+  iop_ringBuffer->buffSize = byteSize;
+  /* we subtract one to create a mask of 01111 from the size of 1000, we include 0 remember! */
+  iop_ringBuffer->indexMask = byteSize - 1;
+  iop_ringBuffer->elementSize = elementSize;
+  iop_ringBuffer->b_blocking = 1;
+
+  return PROC_SUCC;
+}
+
+/*  size checks, then the next power of two up from the size in bytes. */
+unsigned long int roundBufferSize(unsigned long int buffSize, unsigned long int elementSize)
+{
+  unsigned long int maxBuffSize = 0;
+  unsigned long int byteSize = 1;
+
+  /* The buffer can't be any larger then 0111111... since 1000... is are mask to loop the buffer around. */
+  maxBuffSize = (unsigned long int)~0 >> 1;
+
+  if(elementSize <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Element size less then or equal to 0.\n");
+    return 0;
+  }
+
+  if(buffSize <= 0)
+  {
+    fprintf(stderr, ("ANSI-C RING BUFFER: Size must be greater then 0.\n"));
+    return 0;
+  }
+  
+  if((buffSize > maxBuffSize / elementSize) || ((buffSize * elementSize) > maxBuffSize / 2 + 1))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Size is too large, must be equal to or less then %lu.\n", maxBuffSize / 2 + 1);
+    return 0;
+  }
+
+  /* find the greatest binary bit */
+  while((byteSize <<= 1) < (buffSize * elementSize));
+
+  return byteSize;
+}
+
+/* deal with the blocking check in the function. The method is the same for read and write. The mutex is held on return either way. */
+unsigned long int checkContinueBlocking(struct s_ringBuffer * const iop_ringBuffer, struct timespec const *ip_deadline)
+{
+  int error = 0;
+
+  if(!iop_ringBuffer) return STOP_BLOCKING;
+
+  /* turned down by the budget, another ring buffer giving back is what it waits for. */
+  if(iop_ringBuffer->b_budgetShort) return budgetWait(iop_ringBuffer, ip_deadline);
+
+  PROBE3(wait_start, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+
+  /* a buffer on a budget doesn't shrink under a waiter. */
+  iop_ringBuffer->waiting++;
+  
+  /* if we have a deadline, do a timed wait. Otherwise we just wait. */
+  if(ip_deadline)
+  {
+    /* the condition is on CLOCK_MONOTONIC, the deadline is absolute so waking early and waiting again doesn't move it. */
+    error = pthread_cond_timedwait(&iop_ringBuffer->condition, &iop_ringBuffer->rwMutex, ip_deadline);
+  }
+  else
+  {
+    /* if we don't have a wait time, and not enough space to read data we 
+     * are going to wait. This method will release the mutex, and wait for
+     * the condition to be signaled. If this is successful, a 0 value is returned.
+     * if it fails, we signal such and return what we did read.
+     */
+    error = pthread_cond_wait(&iop_ringBuffer->condition, &iop_ringBuffer->rwMutex);
+  }
+
+  iop_ringBuffer->waiting--;
+
+  if(error)
+  {
+    if(ip_deadline)
+    {
+      PROBE3(wait_timeout, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+    }
+
+    pthread_cond_signal(&iop_ringBuffer->condition);
+    return STOP_BLOCKING;
+  }
+
+  PROBE3(wait_wake, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+
+  if(!iop_ringBuffer->b_blocking) return STOP_BLOCKING;
+
+  return CONT_BLOCKING;
+}
+
+/* state of the buffer changed, complete what async ops we can, and wake a blocked thread. */
+void notifyChange(struct s_ringBuffer * const iop_ringBuffer)
+{
+  struct s_ringBufferWaitEntry *p_entry = NULL;
+
+  if(!iop_ringBuffer) return;
+
+  if(iop_ringBuffer->p_asyncReadHead || iop_ringBuffer->p_asyncWriteHead) serviceAsync(iop_ringBuffer);
+
+  if(iop_ringBuffer->p_budget) budgetShrink(iop_ringBuffer, 0);
+
+  for(p_entry = iop_ringBuffer->p_waitEntries; p_entry; p_entry = p_entry->p_ringNext) queueWaitEntry(p_entry);
+
+  if(iop_ringBuffer->p_writeWaiters || iop_ringBuffer->p_readWaiters) wakeLines(iop_ringBuffer);
+
+  /* writers waiting on the budget may fit now, or blocking ended. */
+  if(iop_ringBuffer->budgetWaiting)
+  {
+    pthread_mutex_lock(&iop_ringBuffer->p_budget->mutex);
+    pthread_cond_broadcast(&iop_ringBuffer->p_budget->condition);
+    pthread_mutex_unlock(&iop_ringBuffer->p_budget->mutex);
+  }
+
+  pthread_cond_signal(&iop_ringBuffer->condition);
+}
+
+/* the clock is only read when tracing, a zero start means the call started before the trace. */
+void traceClock(struct s_ringBuffer const * const ip_ringBuffer, struct timespec *op_start)
+{
+  op_start->tv_sec = 0;
+  op_start->tv_nsec = 0;
+
+  if(ip_ringBuffer->p_traceFile) clock_gettime(CLOCK_MONOTONIC, op_start);
+}
+
+/* stdio buffers the records, a write error stops the trace. */
+void traceCall(struct s_ringBuffer * const iop_ringBuffer, unsigned long int op, unsigned long int outcome, unsigned long int len, unsigned long int minLen, unsigned long int result, struct timespec const *ip_deadline, struct timespec const *ip_start)
+{
+  struct timespec now;
+
+  struct s_ringBufferTraceRecord record;
+
+  if(!iop_ringBuffer->p_traceFile) return;
+
+  if(!ip_start->tv_sec && !ip_start->tv_nsec) return;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  record.time = elapsedNs(&iop_ringBuffer->traceStart, ip_start);
+  record.duration = elapsedNs(ip_start, &now);
+  record.thread = (unsigned long int)pthread_self();
+  record.op = op;
+  record.outcome = outcome;
+  record.len = len;
+  record.minLen = minLen;
+  record.result = result;
+  /* 0 is no timeout, a deadline already gone is the shortest one there is. */
+  record.timeout = (ip_deadline ? elapsedNs(ip_start, ip_deadline) : 0);
+
+  if(ip_deadline && !record.timeout) record.timeout = 1;
+
+  if(fwrite(&record, sizeof(record), 1, iop_ringBuffer->p_traceFile) != 1)
+  {
+    perror("ANSI-C RING BUFFER: Could not write trace file, trace stopped.");
+    closeTrace(iop_ringBuffer);
+    return;
+  }
+
+  iop_ringBuffer->traceRecords++;
+}
+
+/* calls that read p_traceFile without the lock only ever see it or NULL. */
+unsigned long int closeTrace(struct s_ringBuffer * const iop_ringBuffer)
+{
+  FILE *p_file = iop_ringBuffer->p_traceFile;
+
+  if(!p_file) return 0;
+
+  iop_ringBuffer->p_traceFile = NULL;
+
+  if(fclose(p_file)) perror("ANSI-C RING BUFFER: Could not close trace file.");
+
+  return iop_ringBuffer->traceRecords;
+}
+
+/* timespec difference, clamped at 0. */
+unsigned long int elapsedNs(struct timespec const *ip_from, struct timespec const *ip_to)
+{
+  long int diff = 0;
+
+  if((ip_to->tv_sec < ip_from->tv_sec) || ((ip_to->tv_sec == ip_from->tv_sec) && (ip_to->tv_nsec <= ip_from->tv_nsec))) return 0;
+
+  diff = (long int)(ip_to->tv_sec - ip_from->tv_sec) * 1000000000L + (ip_to->tv_nsec - ip_from->tv_nsec);
+
+  return (unsigned long int)diff;
+}
+
+/* serve in the order they got in line. Only the head can go, and only when all it asked for fits. */
+unsigned long int takeTurn(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferWaiter * const iop_waiter, unsigned long int need, unsigned long int b_write)
+{
+  unsigned long int avail = 0;
+  unsigned long int waited = 0;
+
+  struct timespec now;
+
+  struct s_ringBufferWaiter **pp_waiter = NULL;
+
+  avail = (b_write ? writeSize(iop_ringBuffer) : readSize(iop_ringBuffer));
+
+  if(!iop_ringBuffer->b_fair && !iop_waiter->b_queued) return (need <= avail);
+
+  pp_waiter = (b_write ? &iop_ringBuffer->p_writeWaiters : &iop_ringBuffer->p_readWaiters);
+
+  if(!iop_waiter->b_queued)
+  {
+    /* no one ahead of us and it fits, no reason to get in line. */
+    if(!*pp_waiter && (need <= avail)) return 1;
+
+    /* without our own condition we wait like everyone else did. */
+    if(!initMonotonicCondition(&iop_waiter->condition)) return (need <= avail);
+
+    clock_gettime(CLOCK_MONOTONIC, &iop_waiter->since);
+
+    iop_waiter->p_next = NULL;
+    iop_waiter->b_queued = 1;
+
+    while(*pp_waiter) pp_waiter = &(*pp_waiter)->p_next;
+
+    *pp_waiter = iop_waiter;
+
+    pp_waiter = (b_write ? &iop_ringBuffer->p_writeWaiters : &iop_ringBuffer->p_readWaiters);
+  }
+
+  /* the head of the line can ask for less as it finishes, the need is what it asks for now. */
+  iop_waiter->need = need;
+
+  if((*pp_waiter != iop_waiter) || (need > avail)) return 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  /* microseconds, the monotonic clock never goes back. */
+  waited = (unsigned long int)((long)(now.tv_sec - iop_waiter->since.tv_sec) * 1000000L + (now.tv_nsec - iop_waiter->since.tv_nsec) / 1000L);
+
+  if(waited > iop_ringBuffer->maxWait) iop_ringBuffer->maxWait = waited;
+
+  /* the next piece of a large request is timed from here. */
+  iop_waiter->since = now;
+
+  return 1;
+}
+
+/* the waiter only gets signaled when it is the head and its request fits, or blocking ended. */
+unsigned long int fairWait(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferWaiter * const iop_waiter, struct timespec const *ip_deadline)
+{
+  int error = 0;
+
+  if(!iop_ringBuffer || !iop_waiter) return STOP_BLOCKING;
+
+  /* it keeps its place in line. */
+  if(iop_ringBuffer->b_budgetShort) return budgetWait(iop_ringBuffer, ip_deadline);
+
+  PROBE3(wait_start, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+
+  iop_ringBuffer->waiting++;
+
+  if(ip_deadline)
+  {
+    error = pthread_cond_timedwait(&iop_waiter->condition, &iop_ringBuffer->rwMutex, ip_deadline);
+  }
+  else
+  {
+    error = pthread_cond_wait(&iop_waiter->condition, &iop_ringBuffer->rwMutex);
+  }
+
+  iop_ringBuffer->waiting--;
+
+  if(error)
+  {
+    if(ip_deadline)
+    {
+      PROBE3(wait_timeout, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+    }
+
+    return STOP_BLOCKING;
+  }
+
+  PROBE3(wait_wake, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+
+  if(!iop_ringBuffer->b_blocking) return STOP_BLOCKING;
+
+  return CONT_BLOCKING;
+}
+
+/* unlink from anywhere in the line, a timed out waiter may not be the head. */
+void leaveLine(struct s_ringBuffer * const iop_ringBuffer, struct s_ringBufferWaiter * const iop_waiter, unsigned long int b_write)
+{
+  struct s_ringBufferWaiter **pp_waiter = NULL;
+
+  if(!iop_waiter->b_queued) return;
+
+  pp_waiter = (b_write ? &iop_ringBuffer->p_writeWaiters : &iop_ringBuffer->p_readWaiters);
+
+  while(*pp_waiter && (*pp_waiter != iop_waiter)) pp_waiter = &(*pp_waiter)->p_next;
+
+  if(*pp_waiter) *pp_waiter = iop_waiter->p_next;
+
+  iop_waiter->b_queued = 0;
+
+  pthread_cond_destroy(&iop_waiter->condition);
+
+  /* a new head may fit now that we aren't in front of it. */
+  wakeLines(iop_ringBuffer);
+}
+
+/* only the heads, the rest can't go before them anyway. */
+void wakeLines(struct s_ringBuffer * const iop_ringBuffer)
+{
+  if(iop_ringBuffer->p_writeWaiters && (iop_ringBuffer->p_writeWaiters->need <= writeSize(iop_ringBuffer))) pthread_cond_signal(&iop_ringBuffer->p_writeWaiters->condition);
+
+  if(iop_ringBuffer->p_readWaiters && (iop_ringBuffer->p_readWaiters->need <= readSize(iop_ringBuffer))) pthread_cond_signal(&iop_ringBuffer->p_readWaiters->condition);
+}
+
+/* ready for read when there is data or blocking ended, write when there is space or blocking ended. Waiters check without the ring buffer lock. */
+unsigned long int readyEvents(struct s_ringBuffer const * const ip_ringBuffer, unsigned long int events)
+{
+  unsigned long int readyNow = 0;
+
+  if(!ip_ringBuffer) return 0;
+
+  if((events & RING_BUFFER_WAIT_READ) && (!ATOMIC_LOAD(ip_ringBuffer->b_blocking) || atomicReadSize(ip_ringBuffer) > 0)) readyNow |= RING_BUFFER_WAIT_READ;
+
+  if((events & RING_BUFFER_WAIT_WRITE) && (!ATOMIC_LOAD(ip_ringBuffer->b_blocking) || atomicWriteSize(ip_ringBuffer) >= ip_ringBuffer->elementSize)) readyNow |= RING_BUFFER_WAIT_WRITE;
+
+  return readyNow;
+}
+
+/* queue a ready entry once, it stays queued till a waiter looks at it. */
+void queueWaitEntry(struct s_ringBufferWaitEntry * const iop_entry)
+{
+  struct s_ringBufferWaitSet *p_waitSet = NULL;
+
+  if(!iop_entry) return;
+
+  if(!readyEvents(iop_entry->p_ringBuffer, iop_entry->events)) return;
+
+  p_waitSet = iop_entry->p_waitSet;
+
+  pthread_mutex_lock(&p_waitSet->mutex);
+
+  if(!iop_entry->b_queued)
+  {
+    iop_entry->b_queued = 1;
+    iop_entry->p_readyNext = NULL;
+
+    if(p_waitSet->p_readyTail)
+    {
+      p_waitSet->p_readyTail->p_readyNext = iop_entry;
+    }
+    else
+    {
+      p_waitSet->p_readyHead = iop_entry;
+    }
+
+    p_waitSet->p_readyTail = iop_entry;
+  }
+
+  /* an ended ring buffer stays ready for good, every waiter has to see it to shut down. */
+  if(!iop_entry->p_ringBuffer->b_blocking)
+  {
+    pthread_cond_broadcast(&p_waitSet->condition);
+  }
+  else
+  {
+    pthread_cond_signal(&p_waitSet->condition);
+  }
+
+  pthread_mutex_unlock(&p_waitSet->mutex);
+}
+
+/* service the async queues in order, reads free space for writes and writes add data for reads. */
+void serviceAsync(struct s_ringBuffer * const iop_ringBuffer)
+{
+  unsigned long int progress = 0;
+  unsigned long int transferLen = 0;
+
+  struct s_ringBufferAsyncOp *p_op = NULL;
+
+  if(!iop_ringBuffer) return;
+
+  do
+  {
+    progress = 0;
+
+    while((p_op = iop_ringBuffer->p_asyncReadHead) != NULL)
+    {
+      transferLen = readSize(iop_ringBuffer) / iop_ringBuffer->elementSize;
+
+      transferLen = (p_op->len - p_op->count < transferLen ? p_op->len - p_op->count : transferLen);
+
+      if(transferLen > 0)
+      {
+        p_op->count += rawRead(iop_ringBuffer, ((char *)p_op->p_buffer) + (p_op->count * iop_ringBuffer->elementSize), transferLen * iop_ringBuffer->elementSize) / iop_ringBuffer->elementSize;
+        progress = 1;
+      }
+
+      if(p_op->count < p_op->len)
+      {
+        /* nothing more is coming, give back what we have. */
+        if(!iop_ringBuffer->b_blocking)
+        {
+          completeAsync(&iop_ringBuffer->p_asyncReadHead, &iop_ringBuffer->p_asyncReadTail, RING_BUFFER_ASYNC_ENDED);
+          continue;
+        }
+
+        break;
+      }
+
+      completeAsync(&iop_ringBuffer->p_asyncReadHead, &iop_ringBuffer->p_asyncReadTail, RING_BUFFER_ASYNC_DONE);
+    }
+
+    while((p_op = iop_ringBuffer->p_asyncWriteHead) != NULL)
+    {
+      /* nobody will read it, mirror the blocking write and stop. */
+      if(!iop_ringBuffer->b_blocking)
+      {
+        completeAsync(&iop_ringBuffer->p_asyncWriteHead, &iop_ringBuffer->p_asyncWriteTail, RING_BUFFER_ASYNC_ENDED);
+        continue;
+      }
+
+      /* a buffer on a budget grows before the op has to wait. */
+      budgetGrow(iop_ringBuffer, (p_op->len - p_op->count) * iop_ringBuffer->elementSize);
+
+      transferLen = writeSize(iop_ringBuffer) / iop_ringBuffer->elementSize;
+
+      transferLen = (p_op->len - p_op->count < transferLen ? p_op->len - p_op->count : transferLen);
+
+      if(transferLen > 0)
+      {
+        p_op->count += rawWrite(iop_ringBuffer, ((char *)p_op->p_buffer) + (p_op->count * iop_ringBuffer->elementSize), transferLen * iop_ringBuffer->elementSize) / iop_ringBuffer->elementSize;
+        progress = 1;
+      }
+
+      if(p_op->count < p_op->len) break;
+
+      completeAsync(&iop_ringBuffer->p_asyncWriteHead, &iop_ringBuffer->p_asyncWriteTail, RING_BUFFER_ASYNC_DONE);
+    }
+  }
+  while(progress);
+}
+
+/* pop the head op and let the owner know it is finished. */
+void completeAsync(struct s_ringBufferAsyncOp **iopp_head, struct s_ringBufferAsyncOp **iopp_tail, unsigned long int status)
+{
+  struct s_ringBufferAsyncOp *p_op = NULL;
+
+  if(!iopp_head || !*iopp_head) return;
+
+  p_op = *iopp_head;
+
+  *iopp_head = p_op->p_next;
+
+  if(!*iopp_head) *iopp_tail = NULL;
+
+  p_op->p_next = NULL;
+
+  /* the caller is still in ringBufferAsyncRead/Write, it gets the status as a return instead. */
+  if(p_op->status == ASYNC_IN_CALL)
+  {
+    p_op->status = status;
+    return;
+  }
+
+  p_op->status = status;
+
+  if(p_op->p_callback) p_op->p_callback(p_op);
+}
+
+/* conditions time out on CLOCK_MONOTONIC, set with the attribute. */
+int initMonotonicCondition(pthread_cond_t *op_condition)
+{
+  int error = 0;
+
+  pthread_condattr_t condAttr;
+
+  if(pthread_condattr_init(&condAttr)) return PROC_FAIL;
+
+  error = pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+
+  if(!error) error = pthread_cond_init(op_condition, &condAttr);
+
+  pthread_condattr_destroy(&condAttr);
+
+  return (error ? PROC_FAIL : PROC_SUCC);
+}
+
+/* double till need fits, up to the max. The data is copied in order to the front of the new buffer. */
+unsigned long int budgetGrow(struct s_ringBuffer * const iop_ringBuffer, unsigned long int need)
+{
+  unsigned long int newSize = 0;
+  unsigned long int used = 0;
+  unsigned long int charge = 0;
+  unsigned long int firstLen = 0;
+
+  void *p_temp = NULL;
+
+  if(!iop_ringBuffer->p_budget) return PROC_FAIL;
+
+  iop_ringBuffer->b_budgetShort = 0;
+
+  if(need <= writeSize(iop_ringBuffer)) return PROC_FAIL;
+
+  /* a segment points into the buffer. */
+  if(iop_ringBuffer->segmentsHeld) return PROC_FAIL;
+
+  used = readSize(iop_ringBuffer);
+
+  newSize = iop_ringBuffer->buffSize << 1;
+
+  while((newSize < iop_ringBuffer->budgetMax) && (newSize - 1 < used + need)) newSize <<= 1;
+
+  if(newSize > iop_ringBuffer->budgetMax) return PROC_FAIL;
+
+  /* the reserved buffer stays, a grown buffer replaces the last grown one. */
+  charge = newSize - (iop_ringBuffer->buffSize > iop_ringBuffer->budgetMin ? iop_ringBuffer->buffSize : 0);
+
+  if(!ringBufferBudgetTake(iop_ringBuffer->p_budget, charge))
+  {
+    iop_ringBuffer->b_budgetShort = 1;
+    return PROC_FAIL;
+  }
+
+  /* with the scratch element after the data. */
+  if(posix_memalign(&p_temp, iop_ringBuffer->alignment, newSize + iop_ringBuffer->elementSize)) p_temp = NULL;
+
+  if(!p_temp)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate buffer.");
+    ringBufferBudgetGive(iop_ringBuffer->p_budget, charge);
+    return PROC_FAIL;
+  }
+
+  PROBE3(resize, iop_ringBuffer, iop_ringBuffer->buffSize, newSize);
+
+  firstLen = iop_ringBuffer->buffSize - iop_ringBuffer->tailIndex;
+  firstLen = (used < firstLen ? used : firstLen);
+
+  memcpy(p_temp, ((char *)iop_ringBuffer->p_buffer) + iop_ringBuffer->tailIndex, firstLen);
+  memcpy(((char *)p_temp) + firstLen, iop_ringBuffer->p_buffer, used - firstLen);
+
+  if(iop_ringBuffer->memFlags & OWN_BUFFER) free(iop_ringBuffer->p_buffer);
+
+  beginGeometry(iop_ringBuffer);
+
+  iop_ringBuffer->p_buffer = p_temp;
+  iop_ringBuffer->memFlags |= OWN_BUFFER;
+
+  ATOMIC_STORE(iop_ringBuffer->buffSize, newSize);
+  ATOMIC_STORE(iop_ringBuffer->indexMask, newSize - 1);
+
+  /* the CRC records go by length, they still line up. */
+  ATOMIC_STORE(iop_ringBuffer->tailIndex, 0);
+  ATOMIC_STORE(iop_ringBuffer->headIndex, used);
+
+  endGeometry(iop_ringBuffer);
+
+  /* a burst that grew it, the low water run starts over. */
+  iop_ringBuffer->budgetIdle = 0;
+  iop_ringBuffer->budgetDenied = __atomic_load_n(&iop_ringBuffer->p_budget->denied, __ATOMIC_ACQUIRE);
+
+  return PROC_SUCC;
+}
+
+/* only after a run of changes under the low water mark, half the minimum, unless b_now or the budget is short. Then only empty, with no one waiting or holding a segment, and no async write that needs the room. */
+void budgetShrink(struct s_ringBuffer * const iop_ringBuffer, unsigned long int b_now)
+{
+  unsigned long int buffSize = 0;
+
+  void *p_grown = NULL;
+
+  if(!iop_ringBuffer->p_budget) return;
+
+  if(iop_ringBuffer->buffSize <= iop_ringBuffer->budgetMin) return;
+
+  /* still in a burst, start the run over. */
+  if(readSize(iop_ringBuffer) > iop_ringBuffer->budgetMin / 2)
+  {
+    iop_ringBuffer->budgetIdle = 0;
+    return;
+  }
+
+  if(iop_ringBuffer->budgetIdle < BUDGET_IDLE_CHANGES) iop_ringBuffer->budgetIdle++;
+
+  /* someone was turned down since it grew, they need the memory more then the run matters. */
+  if(!b_now && (iop_ringBuffer->budgetIdle < BUDGET_IDLE_CHANGES) && (__atomic_load_n(&iop_ringBuffer->p_budget->denied, __ATOMIC_ACQUIRE) == iop_ringBuffer->budgetDenied)) return;
+
+  if(readSize(iop_ringBuffer) || iop_ringBuffer->waiting || iop_ringBuffer->segmentsHeld || iop_ringBuffer->p_asyncWriteHead) return;
+
+  buffSize = iop_ringBuffer->buffSize;
+  p_grown = iop_ringBuffer->p_buffer;
+
+  PROBE3(resize, iop_ringBuffer, buffSize, iop_ringBuffer->budgetMin);
+
+  beginGeometry(iop_ringBuffer);
+
+  iop_ringBuffer->p_buffer = iop_ringBuffer->p_homeBuffer;
+  iop_ringBuffer->memFlags &= ~(unsigned long int)OWN_BUFFER;
+
+  ATOMIC_STORE(iop_ringBuffer->buffSize, iop_ringBuffer->budgetMin);
+  ATOMIC_STORE(iop_ringBuffer->indexMask, iop_ringBuffer->budgetMin - 1);
+
+  ATOMIC_STORE(iop_ringBuffer->tailIndex, 0);
+  ATOMIC_STORE(iop_ringBuffer->headIndex, 0);
+
+  endGeometry(iop_ringBuffer);
+
+  iop_ringBuffer->budgetIdle = 0;
+
+  free(p_grown);
+
+  ringBufferBudgetGive(iop_ringBuffer->p_budget, buffSize);
+}
+
+/* the add is a full barrier, none of the swap moves before it. */
+void beginGeometry(struct s_ringBuffer * const iop_ringBuffer)
+{
+  __atomic_add_fetch(&iop_ringBuffer->geometry, 1, __ATOMIC_SEQ_CST);
+}
+
+/* release, all of the swap is seen before the even value. */
+void endGeometry(struct s_ringBuffer * const iop_ringBuffer)
+{
+  ATOMIC_STORE(iop_ringBuffer->geometry, iop_ringBuffer->geometry + 1);
+}
+
+/* the budget mutex is taken before the ring buffer mutex is let go, a give or a change to the buffer can't slip in before the wait. The ring buffer mutex is held again on return. */
+unsigned long int budgetWait(struct s_ringBuffer * const iop_ringBuffer, struct timespec const *ip_deadline)
+{
+  int error = 0;
+
+  struct s_ringBufferBudget *p_budget = iop_ringBuffer->p_budget;
+
+  iop_ringBuffer->b_budgetShort = 0;
+
+  PROBE3(wait_start, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+
+  iop_ringBuffer->waiting++;
+  iop_ringBuffer->budgetWaiting++;
+
+  pthread_mutex_lock(&p_budget->mutex);
+  pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
+
+  p_budget->waiting++;
+
+  if(ip_deadline)
+  {
+    error = pthread_cond_timedwait(&p_budget->condition, &p_budget->mutex, ip_deadline);
+  }
+  else
+  {
+    error = pthread_cond_wait(&p_budget->condition, &p_budget->mutex);
+  }
+
+  p_budget->waiting--;
+
+  /* lock order is the ring buffer mutex first. */
+  pthread_mutex_unlock(&p_budget->mutex);
+  pthread_mutex_lock(&iop_ringBuffer->rwMutex);
+
+  iop_ringBuffer->budgetWaiting--;
+  iop_ringBuffer->waiting--;
+
+  if(error)
+  {
+    if(ip_deadline)
+    {
+      PROBE3(wait_timeout, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+    }
+
+    return STOP_BLOCKING;
+  }
+
+  PROBE3(wait_wake, iop_ringBuffer, readSize(iop_ringBuffer), writeSize(iop_ringBuffer));
+
+  if(!iop_ringBuffer->b_blocking) return STOP_BLOCKING;
 
-  if(!iop_ringBuffer->b_blocking)
-  {
-    pthread_mutex_unlock(&iop_ringBuffer->rwMutex);
-    return STOP_BLOCKING;
-  }
   return CONT_BLOCKING;
 }
@@ -0,0 +1,250 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer memory budget
+  * @details Byte counts under a mutex. The ring buffers do the growing and shrinking,
+  * taking from and giving back to the budget with their own mutex held.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.30.0 - Initial version, ring buffer memory budget.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ringBufferBudget.h>
+
+#define PROC_SUCC 1
+#define PROC_FAIL 0
+
+/*  private helper functions */
+/*  init a condition that times out against CLOCK_MONOTONIC, the ring buffer deadlines are on it. */
+int initBudgetCondition(pthread_cond_t *op_condition);
+
+/*  public  functions */
+/*  init, nothing taken yet. */
+struct s_ringBufferBudget *initRingBufferBudget(unsigned long int limit)
+{
+  struct s_ringBufferBudget *p_tempBudget = NULL;
+
+  if(limit <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Budget must be greater then 0.\n");
+    return NULL;
+  }
+
+  p_tempBudget = malloc(sizeof(struct s_ringBufferBudget));
+
+  if(!p_tempBudget)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate budget object.");
+    return NULL;
+  }
+
+  memset(p_tempBudget, 0, sizeof(*p_tempBudget));
+
+  p_tempBudget->limit = limit;
+
+  if(pthread_mutex_init(&p_tempBudget->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Budget mutex init failed.\n");
+    free(p_tempBudget);
+    return NULL;
+  }
+
+  if(!initBudgetCondition(&p_tempBudget->condition))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Budget condition init failed.\n");
+    pthread_mutex_destroy(&p_tempBudget->mutex);
+    free(p_tempBudget);
+    return NULL;
+  }
+
+  return p_tempBudget;
+}
+
+/*  free the budget, the ring buffers on it would be left pointing at nothing. */
+void freeRingBufferBudget(struct s_ringBufferBudget **iopp_ringBufferBudget)
+{
+  if(!iopp_ringBufferBudget) return;
+
+  if(!*iopp_ringBufferBudget) return;
+
+  if(getRingBufferBudgetUsed(*iopp_ringBufferBudget) > 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: %lu bytes still on the budget, not freed.\n", getRingBufferBudgetUsed(*iopp_ringBufferBudget));
+    return;
+  }
+
+  pthread_cond_destroy(&(*iopp_ringBufferBudget)->condition);
+  pthread_mutex_destroy(&(*iopp_ringBufferBudget)->mutex);
+
+  free(*iopp_ringBufferBudget);
+
+  *iopp_ringBufferBudget = NULL;
+}
+
+/*  init the ring buffer at its minimum, then reserve that from the budget. */
+struct s_ringBuffer *initRingBufferOnBudget(struct s_ringBufferBudget * const iop_ringBufferBudget, unsigned long int minSize, unsigned long int maxSize, unsigned long int elementSize)
+{
+  unsigned long int maxBytes = 0;
+
+  struct s_ringBuffer *p_ringBuffer = NULL;
+
+  if(!iop_ringBufferBudget) return NULL;
+
+  p_ringBuffer = initRingBuffer(minSize, elementSize);
+
+  if(!p_ringBuffer) return NULL;
+
+  if(!ringBufferBudgetTake(iop_ringBufferBudget, getRingBufferByteSize(p_ringBuffer)))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Budget can't cover the minimum of %lu bytes.\n", getRingBufferByteSize(p_ringBuffer));
+    freeRingBuffer(&p_ringBuffer);
+    return NULL;
+  }
+
+  /* sizes stay powers of two, the maximum is the first doubling that holds maxSize. */
+  maxBytes = getRingBufferByteSize(p_ringBuffer);
+
+  while((maxBytes / elementSize < maxSize) && (maxBytes < (~0UL >> 2))) maxBytes <<= 1;
+
+  p_ringBuffer->budgetMin = getRingBufferByteSize(p_ringBuffer);
+  p_ringBuffer->budgetMax = maxBytes;
+  p_ringBuffer->p_homeBuffer = p_ringBuffer->p_buffer;
+  p_ringBuffer->p_budget = iop_ringBufferBudget;
+
+  return p_ringBuffer;
+}
+
+/*  take bytes if they fit under the limit. */
+int ringBufferBudgetTake(struct s_ringBufferBudget * const iop_ringBufferBudget, unsigned long int bytes)
+{
+  if(!iop_ringBufferBudget) return PROC_FAIL;
+
+  pthread_mutex_lock(&iop_ringBufferBudget->mutex);
+
+  if(bytes > iop_ringBufferBudget->limit - iop_ringBufferBudget->used)
+  {
+    /* ring buffers waiting out their low water run check it without the lock. */
+    __atomic_add_fetch(&iop_ringBufferBudget->denied, 1, __ATOMIC_RELEASE);
+
+    pthread_mutex_unlock(&iop_ringBufferBudget->mutex);
+    return PROC_FAIL;
+  }
+
+  iop_ringBufferBudget->used += bytes;
+
+  if(iop_ringBufferBudget->used > iop_ringBufferBudget->peak) iop_ringBufferBudget->peak = iop_ringBufferBudget->used;
+
+  pthread_mutex_unlock(&iop_ringBufferBudget->mutex);
+
+  return PROC_SUCC;
+}
+
+/*  give bytes back. */
+void ringBufferBudgetGive(struct s_ringBufferBudget * const iop_ringBufferBudget, unsigned long int bytes)
+{
+  if(!iop_ringBufferBudget) return;
+
+  pthread_mutex_lock(&iop_ringBufferBudget->mutex);
+
+  iop_ringBufferBudget->used -= (bytes < iop_ringBufferBudget->used ? bytes : iop_ringBufferBudget->used);
+
+  /* writers that were turned down try again. */
+  if(iop_ringBufferBudget->waiting) pthread_cond_broadcast(&iop_ringBufferBudget->condition);
+
+  pthread_mutex_unlock(&iop_ringBufferBudget->mutex);
+}
+
+/*  How many bytes are taken? */
+unsigned long int getRingBufferBudgetUsed(struct s_ringBufferBudget * const ip_ringBufferBudget)
+{
+  unsigned long int tempSize = 0;
+
+  if(!ip_ringBufferBudget) return ERROR_NULL;
+
+  pthread_mutex_lock(&ip_ringBufferBudget->mutex);
+
+  tempSize = ip_ringBufferBudget->used;
+
+  pthread_mutex_unlock(&ip_ringBufferBudget->mutex);
+
+  return tempSize;
+}
+
+/*  Most bytes ever taken? */
+unsigned long int getRingBufferBudgetPeak(struct s_ringBufferBudget * const ip_ringBufferBudget)
+{
+  unsigned long int tempSize = 0;
+
+  if(!ip_ringBufferBudget) return ERROR_NULL;
+
+  pthread_mutex_lock(&ip_ringBufferBudget->mutex);
+
+  tempSize = ip_ringBufferBudget->peak;
+
+  pthread_mutex_unlock(&ip_ringBufferBudget->mutex);
+
+  return tempSize;
+}
+
+/*  How many times was the budget used up? */
+unsigned long int getRingBufferBudgetDenied(struct s_ringBufferBudget * const ip_ringBufferBudget)
+{
+  unsigned long int tempSize = 0;
+
+  if(!ip_ringBufferBudget) return ERROR_NULL;
+
+  pthread_mutex_lock(&ip_ringBufferBudget->mutex);
+
+  tempSize = ip_ringBufferBudget->denied;
+
+  pthread_mutex_unlock(&ip_ringBufferBudget->mutex);
+
+  return tempSize;
+}
+
+/*  help function implimentation */
+/*  same clock as the ring buffer conditions. */
+int initBudgetCondition(pthread_cond_t *op_condition)
+{
+  int error = 0;
+
+  pthread_condattr_t condAttr;
+
+  if(pthread_condattr_init(&condAttr)) return PROC_FAIL;
+
+  error = pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+
+  if(!error) error = pthread_cond_init(op_condition, &condAttr);
+
+  pthread_condattr_destroy(&condAttr);
+
+  return (error ? PROC_FAIL : PROC_SUCC);
+}
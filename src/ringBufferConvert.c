@@ -0,0 +1,540 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer sample conversion
+  * @details Sample format conversion kernels for the converting read and write.
+  * Hot pairs (int16, int32 and float32 to and from float32) have SSE2, AVX2 and
+  * NEON kernels, picked once at run time on x86-64. Everything else goes
+  * through double.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.22.0 - Initial version, sample format conversion kernels.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <ringBuffer.h>
+
+/*  private helper functions */
+/*  pick the kernels for this CPU. Run once. */
+void convertInit(void);
+/*  round to nearest, ties to even, like the vector converts. x must fit in a long. */
+long int roundEven(double x);
+/*  any format to any format through double. */
+void convertGeneric(void *op_dest, unsigned long int destFormat, void const *ip_src, unsigned long int srcFormat, unsigned long int count, double scale);
+/*  int16 to float32, one at a time. */
+void convertS16ToF32(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to int16, one at a time, saturated. */
+void convertF32ToS16(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  int32 to float32, one at a time. */
+void convertS32ToF32(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to float32, one at a time. */
+void convertF32ToF32(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  int16 to float32, 8 at a time, every x86-64 has SSE2. */
+void convertS16ToF32Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to int16, 8 at a time. */
+void convertF32ToS16Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  int32 to float32, 4 at a time. */
+void convertS32ToF32Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to float32, 4 at a time. */
+void convertF32ToF32Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  int16 to float32, 16 at a time. */
+void convertS16ToF32Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to int16, 16 at a time. */
+void convertF32ToS16Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  int32 to float32, 8 at a time. */
+void convertS32ToF32Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to float32, 8 at a time. */
+void convertF32ToF32Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+#endif
+#if defined(__GNUC__) && defined(__aarch64__)
+/*  int16 to float32, 8 at a time. */
+void convertS16ToF32Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to int16, 8 at a time. */
+void convertF32ToS16Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  int32 to float32, 4 at a time. */
+void convertS32ToF32Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+/*  float32 to float32, 4 at a time. */
+void convertF32ToF32Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale);
+#endif
+
+static pthread_once_t g_convertOnce = PTHREAD_ONCE_INIT;
+static void (*gp_s16ToF32)(void *op_dest, void const *ip_src, unsigned long int count, float scale) = convertS16ToF32;
+static void (*gp_f32ToS16)(void *op_dest, void const *ip_src, unsigned long int count, float scale) = convertF32ToS16;
+static void (*gp_s32ToF32)(void *op_dest, void const *ip_src, unsigned long int count, float scale) = convertS32ToF32;
+static void (*gp_f32ToF32)(void *op_dest, void const *ip_src, unsigned long int count, float scale) = convertF32ToF32;
+
+/*  public  functions */
+/*  bytes in one sample of a format. */
+unsigned long int ringBufferFormatSize(unsigned long int format)
+{
+  switch(format)
+  {
+    case RING_BUFFER_FORMAT_INT8:
+      return sizeof(signed char);
+    case RING_BUFFER_FORMAT_INT16:
+      return sizeof(short int);
+    case RING_BUFFER_FORMAT_INT32:
+      return sizeof(int);
+    case RING_BUFFER_FORMAT_FLOAT32:
+      return sizeof(float);
+    case RING_BUFFER_FORMAT_FLOAT64:
+      return sizeof(double);
+    default:
+      return 0;
+  }
+}
+
+/*  convert count samples, with a vector kernel if there is one for the pair. */
+void *ringBufferConvert(void *op_dest, unsigned long int destFormat, void const *ip_src, unsigned long int srcFormat, unsigned long int count, double scale)
+{
+  if(!op_dest || !ip_src) return op_dest;
+
+  if(!ringBufferFormatSize(destFormat) || !ringBufferFormatSize(srcFormat))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Unknown sample format.\n");
+    return op_dest;
+  }
+
+  if(scale == 0.0) scale = 1.0;
+
+  pthread_once(&g_convertOnce, convertInit);
+
+  if(srcFormat == RING_BUFFER_FORMAT_INT16 && destFormat == RING_BUFFER_FORMAT_FLOAT32)
+  {
+    gp_s16ToF32(op_dest, ip_src, count, (float)scale);
+  }
+  else if(srcFormat == RING_BUFFER_FORMAT_FLOAT32 && destFormat == RING_BUFFER_FORMAT_INT16)
+  {
+    gp_f32ToS16(op_dest, ip_src, count, (float)scale);
+  }
+  else if(srcFormat == RING_BUFFER_FORMAT_INT32 && destFormat == RING_BUFFER_FORMAT_FLOAT32)
+  {
+    gp_s32ToF32(op_dest, ip_src, count, (float)scale);
+  }
+  else if(srcFormat == RING_BUFFER_FORMAT_FLOAT32 && destFormat == RING_BUFFER_FORMAT_FLOAT32)
+  {
+    gp_f32ToF32(op_dest, ip_src, count, (float)scale);
+  }
+  else if(srcFormat == destFormat && scale == 1.0)
+  {
+    memcpy(op_dest, ip_src, count * ringBufferFormatSize(srcFormat));
+  }
+  else
+  {
+    convertGeneric(op_dest, destFormat, ip_src, srcFormat, count, scale);
+  }
+
+  return op_dest;
+}
+
+/*  help function implimentation */
+/*  widest kernels the CPU has. NEON is always there on aarch64. */
+void convertInit(void)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+  __builtin_cpu_init();
+
+  gp_s16ToF32 = convertS16ToF32Sse2;
+  gp_f32ToS16 = convertF32ToS16Sse2;
+  gp_s32ToF32 = convertS32ToF32Sse2;
+  gp_f32ToF32 = convertF32ToF32Sse2;
+
+  if(__builtin_cpu_supports("avx2"))
+  {
+    gp_s16ToF32 = convertS16ToF32Avx2;
+    gp_f32ToS16 = convertF32ToS16Avx2;
+    gp_s32ToF32 = convertS32ToF32Avx2;
+    gp_f32ToF32 = convertF32ToF32Avx2;
+  }
+#endif
+#if defined(__GNUC__) && defined(__aarch64__)
+  gp_s16ToF32 = convertS16ToF32Neon;
+  gp_f32ToS16 = convertF32ToS16Neon;
+  gp_s32ToF32 = convertS32ToF32Neon;
+  gp_f32ToF32 = convertF32ToF32Neon;
+#endif
+}
+
+/*  truncate, then fix up the fraction. */
+long int roundEven(double x)
+{
+  long int whole = (long int)x;
+
+  double frac = x - (double)whole;
+
+  if(frac > 0.5 || (frac == 0.5 && (whole & 1)))
+  {
+    whole++;
+  }
+  else if(frac < -0.5 || (frac == -0.5 && (whole & 1)))
+  {
+    whole--;
+  }
+
+  return whole;
+}
+
+/*  load as double, scale, then round and saturate for integer formats. */
+void convertGeneric(void *op_dest, unsigned long int destFormat, void const *ip_src, unsigned long int srcFormat, unsigned long int count, double scale)
+{
+  unsigned long int index = 0;
+
+  double value = 0;
+
+  for(index = 0; index < count; index++)
+  {
+    switch(srcFormat)
+    {
+      case RING_BUFFER_FORMAT_INT8:
+        value = ((signed char const *)ip_src)[index];
+        break;
+      case RING_BUFFER_FORMAT_INT16:
+        value = ((short int const *)ip_src)[index];
+        break;
+      case RING_BUFFER_FORMAT_INT32:
+        value = ((int const *)ip_src)[index];
+        break;
+      case RING_BUFFER_FORMAT_FLOAT32:
+        value = ((float const *)ip_src)[index];
+        break;
+      default:
+        value = ((double const *)ip_src)[index];
+        break;
+    }
+
+    value *= scale;
+
+    switch(destFormat)
+    {
+      case RING_BUFFER_FORMAT_INT8:
+        value = (!(value <= 127.0) ? 127.0 : (value < -128.0 ? -128.0 : value));
+        ((signed char *)op_dest)[index] = (signed char)roundEven(value);
+        break;
+      case RING_BUFFER_FORMAT_INT16:
+        value = (!(value <= 32767.0) ? 32767.0 : (value < -32768.0 ? -32768.0 : value));
+        ((short int *)op_dest)[index] = (short int)roundEven(value);
+        break;
+      case RING_BUFFER_FORMAT_INT32:
+        value = (!(value <= 2147483647.0) ? 2147483647.0 : (value < -2147483648.0 ? -2147483648.0 : value));
+        ((int *)op_dest)[index] = (int)roundEven(value);
+        break;
+      case RING_BUFFER_FORMAT_FLOAT32:
+        ((float *)op_dest)[index] = (float)value;
+        break;
+      default:
+        ((double *)op_dest)[index] = value;
+        break;
+    }
+  }
+}
+
+/*  scale in float, same as the vector kernels. */
+void convertS16ToF32(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  unsigned long int index = 0;
+
+  for(index = 0; index < count; index++)
+  {
+    ((float *)op_dest)[index] = (float)((short int const *)ip_src)[index] * scale;
+  }
+}
+
+/*  scale in float, clamp, then round. */
+void convertF32ToS16(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  unsigned long int index = 0;
+
+  float value = 0;
+
+  for(index = 0; index < count; index++)
+  {
+    value = ((float const *)ip_src)[index] * scale;
+
+    /* written so NaN goes to the max, same as the SSE min. */
+    value = (!(value <= 32767.0f) ? 32767.0f : (value < -32768.0f ? -32768.0f : value));
+
+    ((short int *)op_dest)[index] = (short int)roundEven(value);
+  }
+}
+
+/*  scale in float, same as the vector kernels. */
+void convertS32ToF32(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  unsigned long int index = 0;
+
+  for(index = 0; index < count; index++)
+  {
+    ((float *)op_dest)[index] = (float)((int const *)ip_src)[index] * scale;
+  }
+}
+
+/*  just the scale. */
+void convertF32ToF32(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  unsigned long int index = 0;
+
+  for(index = 0; index < count; index++)
+  {
+    ((float *)op_dest)[index] = ((float const *)ip_src)[index] * scale;
+  }
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  sign extend by unpacking into the top half and shifting down. */
+__attribute__((target("sse2")))
+void convertS16ToF32Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  short int const *p_src = (short int const *)ip_src;
+
+  __m128 vScale = _mm_set1_ps(scale);
+
+  for(; count >= 8; count -= 8, p_dest += 8, p_src += 8)
+  {
+    __m128i data = _mm_loadu_si128((__m128i const *)p_src);
+    __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(data, data), 16);
+    __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(data, data), 16);
+
+    _mm_storeu_ps(p_dest, _mm_mul_ps(_mm_cvtepi32_ps(low), vScale));
+    _mm_storeu_ps(p_dest + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), vScale));
+  }
+
+  convertS16ToF32(p_dest, p_src, count, scale);
+}
+
+/*  clamp first, out of range converts give INT_MIN. The pack saturates the rest of the way. */
+__attribute__((target("sse2")))
+void convertF32ToS16Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  short int *p_dest = (short int *)op_dest;
+  float const *p_src = (float const *)ip_src;
+
+  __m128 vScale = _mm_set1_ps(scale);
+  __m128 vMax = _mm_set1_ps(32767.0f);
+  __m128 vMin = _mm_set1_ps(-32768.0f);
+
+  for(; count >= 8; count -= 8, p_dest += 8, p_src += 8)
+  {
+    __m128 low = _mm_mul_ps(_mm_loadu_ps(p_src), vScale);
+    __m128 high = _mm_mul_ps(_mm_loadu_ps(p_src + 4), vScale);
+
+    low = _mm_max_ps(_mm_min_ps(low, vMax), vMin);
+    high = _mm_max_ps(_mm_min_ps(high, vMax), vMin);
+
+    _mm_storeu_si128((__m128i *)p_dest, _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+  }
+
+  convertF32ToS16(p_dest, p_src, count, scale);
+}
+
+/*  convert and scale. */
+__attribute__((target("sse2")))
+void convertS32ToF32Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  int const *p_src = (int const *)ip_src;
+
+  __m128 vScale = _mm_set1_ps(scale);
+
+  for(; count >= 4; count -= 4, p_dest += 4, p_src += 4)
+  {
+    _mm_storeu_ps(p_dest, _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((__m128i const *)p_src)), vScale));
+  }
+
+  convertS32ToF32(p_dest, p_src, count, scale);
+}
+
+/*  scale. */
+__attribute__((target("sse2")))
+void convertF32ToF32Sse2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  float const *p_src = (float const *)ip_src;
+
+  __m128 vScale = _mm_set1_ps(scale);
+
+  for(; count >= 4; count -= 4, p_dest += 4, p_src += 4)
+  {
+    _mm_storeu_ps(p_dest, _mm_mul_ps(_mm_loadu_ps(p_src), vScale));
+  }
+
+  convertF32ToF32(p_dest, p_src, count, scale);
+}
+
+/*  sign extend 8 at a time. */
+__attribute__((target("avx2")))
+void convertS16ToF32Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  short int const *p_src = (short int const *)ip_src;
+
+  __m256 vScale = _mm256_set1_ps(scale);
+
+  for(; count >= 16; count -= 16, p_dest += 16, p_src += 16)
+  {
+    __m256i low = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *)p_src));
+    __m256i high = _mm256_cvtepi16_epi32(_mm_loadu_si128((__m128i const *)(p_src + 8)));
+
+    _mm256_storeu_ps(p_dest, _mm256_mul_ps(_mm256_cvtepi32_ps(low), vScale));
+    _mm256_storeu_ps(p_dest + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(high), vScale));
+  }
+
+  convertS16ToF32(p_dest, p_src, count, scale);
+}
+
+/*  the pack works per 128 bit lane, the permute puts the halves back in order. */
+__attribute__((target("avx2")))
+void convertF32ToS16Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  short int *p_dest = (short int *)op_dest;
+  float const *p_src = (float const *)ip_src;
+
+  __m256 vScale = _mm256_set1_ps(scale);
+  __m256 vMax = _mm256_set1_ps(32767.0f);
+  __m256 vMin = _mm256_set1_ps(-32768.0f);
+
+  for(; count >= 16; count -= 16, p_dest += 16, p_src += 16)
+  {
+    __m256 low = _mm256_mul_ps(_mm256_loadu_ps(p_src), vScale);
+    __m256 high = _mm256_mul_ps(_mm256_loadu_ps(p_src + 8), vScale);
+
+    low = _mm256_max_ps(_mm256_min_ps(low, vMax), vMin);
+    high = _mm256_max_ps(_mm256_min_ps(high, vMax), vMin);
+
+    _mm256_storeu_si256((__m256i *)p_dest, _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_cvtps_epi32(low), _mm256_cvtps_epi32(high)), 0xD8));
+  }
+
+  convertF32ToS16(p_dest, p_src, count, scale);
+}
+
+/*  convert and scale. */
+__attribute__((target("avx2")))
+void convertS32ToF32Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  int const *p_src = (int const *)ip_src;
+
+  __m256 vScale = _mm256_set1_ps(scale);
+
+  for(; count >= 8; count -= 8, p_dest += 8, p_src += 8)
+  {
+    _mm256_storeu_ps(p_dest, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_loadu_si256((__m256i const *)p_src)), vScale));
+  }
+
+  convertS32ToF32(p_dest, p_src, count, scale);
+}
+
+/*  scale. */
+__attribute__((target("avx2")))
+void convertF32ToF32Avx2(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  float const *p_src = (float const *)ip_src;
+
+  __m256 vScale = _mm256_set1_ps(scale);
+
+  for(; count >= 8; count -= 8, p_dest += 8, p_src += 8)
+  {
+    _mm256_storeu_ps(p_dest, _mm256_mul_ps(_mm256_loadu_ps(p_src), vScale));
+  }
+
+  convertF32ToF32(p_dest, p_src, count, scale);
+}
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__)
+/*  widen, convert and scale. */
+void convertS16ToF32Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  short int const *p_src = (short int const *)ip_src;
+
+  for(; count >= 8; count -= 8, p_dest += 8, p_src += 8)
+  {
+    int16x8_t data = vld1q_s16(p_src);
+
+    vst1q_f32(p_dest, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(data))), scale));
+    vst1q_f32(p_dest + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(data))), scale));
+  }
+
+  convertS16ToF32(p_dest, p_src, count, scale);
+}
+
+/*  the round to nearest convert and the narrow both saturate, no clamp needed. */
+void convertF32ToS16Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  short int *p_dest = (short int *)op_dest;
+  float const *p_src = (float const *)ip_src;
+
+  for(; count >= 8; count -= 8, p_dest += 8, p_src += 8)
+  {
+    int32x4_t low = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(p_src), scale));
+    int32x4_t high = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(p_src + 4), scale));
+
+    vst1q_s16(p_dest, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+  }
+
+  convertF32ToS16(p_dest, p_src, count, scale);
+}
+
+/*  convert and scale. */
+void convertS32ToF32Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  int const *p_src = (int const *)ip_src;
+
+  for(; count >= 4; count -= 4, p_dest += 4, p_src += 4)
+  {
+    vst1q_f32(p_dest, vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(p_src)), scale));
+  }
+
+  convertS32ToF32(p_dest, p_src, count, scale);
+}
+
+/*  scale. */
+void convertF32ToF32Neon(void *op_dest, void const *ip_src, unsigned long int count, float scale)
+{
+  float *p_dest = (float *)op_dest;
+  float const *p_src = (float const *)ip_src;
+
+  for(; count >= 4; count -= 4, p_dest += 4, p_src += 4)
+  {
+    vst1q_f32(p_dest, vmulq_n_f32(vld1q_f32(p_src), scale));
+  }
+
+  convertF32ToF32(p_dest, p_src, count, scale);
+}
+#endif
@@ -0,0 +1,246 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer copy kernels
+  * @details Copies for large transfers. Streaming stores keep data written to the ring
+  * from pushing the producer's working set out of cache, prefetching hides the
+  * memory latency on the consumer side. The widest streaming store the CPU has
+  * (AVX-512, AVX2, SSE2) is picked at run time.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.15.0 - Initial version, streaming and prefetch copies with run time dispatch.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <ringBuffer.h>
+
+/* cache line size */
+#define CACHE_LINE 64
+/* how far ahead of the copy to prefetch, in bytes. */
+#define PREFETCH_DIST 1024
+/* bytes copied per prefetch step. */
+#define PREFETCH_STEP 256
+
+/*  private helper functions */
+/*  pick the streaming kernel for this CPU. Run once. */
+void copyInit(void);
+/*  copy with non-temporal stores, nothing better then memcpy. */
+void copyStreamPortable(void *op_dest, void const *ip_src, unsigned long int len);
+/*  copy with software prefetch of the source. */
+void copyPrefetch(void *op_dest, void const *ip_src, unsigned long int len);
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  copy with 16 byte non-temporal stores, every x86-64 has SSE2. */
+void copyStreamSse2(void *op_dest, void const *ip_src, unsigned long int len);
+/*  copy with 32 byte non-temporal stores. */
+void copyStreamAvx2(void *op_dest, void const *ip_src, unsigned long int len);
+/*  copy with 64 byte non-temporal stores. */
+void copyStreamAvx512(void *op_dest, void const *ip_src, unsigned long int len);
+#endif
+
+static pthread_once_t g_copyOnce = PTHREAD_ONCE_INIT;
+static void (*gp_copyStream)(void *op_dest, void const *ip_src, unsigned long int len) = copyStreamPortable;
+
+/*  public  functions */
+/*  copy len bytes with the kernel for mode. */
+void *ringBufferCopy(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int mode)
+{
+  if(!op_dest || !ip_src) return op_dest;
+
+  switch(mode)
+  {
+    case RING_BUFFER_COPY_STREAM:
+      pthread_once(&g_copyOnce, copyInit);
+      gp_copyStream(op_dest, ip_src, len);
+      break;
+    case RING_BUFFER_COPY_PREFETCH:
+      copyPrefetch(op_dest, ip_src, len);
+      break;
+    default:
+      memcpy(op_dest, ip_src, len);
+      break;
+  }
+
+  return op_dest;
+}
+
+/*  help function implimentation */
+/*  widest streaming store the CPU has. */
+void copyInit(void)
+{
+#if defined(__GNUC__) && defined(__x86_64__)
+  __builtin_cpu_init();
+
+  gp_copyStream = copyStreamSse2;
+
+  if(__builtin_cpu_supports("avx2")) gp_copyStream = copyStreamAvx2;
+
+  if(__builtin_cpu_supports("avx512f")) gp_copyStream = copyStreamAvx512;
+#endif
+}
+
+/*  no streaming stores on this target. */
+void copyStreamPortable(void *op_dest, void const *ip_src, unsigned long int len)
+{
+  memcpy(op_dest, ip_src, len);
+}
+
+/*  copy a step at a time, asking for the source a few steps ahead. Ring data is read once, so don't keep it. */
+void copyPrefetch(void *op_dest, void const *ip_src, unsigned long int len)
+{
+  unsigned long int offset = 0;
+  unsigned long int line = 0;
+
+  char *p_dest = (char *)op_dest;
+  char const *p_src = (char const *)ip_src;
+
+  for(offset = 0; offset < PREFETCH_DIST && offset < len; offset += CACHE_LINE)
+  {
+    __builtin_prefetch(p_src + offset, 0, 0);
+  }
+
+  for(offset = 0; offset + PREFETCH_STEP <= len; offset += PREFETCH_STEP)
+  {
+    for(line = 0; line < PREFETCH_STEP; line += CACHE_LINE)
+    {
+      if(offset + PREFETCH_DIST + line < len) __builtin_prefetch(p_src + offset + PREFETCH_DIST + line, 0, 0);
+    }
+
+    memcpy(p_dest + offset, p_src + offset, PREFETCH_STEP);
+  }
+
+  memcpy(p_dest + offset, p_src + offset, len - offset);
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  the destination is aligned with a normal copy of the head, then streamed, the fence makes the stores visible before the index moves. */
+__attribute__((target("sse2")))
+void copyStreamSse2(void *op_dest, void const *ip_src, unsigned long int len)
+{
+  unsigned long int headLen = 0;
+
+  char *p_dest = (char *)op_dest;
+  char const *p_src = (char const *)ip_src;
+
+  headLen = (16 - ((unsigned long int)p_dest & 15)) & 15;
+  headLen = (headLen < len ? headLen : len);
+
+  memcpy(p_dest, p_src, headLen);
+
+  p_dest += headLen;
+  p_src += headLen;
+  len -= headLen;
+
+  for(; len >= 64; len -= 64, p_dest += 64, p_src += 64)
+  {
+    __m128i data0 = _mm_loadu_si128((__m128i const *)p_src);
+    __m128i data1 = _mm_loadu_si128((__m128i const *)(p_src + 16));
+    __m128i data2 = _mm_loadu_si128((__m128i const *)(p_src + 32));
+    __m128i data3 = _mm_loadu_si128((__m128i const *)(p_src + 48));
+
+    _mm_stream_si128((__m128i *)p_dest, data0);
+    _mm_stream_si128((__m128i *)(p_dest + 16), data1);
+    _mm_stream_si128((__m128i *)(p_dest + 32), data2);
+    _mm_stream_si128((__m128i *)(p_dest + 48), data3);
+  }
+
+  _mm_sfence();
+
+  memcpy(p_dest, p_src, len);
+}
+
+/*  same as SSE2, 32 bytes at a time. */
+__attribute__((target("avx2")))
+void copyStreamAvx2(void *op_dest, void const *ip_src, unsigned long int len)
+{
+  unsigned long int headLen = 0;
+
+  char *p_dest = (char *)op_dest;
+  char const *p_src = (char const *)ip_src;
+
+  headLen = (32 - ((unsigned long int)p_dest & 31)) & 31;
+  headLen = (headLen < len ? headLen : len);
+
+  memcpy(p_dest, p_src, headLen);
+
+  p_dest += headLen;
+  p_src += headLen;
+  len -= headLen;
+
+  for(; len >= 128; len -= 128, p_dest += 128, p_src += 128)
+  {
+    __m256i data0 = _mm256_loadu_si256((__m256i const *)p_src);
+    __m256i data1 = _mm256_loadu_si256((__m256i const *)(p_src + 32));
+    __m256i data2 = _mm256_loadu_si256((__m256i const *)(p_src + 64));
+    __m256i data3 = _mm256_loadu_si256((__m256i const *)(p_src + 96));
+
+    _mm256_stream_si256((__m256i *)p_dest, data0);
+    _mm256_stream_si256((__m256i *)(p_dest + 32), data1);
+    _mm256_stream_si256((__m256i *)(p_dest + 64), data2);
+    _mm256_stream_si256((__m256i *)(p_dest + 96), data3);
+  }
+
+  _mm_sfence();
+
+  memcpy(p_dest, p_src, len);
+}
+
+/*  same as SSE2, a whole cache line at a time. */
+__attribute__((target("avx512f")))
+void copyStreamAvx512(void *op_dest, void const *ip_src, unsigned long int len)
+{
+  unsigned long int headLen = 0;
+
+  char *p_dest = (char *)op_dest;
+  char const *p_src = (char const *)ip_src;
+
+  headLen = (64 - ((unsigned long int)p_dest & 63)) & 63;
+  headLen = (headLen < len ? headLen : len);
+
+  memcpy(p_dest, p_src, headLen);
+
+  p_dest += headLen;
+  p_src += headLen;
+  len -= headLen;
+
+  for(; len >= 128; len -= 128, p_dest += 128, p_src += 128)
+  {
+    __m512i data0 = _mm512_loadu_si512((void const *)p_src);
+    __m512i data1 = _mm512_loadu_si512((void const *)(p_src + 64));
+
+    _mm512_stream_si512((void *)p_dest, data0);
+    _mm512_stream_si512((void *)(p_dest + 64), data1);
+  }
+
+  _mm_sfence();
+
+  memcpy(p_dest, p_src, len);
+}
+#endif
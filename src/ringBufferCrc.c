@@ -0,0 +1,219 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer CRC32C
+  * @details CRC32C (Castagnoli) for the ring buffer integrity mode. The kernels can
+  * copy while they checksum so the data is only touched once. SSE4.2 is used
+  * when the CPU has it (checked at run time), ARMv8 CRC when the compiler
+  * targets it, otherwise a portable slice by 8 table.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.14.0 - Initial version, CRC32C kernels with run time dispatch.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
+
+#include <ringBuffer.h>
+
+/* reversed Castagnoli polynomial */
+#define CRC32C_POLY 0x82F63B78UL
+#define CRC32_MASK  0xFFFFFFFFUL
+
+/*  private helper functions */
+/*  pick the kernel for this CPU, and build the tables. Run once. */
+void crc32cInit(void);
+/*  portable kernel, copies to op_dest unless it is NULL. crc is not inverted in or out. */
+unsigned long int crc32cSoftware(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc);
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  SSE4.2 kernel, same as the software one. */
+unsigned long int crc32cSse42(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc);
+#endif
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+/*  ARMv8 CRC kernel, same as the software one. */
+unsigned long int crc32cArm(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc);
+#endif
+
+static pthread_once_t g_crc32cOnce = PTHREAD_ONCE_INIT;
+static unsigned long int (*gp_crc32cKernel)(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc) = crc32cSoftware;
+static unsigned long int g_crc32cTable[8][256];
+
+/*  public  functions */
+/*  checksum only, zlib style so calls can be chained starting from 0. */
+unsigned long int ringBufferCrc32c(unsigned long int crc, void const *ip_data, unsigned long int len)
+{
+  if(!ip_data) return crc;
+
+  pthread_once(&g_crc32cOnce, crc32cInit);
+
+  return ~gp_crc32cKernel(NULL, ip_data, len, ~crc & CRC32_MASK) & CRC32_MASK;
+}
+
+/*  checksum while copying, one pass over the data. */
+unsigned long int ringBufferCrc32cCopy(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc)
+{
+  if(!op_dest || !ip_src) return crc;
+
+  pthread_once(&g_crc32cOnce, crc32cInit);
+
+  return ~gp_crc32cKernel(op_dest, ip_src, len, ~crc & CRC32_MASK) & CRC32_MASK;
+}
+
+/*  help function implimentation */
+/*  tables for slice by 8, then the fastest kernel this CPU has. */
+void crc32cInit(void)
+{
+  unsigned long int index = 0;
+  unsigned long int slice = 0;
+  unsigned long int bit = 0;
+  unsigned long int crc = 0;
+
+  for(index = 0; index < 256; index++)
+  {
+    crc = index;
+
+    for(bit = 0; bit < 8; bit++) crc = (crc & 1 ? (crc >> 1) ^ CRC32C_POLY : crc >> 1);
+
+    g_crc32cTable[0][index] = crc;
+  }
+
+  for(index = 0; index < 256; index++)
+  {
+    for(slice = 1; slice < 8; slice++)
+    {
+      g_crc32cTable[slice][index] = (g_crc32cTable[slice - 1][index] >> 8) ^ g_crc32cTable[0][g_crc32cTable[slice - 1][index] & 0xFF];
+    }
+  }
+
+#if defined(__GNUC__) && defined(__x86_64__)
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("sse4.2")) gp_crc32cKernel = crc32cSse42;
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+  gp_crc32cKernel = crc32cArm;
+#endif
+}
+
+/*  slice by 8, bytes are put together by hand so it works on any byte order. */
+unsigned long int crc32cSoftware(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc)
+{
+  unsigned char const *p_src = (unsigned char const *)ip_src;
+
+  if(op_dest) memcpy(op_dest, ip_src, len);
+
+  while(len >= 8)
+  {
+    crc ^= (unsigned long int)p_src[0] | ((unsigned long int)p_src[1] << 8) | ((unsigned long int)p_src[2] << 16) | ((unsigned long int)p_src[3] << 24);
+
+    crc = g_crc32cTable[7][crc & 0xFF] ^ g_crc32cTable[6][(crc >> 8) & 0xFF] ^ g_crc32cTable[5][(crc >> 16) & 0xFF] ^ g_crc32cTable[4][(crc >> 24) & 0xFF] ^
+          g_crc32cTable[3][p_src[4]] ^ g_crc32cTable[2][p_src[5]] ^ g_crc32cTable[1][p_src[6]] ^ g_crc32cTable[0][p_src[7]];
+
+    p_src += 8;
+    len -= 8;
+  }
+
+  while(len-- > 0) crc = (crc >> 8) ^ g_crc32cTable[0][(crc ^ *p_src++) & 0xFF];
+
+  return crc;
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  8 bytes at a time with the crc32 instruction, the copy uses the same loads. */
+__attribute__((target("sse4.2")))
+unsigned long int crc32cSse42(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc)
+{
+  unsigned long int data = 0;
+
+  unsigned char const *p_src = (unsigned char const *)ip_src;
+  unsigned char *p_dest = (unsigned char *)op_dest;
+
+  while(len >= 8)
+  {
+    memcpy(&data, p_src, 8);
+
+    crc = __builtin_ia32_crc32di(crc, data);
+
+    if(p_dest)
+    {
+      memcpy(p_dest, &data, 8);
+      p_dest += 8;
+    }
+
+    p_src += 8;
+    len -= 8;
+  }
+
+  while(len-- > 0)
+  {
+    if(p_dest) *p_dest++ = *p_src;
+
+    crc = __builtin_ia32_crc32qi((unsigned int)crc, *p_src++);
+  }
+
+  return crc;
+}
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+/*  8 bytes at a time with the crc32c instructions, the copy uses the same loads. */
+unsigned long int crc32cArm(void *op_dest, void const *ip_src, unsigned long int len, unsigned long int crc)
+{
+  unsigned long int data = 0;
+
+  unsigned char const *p_src = (unsigned char const *)ip_src;
+  unsigned char *p_dest = (unsigned char *)op_dest;
+
+  while(len >= 8)
+  {
+    memcpy(&data, p_src, 8);
+
+    crc = __crc32cd((unsigned int)crc, data);
+
+    if(p_dest)
+    {
+      memcpy(p_dest, &data, 8);
+      p_dest += 8;
+    }
+
+    p_src += 8;
+    len -= 8;
+  }
+
+  while(len-- > 0)
+  {
+    if(p_dest) *p_dest++ = *p_src;
+
+    crc = __crc32cb((unsigned int)crc, *p_src++);
+  }
+
+  return crc;
+}
+#endif
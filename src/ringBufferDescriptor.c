@@ -0,0 +1,420 @@
+/***************************************************************************//**
+  * @brief   ansi-C descriptor ring buffer
+  * @details Descriptor ring buffer with a lock-free buffer pool. The free list is a
+  * bounded MPMC queue of buffer indexes (D. Vyukov's design), each cell has a
+  * sequence number that says which lap of the queue it is ready for.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.20.0 - Initial version, descriptor ring with a lock-free buffer pool.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ringBufferDescriptor.h>
+
+#define PROC_SUCC 1
+#define PROC_FAIL 0
+
+/*  private helper functions */
+/*  put a buffer index on the free list, fails only if the list is full. */
+int freeListPush(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, unsigned long int index);
+/*  take a buffer index off of the free list, fails if it is empty. */
+int freeListPop(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, unsigned long int *op_index);
+/*  take a buffer index off of the free list and mark it in use. */
+void *takeBuffer(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors);
+/*  index of a buffer in the pool, numBuffers if it isn't one. */
+unsigned long int bufferIndex(struct s_ringBufferDescriptors const * const ip_ringBufferDescriptors, void *ip_buffer);
+
+/*  public  functions */
+/*  init, buffers in one aligned block, every index on the free list, a ring that can hold all of them. */
+struct s_ringBufferDescriptors *initRingBufferDescriptors(unsigned long int numBuffers, unsigned long int bufferSize)
+{
+  unsigned long int index = 0;
+  unsigned long int numCells = 1;
+
+  pthread_condattr_t condAttr;
+
+  struct s_ringBufferDescriptors *p_tempDescriptors = NULL;
+
+  if(numBuffers <= 0 || bufferSize <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Number and size of buffers must be greater then 0.\n");
+    return NULL;
+  }
+
+  p_tempDescriptors = malloc(sizeof(struct s_ringBufferDescriptors));
+
+  if(!p_tempDescriptors)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate descriptors object.");
+    return NULL;
+  }
+
+  memset(p_tempDescriptors, 0, sizeof(*p_tempDescriptors));
+
+  if(pthread_mutex_init(&p_tempDescriptors->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Descriptors mutex init failed.\n");
+    free(p_tempDescriptors);
+    return NULL;
+  }
+
+  /* acquire deadlines are on CLOCK_MONOTONIC, same as the ring buffer. */
+  if(pthread_condattr_init(&condAttr) || pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC) || pthread_cond_init(&p_tempDescriptors->condition, &condAttr))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Descriptors condition init failed.\n");
+    pthread_mutex_destroy(&p_tempDescriptors->mutex);
+    free(p_tempDescriptors);
+    return NULL;
+  }
+
+  pthread_condattr_destroy(&condAttr);
+
+  while(numCells < numBuffers) numCells <<= 1;
+
+  p_tempDescriptors->bufferSize = bufferSize;
+  p_tempDescriptors->bufferStride = (bufferSize + RING_BUFFER_ALIGN - 1) / RING_BUFFER_ALIGN * RING_BUFFER_ALIGN;
+  p_tempDescriptors->cellMask = numCells - 1;
+  p_tempDescriptors->b_blocking = 1;
+
+  p_tempDescriptors->p_cells = calloc(numCells, sizeof(*p_tempDescriptors->p_cells));
+  p_tempDescriptors->p_inUse = calloc(numBuffers, sizeof(*p_tempDescriptors->p_inUse));
+  p_tempDescriptors->p_ringBuffer = initRingBuffer(numBuffers + 1, sizeof(struct s_ringBufferDescriptor));
+
+  if(posix_memalign(&p_tempDescriptors->p_buffers, RING_BUFFER_ALIGN, numBuffers * p_tempDescriptors->bufferStride)) p_tempDescriptors->p_buffers = NULL;
+
+  if(!p_tempDescriptors->p_cells || !p_tempDescriptors->p_inUse || !p_tempDescriptors->p_ringBuffer || !p_tempDescriptors->p_buffers)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate descriptor buffers.");
+    freeRingBufferDescriptors(&p_tempDescriptors);
+    return NULL;
+  }
+
+  /* a full ring means a descriptor that wasn't from the pool, don't lose one that was. */
+  ringBufferSetOverflowPolicy(p_tempDescriptors->p_ringBuffer, RING_BUFFER_DROP_NEWEST);
+
+  for(index = 0; index < numCells; index++) p_tempDescriptors->p_cells[index].sequence = index;
+
+  p_tempDescriptors->numBuffers = numBuffers;
+
+  for(index = 0; index < numBuffers; index++) freeListPush(p_tempDescriptors, index);
+
+  return p_tempDescriptors;
+}
+
+/*  free the ring, the pool and the object. */
+void freeRingBufferDescriptors(struct s_ringBufferDescriptors **iopp_ringBufferDescriptors)
+{
+  if(!iopp_ringBufferDescriptors) return;
+
+  if(!*iopp_ringBufferDescriptors) return;
+
+  freeRingBuffer(&(*iopp_ringBufferDescriptors)->p_ringBuffer);
+
+  pthread_cond_destroy(&(*iopp_ringBufferDescriptors)->condition);
+  pthread_mutex_destroy(&(*iopp_ringBufferDescriptors)->mutex);
+
+  free((*iopp_ringBufferDescriptors)->p_cells);
+  free((void *)(*iopp_ringBufferDescriptors)->p_inUse);
+  free((*iopp_ringBufferDescriptors)->p_buffers);
+  free(*iopp_ringBufferDescriptors);
+
+  *iopp_ringBufferDescriptors = NULL;
+}
+
+/*  take a buffer, wait on the condition when the pool is empty. */
+void *ringBufferDescriptorsAcquire(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, struct timespec *p_timeToWait)
+{
+  int error = 0;
+
+  void *p_buffer = NULL;
+
+  struct timespec deadline;
+
+  if(!iop_ringBufferDescriptors) return NULL;
+
+  p_buffer = takeBuffer(iop_ringBufferDescriptors);
+
+  if(p_buffer) return p_buffer;
+
+  /* deadline for the whole call, waking up early doesn't restart it. */
+  if(p_timeToWait && !ringBufferDeadline(&deadline, p_timeToWait)) return NULL;
+
+  pthread_mutex_lock(&iop_ringBufferDescriptors->mutex);
+
+  /* counted before the retry, a release that missed the count put its buffer on the list before we look again. */
+  __atomic_add_fetch(&iop_ringBufferDescriptors->waiters, 1, __ATOMIC_SEQ_CST);
+
+  while(!(p_buffer = takeBuffer(iop_ringBufferDescriptors)))
+  {
+    if(!iop_ringBufferDescriptors->b_blocking || error)
+    {
+      __atomic_sub_fetch(&iop_ringBufferDescriptors->waiters, 1, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&iop_ringBufferDescriptors->mutex);
+      return NULL;
+    }
+
+    if(p_timeToWait)
+    {
+      error = pthread_cond_timedwait(&iop_ringBufferDescriptors->condition, &iop_ringBufferDescriptors->mutex, &deadline);
+    }
+    else
+    {
+      error = pthread_cond_wait(&iop_ringBufferDescriptors->condition, &iop_ringBufferDescriptors->mutex);
+    }
+  }
+
+  __atomic_sub_fetch(&iop_ringBufferDescriptors->waiters, 1, __ATOMIC_SEQ_CST);
+
+  pthread_mutex_unlock(&iop_ringBufferDescriptors->mutex);
+
+  return p_buffer;
+}
+
+/*  take a buffer if there is one. */
+void *ringBufferDescriptorsTryAcquire(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors)
+{
+  if(!iop_ringBufferDescriptors) return NULL;
+
+  return takeBuffer(iop_ringBufferDescriptors);
+}
+
+/*  give a buffer back, wake an acquire if one is waiting. */
+int ringBufferDescriptorsRelease(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, void *ip_buffer)
+{
+  unsigned long int index = 0;
+
+  if(!iop_ringBufferDescriptors) return PROC_FAIL;
+
+  index = bufferIndex(iop_ringBufferDescriptors, ip_buffer);
+
+  if(index >= iop_ringBufferDescriptors->numBuffers)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Buffer is not from this pool.\n");
+    return PROC_FAIL;
+  }
+
+  if(!__atomic_exchange_n(&iop_ringBufferDescriptors->p_inUse[index], 0, __ATOMIC_ACQ_REL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Buffer released more then once.\n");
+    return PROC_FAIL;
+  }
+
+  /* list is as long as the pool, with the flag above there is always room. */
+  freeListPush(iop_ringBufferDescriptors, index);
+
+  /* the push and this load are ordered, so either we see the waiter or it sees the buffer. */
+  if(__atomic_load_n(&iop_ringBufferDescriptors->waiters, __ATOMIC_SEQ_CST) > 0)
+  {
+    pthread_mutex_lock(&iop_ringBufferDescriptors->mutex);
+    pthread_cond_signal(&iop_ringBufferDescriptors->condition);
+    pthread_mutex_unlock(&iop_ringBufferDescriptors->mutex);
+  }
+
+  return PROC_SUCC;
+}
+
+/*  only the descriptor goes through the ring. */
+int ringBufferDescriptorsSend(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, void *ip_buffer, unsigned long int len, unsigned long int tag)
+{
+  struct s_ringBufferDescriptor descriptor;
+
+  if(!iop_ringBufferDescriptors) return PROC_FAIL;
+
+  if(bufferIndex(iop_ringBufferDescriptors, ip_buffer) >= iop_ringBufferDescriptors->numBuffers)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Buffer is not from this pool.\n");
+    return PROC_FAIL;
+  }
+
+  if(len > iop_ringBufferDescriptors->bufferSize)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Length %lu is larger then the buffer.\n", len);
+    return PROC_FAIL;
+  }
+
+  descriptor.p_data = ip_buffer;
+  descriptor.len = len;
+  descriptor.tag = tag;
+
+  /* the ring holds every buffer in the pool, this never has to wait. */
+  return (ringBufferWrite(iop_ringBufferDescriptors->p_ringBuffer, &descriptor, 1) == 1 ? PROC_SUCC : PROC_FAIL);
+}
+
+/*  wait for a descriptor. */
+int ringBufferDescriptorsReceive(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, struct s_ringBufferDescriptor *op_descriptor, struct timespec *p_timeToWait)
+{
+  if(!iop_ringBufferDescriptors) return PROC_FAIL;
+
+  if(!op_descriptor)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output descriptor is NULL.\n");
+    return PROC_FAIL;
+  }
+
+  return (ringBufferBlockingRead(iop_ringBufferDescriptors->p_ringBuffer, op_descriptor, 1, p_timeToWait) == 1 ? PROC_SUCC : PROC_FAIL);
+}
+
+/*  descriptors left, or still blocking? */
+unsigned long int ringBufferDescriptorsIsAlive(struct s_ringBufferDescriptors * const ip_ringBufferDescriptors)
+{
+  if(!ip_ringBufferDescriptors) return ERROR_NULL;
+
+  return ringBufferIsAlive(ip_ringBufferDescriptors->p_ringBuffer);
+}
+
+/*  end the ring, and wake anyone waiting on the pool. */
+void ringBufferDescriptorsEndBlocking(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors)
+{
+  if(!iop_ringBufferDescriptors) return;
+
+  ringBufferEndBlocking(iop_ringBufferDescriptors->p_ringBuffer);
+
+  pthread_mutex_lock(&iop_ringBufferDescriptors->mutex);
+
+  iop_ringBufferDescriptors->b_blocking = 0;
+
+  pthread_cond_broadcast(&iop_ringBufferDescriptors->condition);
+  pthread_mutex_unlock(&iop_ringBufferDescriptors->mutex);
+}
+
+/*  help function implimentation */
+/*  claim the cell at enqueuePos if it is on this lap, then publish the index with its sequence. */
+int freeListPush(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, unsigned long int index)
+{
+  long int diff = 0;
+
+  unsigned long int pos = 0;
+  unsigned long int sequence = 0;
+
+  struct s_ringBufferFreeCell *p_cell = NULL;
+
+  pos = __atomic_load_n(&iop_ringBufferDescriptors->enqueuePos, __ATOMIC_RELAXED);
+
+  for(;;)
+  {
+    p_cell = &iop_ringBufferDescriptors->p_cells[pos & iop_ringBufferDescriptors->cellMask];
+
+    sequence = __atomic_load_n(&p_cell->sequence, __ATOMIC_ACQUIRE);
+
+    diff = (long int)sequence - (long int)pos;
+
+    if(diff == 0)
+    {
+      if(__atomic_compare_exchange_n(&iop_ringBufferDescriptors->enqueuePos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+    }
+    else if(diff < 0)
+    {
+      /* still holds an index from the last lap, full. */
+      return PROC_FAIL;
+    }
+    else
+    {
+      pos = __atomic_load_n(&iop_ringBufferDescriptors->enqueuePos, __ATOMIC_RELAXED);
+    }
+  }
+
+  p_cell->index = index;
+
+  __atomic_store_n(&p_cell->sequence, pos + 1, __ATOMIC_SEQ_CST);
+
+  return PROC_SUCC;
+}
+
+/*  claim the cell at dequeuePos if it has been published, then hand it to the next lap. */
+int freeListPop(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors, unsigned long int *op_index)
+{
+  long int diff = 0;
+
+  unsigned long int pos = 0;
+  unsigned long int sequence = 0;
+
+  struct s_ringBufferFreeCell *p_cell = NULL;
+
+  pos = __atomic_load_n(&iop_ringBufferDescriptors->dequeuePos, __ATOMIC_RELAXED);
+
+  for(;;)
+  {
+    p_cell = &iop_ringBufferDescriptors->p_cells[pos & iop_ringBufferDescriptors->cellMask];
+
+    sequence = __atomic_load_n(&p_cell->sequence, __ATOMIC_SEQ_CST);
+
+    diff = (long int)sequence - (long int)(pos + 1);
+
+    if(diff == 0)
+    {
+      if(__atomic_compare_exchange_n(&iop_ringBufferDescriptors->dequeuePos, &pos, pos + 1, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+    }
+    else if(diff < 0)
+    {
+      /* nothing published here yet, empty. */
+      return PROC_FAIL;
+    }
+    else
+    {
+      pos = __atomic_load_n(&iop_ringBufferDescriptors->dequeuePos, __ATOMIC_RELAXED);
+    }
+  }
+
+  *op_index = p_cell->index;
+
+  __atomic_store_n(&p_cell->sequence, pos + iop_ringBufferDescriptors->cellMask + 1, __ATOMIC_RELEASE);
+
+  return PROC_SUCC;
+}
+
+/*  pop an index, the flag catches a buffer released twice. */
+void *takeBuffer(struct s_ringBufferDescriptors * const iop_ringBufferDescriptors)
+{
+  unsigned long int index = 0;
+
+  if(!freeListPop(iop_ringBufferDescriptors, &index)) return NULL;
+
+  __atomic_store_n(&iop_ringBufferDescriptors->p_inUse[index], 1, __ATOMIC_RELAXED);
+
+  return ((char *)iop_ringBufferDescriptors->p_buffers) + (index * iop_ringBufferDescriptors->bufferStride);
+}
+
+/*  buffers are bufferStride apart from the start of the block. */
+unsigned long int bufferIndex(struct s_ringBufferDescriptors const * const ip_ringBufferDescriptors, void *ip_buffer)
+{
+  unsigned long int offset = 0;
+
+  if(!ip_buffer || (char *)ip_buffer < (char *)ip_ringBufferDescriptors->p_buffers) return ip_ringBufferDescriptors->numBuffers;
+
+  offset = (unsigned long int)((char *)ip_buffer - (char *)ip_ringBufferDescriptors->p_buffers);
+
+  if(offset % ip_ringBufferDescriptors->bufferStride) return ip_ringBufferDescriptors->numBuffers;
+
+  offset /= ip_ringBufferDescriptors->bufferStride;
+
+  return (offset < ip_ringBufferDescriptors->numBuffers ? offset : ip_ringBufferDescriptors->numBuffers);
+}
@@ -0,0 +1,321 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer group
+  * @details Group of ring buffers, one shard per CPU or per lane. Producers write
+  * to their own shard so they never contend with producers on other cores.
+  * Consumers drain the shards they own first, and steal from the rest when
+  * they run dry. All functions return the number of elements.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.10.0 - Initial version, sharded ring buffer groups with work stealing.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#ifdef __linux__
+#define _GNU_SOURCE
+#include <sched.h>
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ringBufferGroup.h>
+
+/* counters are shared by every consumer that touches a shard. */
+#if defined(__GNUC__)
+#define COUNTER_ADD(p, v) __sync_fetch_and_add(p, v)
+#else
+#define COUNTER_ADD(p, v) (*(p) += (v))
+#endif
+
+/*  private helper functions */
+/*  read from the shards owned by the consumer, or the ones it does not own. */
+unsigned long int groupReadShards(struct s_ringBufferGroup * const iop_ringBufferGroup, unsigned long int consumer, unsigned long int b_owned, char *op_buffer, unsigned long int len);
+
+/*  public  functions */
+/*  init, one ring buffer per shard, all in one wait set for idle consumers. */
+struct s_ringBufferGroup *initRingBufferGroup(unsigned long int numShards, unsigned long int numConsumers, unsigned long int const buffSize, unsigned long int const elementSize)
+{
+  unsigned long int index = 0;
+
+  struct s_ringBufferGroup *p_tempGroup = NULL;
+
+  if(numShards <= 0)
+  {
+    long numCpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+    numShards = (numCpu > 0 ? (unsigned long int)numCpu : 1);
+  }
+
+  if(numConsumers <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Number of consumers must be greater then 0.\n");
+    return NULL;
+  }
+
+  p_tempGroup = malloc(sizeof(struct s_ringBufferGroup));
+
+  if(!p_tempGroup)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate group object.");
+    return NULL;
+  }
+
+  memset(p_tempGroup, 0, sizeof(*p_tempGroup));
+
+  p_tempGroup->numConsumers = numConsumers;
+
+  p_tempGroup->p_shards = malloc(numShards * sizeof(*p_tempGroup->p_shards));
+
+  if(!p_tempGroup->p_shards)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate group shards.");
+    freeRingBufferGroup(&p_tempGroup);
+    return NULL;
+  }
+
+  memset(p_tempGroup->p_shards, 0, numShards * sizeof(*p_tempGroup->p_shards));
+
+  p_tempGroup->p_waitSet = initRingBufferWaitSet();
+
+  if(!p_tempGroup->p_waitSet)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Group Failed.\n");
+    freeRingBufferGroup(&p_tempGroup);
+    return NULL;
+  }
+
+  for(index = 0; index < numShards; index++)
+  {
+    p_tempGroup->p_shards[index].p_ringBuffer = initRingBuffer(buffSize, elementSize);
+
+    /* count what is there so free cleans up the right number */
+    if(p_tempGroup->p_shards[index].p_ringBuffer) p_tempGroup->numShards++;
+
+    if(!p_tempGroup->p_shards[index].p_ringBuffer || !ringBufferWaitSetAdd(p_tempGroup->p_waitSet, p_tempGroup->p_shards[index].p_ringBuffer, RING_BUFFER_WAIT_READ, NULL))
+    {
+      fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Group Failed.\n");
+      freeRingBufferGroup(&p_tempGroup);
+      return NULL;
+    }
+  }
+
+  return p_tempGroup;
+}
+
+/*  free every shard, then the group. */
+void freeRingBufferGroup(struct s_ringBufferGroup **iopp_ringBufferGroup)
+{
+  unsigned long int index = 0;
+
+  if(!iopp_ringBufferGroup) return;
+
+  if(!*iopp_ringBufferGroup) return;
+
+  freeRingBufferWaitSet(&(*iopp_ringBufferGroup)->p_waitSet);
+
+  for(index = 0; index < (*iopp_ringBufferGroup)->numShards; index++)
+  {
+    freeRingBuffer(&(*iopp_ringBufferGroup)->p_shards[index].p_ringBuffer);
+  }
+
+  free((*iopp_ringBufferGroup)->p_shards);
+  free(*iopp_ringBufferGroup);
+
+  *iopp_ringBufferGroup = NULL;
+}
+
+/*  which shard is local to this thread? The CPU we are on if we can find out. */
+unsigned long int ringBufferGroupLocalShard(struct s_ringBufferGroup const * const ip_ringBufferGroup)
+{
+  int cpu = 0;
+
+  if(!ip_ringBufferGroup) return 0;
+
+#ifdef __linux__
+  cpu = sched_getcpu();
+#endif
+
+  return (cpu > 0 ? (unsigned long int)cpu : 0) % ip_ringBufferGroup->numShards;
+}
+
+/*  write to one shard, same as a blocking write. */
+unsigned long int ringBufferGroupWrite(struct s_ringBufferGroup * const iop_ringBufferGroup, unsigned long int shard, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait)
+{
+  unsigned long int totalWrote = 0;
+
+  struct s_ringBufferGroupShard *p_shard = NULL;
+
+  if(!iop_ringBufferGroup) return 0;
+
+  p_shard = &iop_ringBufferGroup->p_shards[shard % iop_ringBufferGroup->numShards];
+
+  totalWrote = ringBufferBlockingWrite(p_shard->p_ringBuffer, ip_buffer, len, p_timeToWait);
+
+  COUNTER_ADD(&p_shard->wrote, totalWrote);
+
+  return totalWrote;
+}
+
+/*  read from owned shards, then steal, then wait on all of them. */
+unsigned long int ringBufferGroupRead(struct s_ringBufferGroup * const iop_ringBufferGroup, unsigned long int consumer, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait)
+{
+  unsigned long int totalRead = 0;
+
+  struct timespec deadline;
+  struct s_ringBufferReady ready;
+
+  if(!iop_ringBufferGroup) return 0;
+
+  /* deadline for the whole call, looping doesn't restart the timeout. */
+  if(p_timeToWait && !ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  if(len <= 0) return totalRead;
+
+  consumer %= iop_ringBufferGroup->numConsumers;
+
+  for(;;)
+  {
+    totalRead = groupReadShards(iop_ringBufferGroup, consumer, 1, op_buffer, len);
+
+    if(totalRead > 0) return totalRead;
+
+    totalRead = groupReadShards(iop_ringBufferGroup, consumer, 0, op_buffer, len);
+
+    if(totalRead > 0) return totalRead;
+
+    if(!ringBufferGroupIsAlive(iop_ringBufferGroup)) return 0;
+
+    /* all empty, wait till a shard has something. Someone else may get to it first, so loop. */
+    if(!ringBufferWaitAnyUntil(iop_ringBufferGroup->p_waitSet, &ready, 1, (p_timeToWait ? &deadline : NULL))) return 0;
+
+    /* an ended shard is always ready, once it is empty stop waiting on it. The last one stays, so a consumer that waits late still wakes. */
+    if(!ringBufferIsAlive(ready.p_ringBuffer) && ringBufferGroupIsAlive(iop_ringBufferGroup)) ringBufferWaitSetRemove(iop_ringBufferGroup->p_waitSet, ready.p_ringBuffer);
+  }
+}
+
+/*  any shard still blocking or holding data? */
+unsigned long int ringBufferGroupIsAlive(struct s_ringBufferGroup * const ip_ringBufferGroup)
+{
+  unsigned long int index = 0;
+
+  if(!ip_ringBufferGroup) return ERROR_NULL;
+
+  for(index = 0; index < ip_ringBufferGroup->numShards; index++)
+  {
+    if(ringBufferIsAlive(ip_ringBufferGroup->p_shards[index].p_ringBuffer)) return 1;
+  }
+
+  return 0;
+}
+
+/*  add up the shard counters. */
+void ringBufferGroupGetStats(struct s_ringBufferGroup * const ip_ringBufferGroup, struct s_ringBufferGroupStats *op_stats)
+{
+  unsigned long int index = 0;
+
+  if(!ip_ringBufferGroup) return;
+
+  if(!op_stats) return;
+
+  memset(op_stats, 0, sizeof(*op_stats));
+
+  for(index = 0; index < ip_ringBufferGroup->numShards; index++)
+  {
+    struct s_ringBufferGroupShard *p_shard = &ip_ringBufferGroup->p_shards[index];
+
+    op_stats->wrote += p_shard->wrote;
+    op_stats->read += p_shard->read + p_shard->stolen;
+    op_stats->stolen += p_shard->stolen;
+    op_stats->readSize += getRingBufferReadSize(p_shard->p_ringBuffer);
+    op_stats->size += getRingBufferSize(p_shard->p_ringBuffer);
+  }
+}
+
+/*  end blocking on every shard. */
+void ringBufferGroupEndBlocking(struct s_ringBufferGroup * const iop_ringBufferGroup)
+{
+  unsigned long int index = 0;
+
+  if(!iop_ringBufferGroup) return;
+
+  for(index = 0; index < iop_ringBufferGroup->numShards; index++)
+  {
+    ringBufferEndBlocking(iop_ringBufferGroup->p_shards[index].p_ringBuffer);
+  }
+
+  /* every idle consumer has to wake up and see the group is done, not just one. */
+  pthread_mutex_lock(&iop_ringBufferGroup->p_waitSet->mutex);
+
+  pthread_cond_broadcast(&iop_ringBufferGroup->p_waitSet->condition);
+
+  pthread_mutex_unlock(&iop_ringBufferGroup->p_waitSet->mutex);
+}
+
+/*  help function implimentation */
+/*  non-blocking read from either the shards we own or the ones we don't, filling as much of the buffer as we can. */
+unsigned long int groupReadShards(struct s_ringBufferGroup * const iop_ringBufferGroup, unsigned long int consumer, unsigned long int b_owned, char *op_buffer, unsigned long int len)
+{
+  unsigned long int totalRead = 0;
+  unsigned long int read = 0;
+  unsigned long int index = 0;
+  unsigned long int count = 0;
+
+  struct s_ringBufferGroupShard *p_shard = NULL;
+
+  /* start after our own shard so stealing consumers spread out. */
+  for(count = 0; count < iop_ringBufferGroup->numShards && totalRead < len; count++)
+  {
+    index = (consumer + count) % iop_ringBufferGroup->numShards;
+
+    if((index % iop_ringBufferGroup->numConsumers == consumer) != (b_owned != 0)) continue;
+
+    p_shard = &iop_ringBufferGroup->p_shards[index];
+
+    read = ringBufferRead(p_shard->p_ringBuffer, op_buffer + (totalRead * getRingBufferElementSize(p_shard->p_ringBuffer)), len - totalRead);
+
+    if(read <= 0) continue;
+
+    if(b_owned)
+    {
+      COUNTER_ADD(&p_shard->read, read);
+    }
+    else
+    {
+      COUNTER_ADD(&p_shard->stolen, read);
+    }
+
+    totalRead += read;
+  }
+
+  return totalRead;
+}
@@ -0,0 +1,563 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer interleave
+  * @details Interleave and deinterleave kernels for the planar read and write.
+  * 2, 4 and 8 channels of 16 or 32 bit samples are shuffled in SSE2 registers on
+  * x86-64 (NEON loads and stores for 2 and 4 on aarch64), everything else is
+  * moved a sample at a time.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.23.0 - Initial version, interleave and deinterleave kernels.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include <ringBuffer.h>
+
+/*  private helper functions */
+/*  deinterleave a sample at a time, any channel count or sample size. */
+void deinterleaveGeneric(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+/*  interleave a sample at a time, any channel count or sample size. */
+void interleaveGeneric(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  deinterleave with SSE2 shuffles, returns the frames done, the caller does the rest. */
+unsigned long int deinterleaveSse2(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+/*  interleave with SSE2 shuffles, returns the frames done, the caller does the rest. */
+unsigned long int interleaveSse2(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+/*  transpose 8 rows of 8 16 bit samples, in place. */
+void transpose8x16Sse2(__m128i *iop_rows);
+#endif
+#if defined(__GNUC__) && defined(__aarch64__)
+/*  deinterleave with NEON structure loads, returns the frames done. */
+unsigned long int deinterleaveNeon(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+/*  interleave with NEON structure stores, returns the frames done. */
+unsigned long int interleaveNeon(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize);
+#endif
+
+/*  public  functions */
+/*  frames of interleaved samples out to one array per channel. */
+void ringBufferDeinterleave(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int done = 0;
+
+  if(!op_channels || !ip_src) return;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+  done = deinterleaveSse2(op_channels, offset, ip_src, frames, numChannels, sampleSize);
+#endif
+#if defined(__GNUC__) && defined(__aarch64__)
+  done = deinterleaveNeon(op_channels, offset, ip_src, frames, numChannels, sampleSize);
+#endif
+
+  if(done >= frames) return;
+
+  /* the kernels only do whole vectors, or nothing for other layouts. */
+  deinterleaveGeneric(op_channels, offset + done, ((char const *)ip_src) + (done * numChannels * sampleSize), frames - done, numChannels, sampleSize);
+}
+
+/*  one array per channel into frames of interleaved samples. */
+void ringBufferInterleave(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int done = 0;
+
+  if(!op_dest || !ip_channels) return;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+  done = interleaveSse2(op_dest, ip_channels, offset, frames, numChannels, sampleSize);
+#endif
+#if defined(__GNUC__) && defined(__aarch64__)
+  done = interleaveNeon(op_dest, ip_channels, offset, frames, numChannels, sampleSize);
+#endif
+
+  if(done >= frames) return;
+
+  interleaveGeneric(((char *)op_dest) + (done * numChannels * sampleSize), ip_channels, offset + done, frames - done, numChannels, sampleSize);
+}
+
+/*  help function implimentation */
+/*  typed copies for the usual sizes, memcpy for the rest. */
+void deinterleaveGeneric(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int frame = 0;
+  unsigned long int channel = 0;
+
+  char const *p_src = (char const *)ip_src;
+
+  for(channel = 0; channel < numChannels; channel++)
+  {
+    char *p_dest = ((char *)op_channels[channel]) + (offset * sampleSize);
+    char const *p_sample = p_src + (channel * sampleSize);
+
+    switch(sampleSize)
+    {
+      case 2:
+        for(frame = 0; frame < frames; frame++, p_sample += numChannels * 2) ((short int *)p_dest)[frame] = *(short int const *)p_sample;
+        break;
+      case 4:
+        for(frame = 0; frame < frames; frame++, p_sample += numChannels * 4) ((int *)p_dest)[frame] = *(int const *)p_sample;
+        break;
+      default:
+        for(frame = 0; frame < frames; frame++, p_sample += numChannels * sampleSize) memcpy(p_dest + (frame * sampleSize), p_sample, sampleSize);
+        break;
+    }
+  }
+}
+
+/*  typed copies for the usual sizes, memcpy for the rest. */
+void interleaveGeneric(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int frame = 0;
+  unsigned long int channel = 0;
+
+  char *p_dest = (char *)op_dest;
+
+  for(channel = 0; channel < numChannels; channel++)
+  {
+    char const *p_src = ((char const *)ip_channels[channel]) + (offset * sampleSize);
+    char *p_sample = p_dest + (channel * sampleSize);
+
+    switch(sampleSize)
+    {
+      case 2:
+        for(frame = 0; frame < frames; frame++, p_sample += numChannels * 2) *(short int *)p_sample = ((short int const *)p_src)[frame];
+        break;
+      case 4:
+        for(frame = 0; frame < frames; frame++, p_sample += numChannels * 4) *(int *)p_sample = ((int const *)p_src)[frame];
+        break;
+      default:
+        for(frame = 0; frame < frames; frame++, p_sample += numChannels * sampleSize) memcpy(p_sample, p_src + (frame * sampleSize), sampleSize);
+        break;
+    }
+  }
+}
+
+#if defined(__GNUC__) && defined(__x86_64__)
+/*  16 bit: 2 channels is a shuffle per register, 4 and 8 unpack like a transpose. 32 bit: 2 channels is shufps, 4 and 8 are 4x4 transposes. */
+__attribute__((target("sse2")))
+unsigned long int deinterleaveSse2(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int frame = 0;
+  unsigned long int channel = 0;
+
+  char const *p_src = (char const *)ip_src;
+
+  __m128i rows[8];
+
+  if(sampleSize == 2 && numChannels == 2)
+  {
+    short int *p_left = ((short int *)op_channels[0]) + offset;
+    short int *p_right = ((short int *)op_channels[1]) + offset;
+
+    for(frame = 0; frame + 8 <= frames; frame += 8, p_src += 32)
+    {
+      /* LRLRLRLR -> LLLLRRRR in each register. */
+      __m128i low = _mm_loadu_si128((__m128i const *)p_src);
+      __m128i high = _mm_loadu_si128((__m128i const *)(p_src + 16));
+
+      low = _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_shufflelo_epi16(low, 0xD8), 0xD8), 0xD8);
+      high = _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_shufflelo_epi16(high, 0xD8), 0xD8), 0xD8);
+
+      _mm_storeu_si128((__m128i *)(p_left + frame), _mm_unpacklo_epi64(low, high));
+      _mm_storeu_si128((__m128i *)(p_right + frame), _mm_unpackhi_epi64(low, high));
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 2 && numChannels == 4)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8, p_src += 64)
+    {
+      __m128i in0 = _mm_loadu_si128((__m128i const *)p_src);
+      __m128i in1 = _mm_loadu_si128((__m128i const *)(p_src + 16));
+      __m128i in2 = _mm_loadu_si128((__m128i const *)(p_src + 32));
+      __m128i in3 = _mm_loadu_si128((__m128i const *)(p_src + 48));
+
+      /* two rounds of unpack give channels 0,1 and 2,3 of 4 frames in each register. */
+      __m128i mix0 = _mm_unpacklo_epi16(in0, in1);
+      __m128i mix1 = _mm_unpackhi_epi16(in0, in1);
+      __m128i mix2 = _mm_unpacklo_epi16(in2, in3);
+      __m128i mix3 = _mm_unpackhi_epi16(in2, in3);
+
+      __m128i ab0 = _mm_unpacklo_epi16(mix0, mix1);
+      __m128i cd0 = _mm_unpackhi_epi16(mix0, mix1);
+      __m128i ab1 = _mm_unpacklo_epi16(mix2, mix3);
+      __m128i cd1 = _mm_unpackhi_epi16(mix2, mix3);
+
+      _mm_storeu_si128((__m128i *)(((short int *)op_channels[0]) + offset + frame), _mm_unpacklo_epi64(ab0, ab1));
+      _mm_storeu_si128((__m128i *)(((short int *)op_channels[1]) + offset + frame), _mm_unpackhi_epi64(ab0, ab1));
+      _mm_storeu_si128((__m128i *)(((short int *)op_channels[2]) + offset + frame), _mm_unpacklo_epi64(cd0, cd1));
+      _mm_storeu_si128((__m128i *)(((short int *)op_channels[3]) + offset + frame), _mm_unpackhi_epi64(cd0, cd1));
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 2 && numChannels == 8)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8, p_src += 128)
+    {
+      for(channel = 0; channel < 8; channel++) rows[channel] = _mm_loadu_si128((__m128i const *)(p_src + (channel * 16)));
+
+      transpose8x16Sse2(rows);
+
+      for(channel = 0; channel < 8; channel++) _mm_storeu_si128((__m128i *)(((short int *)op_channels[channel]) + offset + frame), rows[channel]);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && numChannels == 2)
+  {
+    float *p_left = ((float *)op_channels[0]) + offset;
+    float *p_right = ((float *)op_channels[1]) + offset;
+
+    for(frame = 0; frame + 4 <= frames; frame += 4, p_src += 32)
+    {
+      __m128 low = _mm_loadu_ps((float const *)p_src);
+      __m128 high = _mm_loadu_ps((float const *)(p_src + 16));
+
+      _mm_storeu_ps(p_left + frame, _mm_shuffle_ps(low, high, 0x88));
+      _mm_storeu_ps(p_right + frame, _mm_shuffle_ps(low, high, 0xDD));
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && (numChannels == 4 || numChannels == 8))
+  {
+    /* 8 channels is two 4x4 blocks side by side. */
+    for(frame = 0; frame + 4 <= frames; frame += 4, p_src += numChannels * 16)
+    {
+      for(channel = 0; channel < numChannels; channel += 4)
+      {
+        __m128 row0 = _mm_loadu_ps((float const *)(p_src + (channel * 4)));
+        __m128 row1 = _mm_loadu_ps((float const *)(p_src + (numChannels * 4) + (channel * 4)));
+        __m128 row2 = _mm_loadu_ps((float const *)(p_src + (numChannels * 8) + (channel * 4)));
+        __m128 row3 = _mm_loadu_ps((float const *)(p_src + (numChannels * 12) + (channel * 4)));
+
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+        _mm_storeu_ps(((float *)op_channels[channel]) + offset + frame, row0);
+        _mm_storeu_ps(((float *)op_channels[channel + 1]) + offset + frame, row1);
+        _mm_storeu_ps(((float *)op_channels[channel + 2]) + offset + frame, row2);
+        _mm_storeu_ps(((float *)op_channels[channel + 3]) + offset + frame, row3);
+      }
+    }
+
+    return frame;
+  }
+
+  return 0;
+}
+
+/*  the reverse of deinterleaveSse2, transposes are their own inverse. */
+__attribute__((target("sse2")))
+unsigned long int interleaveSse2(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int frame = 0;
+  unsigned long int channel = 0;
+
+  char *p_dest = (char *)op_dest;
+
+  __m128i rows[8];
+
+  if(sampleSize == 2 && numChannels == 2)
+  {
+    short int const *p_left = ((short int const *)ip_channels[0]) + offset;
+    short int const *p_right = ((short int const *)ip_channels[1]) + offset;
+
+    for(frame = 0; frame + 8 <= frames; frame += 8, p_dest += 32)
+    {
+      __m128i left = _mm_loadu_si128((__m128i const *)(p_left + frame));
+      __m128i right = _mm_loadu_si128((__m128i const *)(p_right + frame));
+
+      _mm_storeu_si128((__m128i *)p_dest, _mm_unpacklo_epi16(left, right));
+      _mm_storeu_si128((__m128i *)(p_dest + 16), _mm_unpackhi_epi16(left, right));
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 2 && numChannels == 4)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8, p_dest += 64)
+    {
+      __m128i chan0 = _mm_loadu_si128((__m128i const *)(((short int const *)ip_channels[0]) + offset + frame));
+      __m128i chan1 = _mm_loadu_si128((__m128i const *)(((short int const *)ip_channels[1]) + offset + frame));
+      __m128i chan2 = _mm_loadu_si128((__m128i const *)(((short int const *)ip_channels[2]) + offset + frame));
+      __m128i chan3 = _mm_loadu_si128((__m128i const *)(((short int const *)ip_channels[3]) + offset + frame));
+
+      __m128i ab0 = _mm_unpacklo_epi16(chan0, chan1);
+      __m128i ab1 = _mm_unpackhi_epi16(chan0, chan1);
+      __m128i cd0 = _mm_unpacklo_epi16(chan2, chan3);
+      __m128i cd1 = _mm_unpackhi_epi16(chan2, chan3);
+
+      _mm_storeu_si128((__m128i *)p_dest, _mm_unpacklo_epi32(ab0, cd0));
+      _mm_storeu_si128((__m128i *)(p_dest + 16), _mm_unpackhi_epi32(ab0, cd0));
+      _mm_storeu_si128((__m128i *)(p_dest + 32), _mm_unpacklo_epi32(ab1, cd1));
+      _mm_storeu_si128((__m128i *)(p_dest + 48), _mm_unpackhi_epi32(ab1, cd1));
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 2 && numChannels == 8)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8, p_dest += 128)
+    {
+      for(channel = 0; channel < 8; channel++) rows[channel] = _mm_loadu_si128((__m128i const *)(((short int const *)ip_channels[channel]) + offset + frame));
+
+      transpose8x16Sse2(rows);
+
+      for(channel = 0; channel < 8; channel++) _mm_storeu_si128((__m128i *)(p_dest + (channel * 16)), rows[channel]);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && numChannels == 2)
+  {
+    float const *p_left = ((float const *)ip_channels[0]) + offset;
+    float const *p_right = ((float const *)ip_channels[1]) + offset;
+
+    for(frame = 0; frame + 4 <= frames; frame += 4, p_dest += 32)
+    {
+      __m128 left = _mm_loadu_ps(p_left + frame);
+      __m128 right = _mm_loadu_ps(p_right + frame);
+
+      _mm_storeu_ps((float *)p_dest, _mm_unpacklo_ps(left, right));
+      _mm_storeu_ps((float *)(p_dest + 16), _mm_unpackhi_ps(left, right));
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && (numChannels == 4 || numChannels == 8))
+  {
+    for(frame = 0; frame + 4 <= frames; frame += 4, p_dest += numChannels * 16)
+    {
+      for(channel = 0; channel < numChannels; channel += 4)
+      {
+        __m128 row0 = _mm_loadu_ps(((float const *)ip_channels[channel]) + offset + frame);
+        __m128 row1 = _mm_loadu_ps(((float const *)ip_channels[channel + 1]) + offset + frame);
+        __m128 row2 = _mm_loadu_ps(((float const *)ip_channels[channel + 2]) + offset + frame);
+        __m128 row3 = _mm_loadu_ps(((float const *)ip_channels[channel + 3]) + offset + frame);
+
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+        _mm_storeu_ps((float *)(p_dest + (channel * 4)), row0);
+        _mm_storeu_ps((float *)(p_dest + (numChannels * 4) + (channel * 4)), row1);
+        _mm_storeu_ps((float *)(p_dest + (numChannels * 8) + (channel * 4)), row2);
+        _mm_storeu_ps((float *)(p_dest + (numChannels * 12) + (channel * 4)), row3);
+      }
+    }
+
+    return frame;
+  }
+
+  return 0;
+}
+
+/*  16, 32, then 64 bit unpacks. */
+__attribute__((target("sse2")))
+void transpose8x16Sse2(__m128i *iop_rows)
+{
+  __m128i pair0 = _mm_unpacklo_epi16(iop_rows[0], iop_rows[1]);
+  __m128i pair1 = _mm_unpackhi_epi16(iop_rows[0], iop_rows[1]);
+  __m128i pair2 = _mm_unpacklo_epi16(iop_rows[2], iop_rows[3]);
+  __m128i pair3 = _mm_unpackhi_epi16(iop_rows[2], iop_rows[3]);
+  __m128i pair4 = _mm_unpacklo_epi16(iop_rows[4], iop_rows[5]);
+  __m128i pair5 = _mm_unpackhi_epi16(iop_rows[4], iop_rows[5]);
+  __m128i pair6 = _mm_unpacklo_epi16(iop_rows[6], iop_rows[7]);
+  __m128i pair7 = _mm_unpackhi_epi16(iop_rows[6], iop_rows[7]);
+
+  __m128i quad0 = _mm_unpacklo_epi32(pair0, pair2);
+  __m128i quad1 = _mm_unpackhi_epi32(pair0, pair2);
+  __m128i quad2 = _mm_unpacklo_epi32(pair1, pair3);
+  __m128i quad3 = _mm_unpackhi_epi32(pair1, pair3);
+  __m128i quad4 = _mm_unpacklo_epi32(pair4, pair6);
+  __m128i quad5 = _mm_unpackhi_epi32(pair4, pair6);
+  __m128i quad6 = _mm_unpacklo_epi32(pair5, pair7);
+  __m128i quad7 = _mm_unpackhi_epi32(pair5, pair7);
+
+  iop_rows[0] = _mm_unpacklo_epi64(quad0, quad4);
+  iop_rows[1] = _mm_unpackhi_epi64(quad0, quad4);
+  iop_rows[2] = _mm_unpacklo_epi64(quad1, quad5);
+  iop_rows[3] = _mm_unpackhi_epi64(quad1, quad5);
+  iop_rows[4] = _mm_unpacklo_epi64(quad2, quad6);
+  iop_rows[5] = _mm_unpackhi_epi64(quad2, quad6);
+  iop_rows[6] = _mm_unpacklo_epi64(quad3, quad7);
+  iop_rows[7] = _mm_unpackhi_epi64(quad3, quad7);
+}
+#endif
+
+#if defined(__GNUC__) && defined(__aarch64__)
+/*  vld2/vld4 split the channels as they load. */
+unsigned long int deinterleaveNeon(void * const *op_channels, unsigned long int offset, void const *ip_src, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int frame = 0;
+
+  if(sampleSize == 2 && numChannels == 2)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8)
+    {
+      int16x8x2_t data = vld2q_s16(((short int const *)ip_src) + (frame * 2));
+
+      vst1q_s16(((short int *)op_channels[0]) + offset + frame, data.val[0]);
+      vst1q_s16(((short int *)op_channels[1]) + offset + frame, data.val[1]);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 2 && numChannels == 4)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8)
+    {
+      int16x8x4_t data = vld4q_s16(((short int const *)ip_src) + (frame * 4));
+
+      vst1q_s16(((short int *)op_channels[0]) + offset + frame, data.val[0]);
+      vst1q_s16(((short int *)op_channels[1]) + offset + frame, data.val[1]);
+      vst1q_s16(((short int *)op_channels[2]) + offset + frame, data.val[2]);
+      vst1q_s16(((short int *)op_channels[3]) + offset + frame, data.val[3]);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && numChannels == 2)
+  {
+    for(frame = 0; frame + 4 <= frames; frame += 4)
+    {
+      int32x4x2_t data = vld2q_s32(((int const *)ip_src) + (frame * 2));
+
+      vst1q_s32(((int *)op_channels[0]) + offset + frame, data.val[0]);
+      vst1q_s32(((int *)op_channels[1]) + offset + frame, data.val[1]);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && numChannels == 4)
+  {
+    for(frame = 0; frame + 4 <= frames; frame += 4)
+    {
+      int32x4x4_t data = vld4q_s32(((int const *)ip_src) + (frame * 4));
+
+      vst1q_s32(((int *)op_channels[0]) + offset + frame, data.val[0]);
+      vst1q_s32(((int *)op_channels[1]) + offset + frame, data.val[1]);
+      vst1q_s32(((int *)op_channels[2]) + offset + frame, data.val[2]);
+      vst1q_s32(((int *)op_channels[3]) + offset + frame, data.val[3]);
+    }
+
+    return frame;
+  }
+
+  return 0;
+}
+
+/*  vst2/vst4 interleave the channels as they store. */
+unsigned long int interleaveNeon(void *op_dest, void * const *ip_channels, unsigned long int offset, unsigned long int frames, unsigned long int numChannels, unsigned long int sampleSize)
+{
+  unsigned long int frame = 0;
+
+  if(sampleSize == 2 && numChannels == 2)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8)
+    {
+      int16x8x2_t data;
+
+      data.val[0] = vld1q_s16(((short int const *)ip_channels[0]) + offset + frame);
+      data.val[1] = vld1q_s16(((short int const *)ip_channels[1]) + offset + frame);
+
+      vst2q_s16(((short int *)op_dest) + (frame * 2), data);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 2 && numChannels == 4)
+  {
+    for(frame = 0; frame + 8 <= frames; frame += 8)
+    {
+      int16x8x4_t data;
+
+      data.val[0] = vld1q_s16(((short int const *)ip_channels[0]) + offset + frame);
+      data.val[1] = vld1q_s16(((short int const *)ip_channels[1]) + offset + frame);
+      data.val[2] = vld1q_s16(((short int const *)ip_channels[2]) + offset + frame);
+      data.val[3] = vld1q_s16(((short int const *)ip_channels[3]) + offset + frame);
+
+      vst4q_s16(((short int *)op_dest) + (frame * 4), data);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && numChannels == 2)
+  {
+    for(frame = 0; frame + 4 <= frames; frame += 4)
+    {
+      int32x4x2_t data;
+
+      data.val[0] = vld1q_s32(((int const *)ip_channels[0]) + offset + frame);
+      data.val[1] = vld1q_s32(((int const *)ip_channels[1]) + offset + frame);
+
+      vst2q_s32(((int *)op_dest) + (frame * 2), data);
+    }
+
+    return frame;
+  }
+
+  if(sampleSize == 4 && numChannels == 4)
+  {
+    for(frame = 0; frame + 4 <= frames; frame += 4)
+    {
+      int32x4x4_t data;
+
+      data.val[0] = vld1q_s32(((int const *)ip_channels[0]) + offset + frame);
+      data.val[1] = vld1q_s32(((int const *)ip_channels[1]) + offset + frame);
+      data.val[2] = vld1q_s32(((int const *)ip_channels[2]) + offset + frame);
+      data.val[3] = vld1q_s32(((int const *)ip_channels[3]) + offset + frame);
+
+      vst4q_s32(((int *)op_dest) + (frame * 4), data);
+    }
+
+    return frame;
+  }
+
+  return 0;
+}
+#endif
@@ -0,0 +1,318 @@
+/***************************************************************************//**
+  * @brief   ansi-C priority lane ring buffer
+  * @details Ring buffer with priority lanes. Each lane is its own ring buffer with
+  * its own capacity, so bulk traffic can't take the space of control traffic.
+  * Readers drain lanes by strict priority (lane 0 first) or by weighted round
+  * robin. All functions return the number of elements.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.11.0 - Initial version, priority lanes with strict and weighted draining.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ringBufferLanes.h>
+
+/*  private helper functions */
+/*  read from the lane picked by policy, 0 if every lane is empty. */
+unsigned long int lanesReadPicked(struct s_ringBufferLanes * const iop_ringBufferLanes, void *op_buffer, unsigned long int len, unsigned long int *op_lane);
+
+/*  public  functions */
+/*  init, one ring buffer per lane, all in one wait set for the reader. */
+struct s_ringBufferLanes *initRingBufferLanes(unsigned long int numLanes, unsigned long int const *ip_buffSizes, unsigned long int const elementSize, unsigned long int policy, unsigned long int const *ip_weights)
+{
+  unsigned long int index = 0;
+
+  struct s_ringBufferLanes *p_tempLanes = NULL;
+
+  if(numLanes <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Number of lanes must be greater then 0.\n");
+    return NULL;
+  }
+
+  if(!ip_buffSizes)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Lane sizes are NULL.\n");
+    return NULL;
+  }
+
+  if(policy != RING_BUFFER_LANES_STRICT && policy != RING_BUFFER_LANES_WEIGHTED)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Unknown lanes policy %lu.\n", policy);
+    return NULL;
+  }
+
+  p_tempLanes = malloc(sizeof(struct s_ringBufferLanes));
+
+  if(!p_tempLanes)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate lanes object.");
+    return NULL;
+  }
+
+  memset(p_tempLanes, 0, sizeof(*p_tempLanes));
+
+  p_tempLanes->policy = policy;
+
+  if(pthread_mutex_init(&p_tempLanes->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Lanes mutex init failed.\n");
+    free(p_tempLanes);
+    return NULL;
+  }
+
+  p_tempLanes->pp_lanes = calloc(numLanes, sizeof(*p_tempLanes->pp_lanes));
+  p_tempLanes->p_weights = calloc(numLanes, sizeof(*p_tempLanes->p_weights));
+  p_tempLanes->p_credits = calloc(numLanes, sizeof(*p_tempLanes->p_credits));
+  p_tempLanes->p_waitSet = initRingBufferWaitSet();
+
+  if(!p_tempLanes->pp_lanes || !p_tempLanes->p_weights || !p_tempLanes->p_credits || !p_tempLanes->p_waitSet)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate lanes.");
+    freeRingBufferLanes(&p_tempLanes);
+    return NULL;
+  }
+
+  p_tempLanes->numLanes = numLanes;
+
+  for(index = 0; index < numLanes; index++)
+  {
+    p_tempLanes->p_weights[index] = (ip_weights && ip_weights[index] > 0 ? ip_weights[index] : 1);
+    p_tempLanes->p_credits[index] = p_tempLanes->p_weights[index];
+
+    p_tempLanes->pp_lanes[index] = initRingBuffer(ip_buffSizes[index], elementSize);
+
+    if(!p_tempLanes->pp_lanes[index] || !ringBufferWaitSetAdd(p_tempLanes->p_waitSet, p_tempLanes->pp_lanes[index], RING_BUFFER_WAIT_READ, NULL))
+    {
+      fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Lanes Failed.\n");
+      freeRingBufferLanes(&p_tempLanes);
+      return NULL;
+    }
+  }
+
+  return p_tempLanes;
+}
+
+/*  free every lane, then the lanes object. */
+void freeRingBufferLanes(struct s_ringBufferLanes **iopp_ringBufferLanes)
+{
+  unsigned long int index = 0;
+
+  if(!iopp_ringBufferLanes) return;
+
+  if(!*iopp_ringBufferLanes) return;
+
+  freeRingBufferWaitSet(&(*iopp_ringBufferLanes)->p_waitSet);
+
+  for(index = 0; index < (*iopp_ringBufferLanes)->numLanes; index++)
+  {
+    freeRingBuffer(&(*iopp_ringBufferLanes)->pp_lanes[index]);
+  }
+
+  pthread_mutex_destroy(&(*iopp_ringBufferLanes)->mutex);
+
+  free((*iopp_ringBufferLanes)->pp_lanes);
+  free((*iopp_ringBufferLanes)->p_weights);
+  free((*iopp_ringBufferLanes)->p_credits);
+  free(*iopp_ringBufferLanes);
+
+  *iopp_ringBufferLanes = NULL;
+}
+
+/*  blocking write to one lane. */
+unsigned long int ringBufferLanesBlockingWrite(struct s_ringBufferLanes * const iop_ringBufferLanes, unsigned long int lane, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait)
+{
+  if(!iop_ringBufferLanes) return 0;
+
+  if(lane >= iop_ringBufferLanes->numLanes)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Lane %lu does not exist.\n", lane);
+    return 0;
+  }
+
+  return ringBufferBlockingWrite(iop_ringBufferLanes->pp_lanes[lane], ip_buffer, len, p_timeToWait);
+}
+
+/*  non-blocking write to one lane. */
+unsigned long int ringBufferLanesWrite(struct s_ringBufferLanes * const iop_ringBufferLanes, unsigned long int lane, void *ip_buffer, unsigned long int len)
+{
+  if(!iop_ringBufferLanes) return 0;
+
+  if(lane >= iop_ringBufferLanes->numLanes)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Lane %lu does not exist.\n", lane);
+    return 0;
+  }
+
+  return ringBufferWrite(iop_ringBufferLanes->pp_lanes[lane], ip_buffer, len);
+}
+
+/*  read the lane picked by policy, wait on all of them if they are empty. */
+unsigned long int ringBufferLanesBlockingRead(struct s_ringBufferLanes * const iop_ringBufferLanes, void *op_buffer, unsigned long int len, unsigned long int *op_lane, struct timespec *p_timeToWait)
+{
+  unsigned long int totalRead = 0;
+
+  struct timespec deadline;
+  struct s_ringBufferReady ready;
+
+  if(!iop_ringBufferLanes) return 0;
+
+  /* deadline for the whole call, looping doesn't restart the timeout. */
+  if(p_timeToWait && !ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  for(;;)
+  {
+    totalRead = ringBufferLanesRead(iop_ringBufferLanes, op_buffer, len, op_lane);
+
+    if(totalRead > 0) return totalRead;
+
+    if(!ringBufferLanesIsAlive(iop_ringBufferLanes)) return 0;
+
+    if(!ringBufferWaitAnyUntil(iop_ringBufferLanes->p_waitSet, &ready, 1, (p_timeToWait ? &deadline : NULL))) return 0;
+
+    /* an ended lane is always ready, once it is empty stop waiting on it. The last one stays, so a reader that waits late still wakes. */
+    if(!ringBufferIsAlive(ready.p_ringBuffer) && ringBufferLanesIsAlive(iop_ringBufferLanes)) ringBufferWaitSetRemove(iop_ringBufferLanes->p_waitSet, ready.p_ringBuffer);
+  }
+}
+
+/*  read the lane picked by policy. */
+unsigned long int ringBufferLanesRead(struct s_ringBufferLanes * const iop_ringBufferLanes, void *op_buffer, unsigned long int len, unsigned long int *op_lane)
+{
+  unsigned long int totalRead = 0;
+
+  if(!iop_ringBufferLanes) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  if(len <= 0) return totalRead;
+
+  pthread_mutex_lock(&iop_ringBufferLanes->mutex);
+
+  totalRead = lanesReadPicked(iop_ringBufferLanes, op_buffer, len, op_lane);
+
+  pthread_mutex_unlock(&iop_ringBufferLanes->mutex);
+
+  return totalRead;
+}
+
+/*  any lane still blocking or holding data? */
+unsigned long int ringBufferLanesIsAlive(struct s_ringBufferLanes * const ip_ringBufferLanes)
+{
+  unsigned long int index = 0;
+
+  if(!ip_ringBufferLanes) return ERROR_NULL;
+
+  for(index = 0; index < ip_ringBufferLanes->numLanes; index++)
+  {
+    if(ringBufferIsAlive(ip_ringBufferLanes->pp_lanes[index])) return 1;
+  }
+
+  return 0;
+}
+
+/*  end blocking on every lane. */
+void ringBufferLanesEndBlocking(struct s_ringBufferLanes * const iop_ringBufferLanes)
+{
+  unsigned long int index = 0;
+
+  if(!iop_ringBufferLanes) return;
+
+  for(index = 0; index < iop_ringBufferLanes->numLanes; index++)
+  {
+    ringBufferEndBlocking(iop_ringBufferLanes->pp_lanes[index]);
+  }
+
+  /* every blocked reader has to wake up and see the lanes are done, not just one. */
+  pthread_mutex_lock(&iop_ringBufferLanes->p_waitSet->mutex);
+
+  pthread_cond_broadcast(&iop_ringBufferLanes->p_waitSet->condition);
+
+  pthread_mutex_unlock(&iop_ringBufferLanes->p_waitSet->mutex);
+}
+
+/*  help function implimentation */
+/*  strict takes the first lane with data. Weighted takes lanes in turn, each for up to its credits, new round when no lane with data has any left. */
+unsigned long int lanesReadPicked(struct s_ringBufferLanes * const iop_ringBufferLanes, void *op_buffer, unsigned long int len, unsigned long int *op_lane)
+{
+  unsigned long int totalRead = 0;
+  unsigned long int index = 0;
+  unsigned long int count = 0;
+  unsigned long int round = 0;
+
+  if(iop_ringBufferLanes->policy == RING_BUFFER_LANES_STRICT)
+  {
+    for(index = 0; index < iop_ringBufferLanes->numLanes; index++)
+    {
+      totalRead = ringBufferRead(iop_ringBufferLanes->pp_lanes[index], op_buffer, len);
+
+      if(totalRead > 0)
+      {
+        if(op_lane) *op_lane = index;
+        return totalRead;
+      }
+    }
+
+    return 0;
+  }
+
+  for(round = 0; round < 2; round++)
+  {
+    for(count = 0; count < iop_ringBufferLanes->numLanes; count++)
+    {
+      index = (iop_ringBufferLanes->currentLane + count) % iop_ringBufferLanes->numLanes;
+
+      if(iop_ringBufferLanes->p_credits[index] <= 0) continue;
+
+      totalRead = ringBufferRead(iop_ringBufferLanes->pp_lanes[index], op_buffer, (len < iop_ringBufferLanes->p_credits[index] ? len : iop_ringBufferLanes->p_credits[index]));
+
+      if(totalRead <= 0) continue;
+
+      iop_ringBufferLanes->p_credits[index] -= totalRead;
+
+      /* stay on this lane till its credits run out. */
+      iop_ringBufferLanes->currentLane = (iop_ringBufferLanes->p_credits[index] > 0 ? index : (index + 1) % iop_ringBufferLanes->numLanes);
+
+      if(op_lane) *op_lane = index;
+
+      return totalRead;
+    }
+
+    /* nothing with credits had data, start a new round. */
+    for(index = 0; index < iop_ringBufferLanes->numLanes; index++)
+    {
+      iop_ringBufferLanes->p_credits[index] = iop_ringBufferLanes->p_weights[index];
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,452 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer merge reader
+  * @details Binary heap of the ring buffers with a record at the head, keyed by the
+  * record there. Heads are keyed in place through a drain that consumes nothing.
+  * Empty ring buffers sit in a wait set, the merge only waits on them when one
+  * could still get a record that goes first.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.31.0 - Initial version, key ordered merge reader.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ringBufferMerge.h>
+
+#define PROC_SUCC 1
+#define PROC_FAIL 0
+
+#define MERGE_IN_HEAP 0
+#define MERGE_EMPTY   1
+#define MERGE_ENDED   2
+
+/* what a look at the head of a ring buffer found. */
+struct s_mergePeek
+{
+  struct s_ringBufferMerge *p_merge;
+  unsigned long int key;
+  unsigned long int b_found;
+};
+
+/*  private helper functions */
+/*  the merge loop for read and drain, mutex taken here. */
+unsigned long int mergeUntil(struct s_ringBufferMerge * const iop_ringBufferMerge, void *op_buffer, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec const *ip_deadline);
+/*  drain function that keys the head record and consumes nothing. */
+unsigned long int peekKey(void *p_data, unsigned long int len, void *p_context);
+/*  look at the head of a ring buffer again, moving it to the heap, the empty list or ended. */
+void refreshRing(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int ring);
+/*  look at every empty ring buffer again. */
+void refreshEmpty(struct s_ringBufferMerge * const iop_ringBufferMerge);
+/*  could an empty ring buffer still get a record that goes before the head of the heap? */
+unsigned long int mergeBlocked(struct s_ringBufferMerge const * const ip_ringBufferMerge);
+/*  does ring a go before ring b, by key then by ring. */
+unsigned long int ringBefore(struct s_ringBufferMerge const * const ip_ringBufferMerge, unsigned long int a, unsigned long int b);
+/*  add a ring buffer to the heap. */
+void heapPush(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int ring);
+/*  take the top ring buffer off of the heap. */
+void heapPop(struct s_ringBufferMerge * const iop_ringBufferMerge);
+
+/*  public  functions */
+/*  init, every ring buffer is looked at once to fill the heap. */
+struct s_ringBufferMerge *initRingBufferMerge(struct s_ringBuffer * const *ipp_rings, unsigned long int numRings, unsigned long int (*p_keyFunc)(void const *p_record, void *p_context), void *p_context)
+{
+  unsigned long int index = 0;
+
+  struct s_ringBufferMerge *p_tempMerge = NULL;
+
+  if(!ipp_rings || numRings <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Merge needs at least one ring buffer.\n");
+    return NULL;
+  }
+
+  if(!p_keyFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Key function is NULL.\n");
+    return NULL;
+  }
+
+  for(index = 0; index < numRings; index++)
+  {
+    if(!ipp_rings[index] || (getRingBufferElementSize(ipp_rings[index]) != getRingBufferElementSize(ipp_rings[0])))
+    {
+      fprintf(stderr, "ANSI-C RING BUFFER: Merged ring buffers must all have the same element size.\n");
+      return NULL;
+    }
+  }
+
+  p_tempMerge = malloc(sizeof(struct s_ringBufferMerge));
+
+  if(!p_tempMerge)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate merge object.");
+    return NULL;
+  }
+
+  memset(p_tempMerge, 0, sizeof(*p_tempMerge));
+
+  p_tempMerge->numRings = numRings;
+  p_tempMerge->elementSize = getRingBufferElementSize(ipp_rings[0]);
+  p_tempMerge->p_keyFunc = p_keyFunc;
+  p_tempMerge->p_context = p_context;
+
+  if(pthread_mutex_init(&p_tempMerge->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Merge mutex init failed.\n");
+    free(p_tempMerge);
+    return NULL;
+  }
+
+  p_tempMerge->pp_rings = malloc(numRings * sizeof(*p_tempMerge->pp_rings));
+  p_tempMerge->p_heap = malloc(numRings * sizeof(*p_tempMerge->p_heap));
+  p_tempMerge->p_keys = calloc(numRings, sizeof(*p_tempMerge->p_keys));
+  p_tempMerge->p_lastKeys = calloc(numRings, sizeof(*p_tempMerge->p_lastKeys));
+  p_tempMerge->p_states = malloc(numRings * sizeof(*p_tempMerge->p_states));
+  p_tempMerge->p_pending = malloc(numRings * sizeof(*p_tempMerge->p_pending));
+  p_tempMerge->p_waitSet = initRingBufferWaitSet();
+
+  if(!p_tempMerge->pp_rings || !p_tempMerge->p_heap || !p_tempMerge->p_keys || !p_tempMerge->p_lastKeys || !p_tempMerge->p_states || !p_tempMerge->p_pending || !p_tempMerge->p_waitSet)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate merge heap.");
+    freeRingBufferMerge(&p_tempMerge);
+    return NULL;
+  }
+
+  memcpy(p_tempMerge->pp_rings, ipp_rings, numRings * sizeof(*p_tempMerge->pp_rings));
+
+  /* ended and not in the wait set, the first look puts each where it goes. */
+  for(index = 0; index < numRings; index++)
+  {
+    p_tempMerge->p_states[index] = MERGE_ENDED;
+
+    refreshRing(p_tempMerge, index);
+  }
+
+  return p_tempMerge;
+}
+
+/*  free the merge, the wait set free takes it out of the ring buffers. */
+void freeRingBufferMerge(struct s_ringBufferMerge **iopp_ringBufferMerge)
+{
+  if(!iopp_ringBufferMerge) return;
+
+  if(!*iopp_ringBufferMerge) return;
+
+  freeRingBufferWaitSet(&(*iopp_ringBufferMerge)->p_waitSet);
+
+  pthread_mutex_destroy(&(*iopp_ringBufferMerge)->mutex);
+
+  free((*iopp_ringBufferMerge)->pp_rings);
+  free((*iopp_ringBufferMerge)->p_heap);
+  free((*iopp_ringBufferMerge)->p_keys);
+  free((*iopp_ringBufferMerge)->p_lastKeys);
+  free((*iopp_ringBufferMerge)->p_states);
+  free((*iopp_ringBufferMerge)->p_pending);
+  free(*iopp_ringBufferMerge);
+
+  *iopp_ringBufferMerge = NULL;
+}
+
+/*  read records in key order, blocking only on ring buffers that could hold the next one. */
+unsigned long int ringBufferMergeRead(struct s_ringBufferMerge * const iop_ringBufferMerge, void *op_buffer, unsigned long int maxElems, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferMergeReadUntil(iop_ringBufferMerge, op_buffer, maxElems, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferMergeReadUntil(iop_ringBufferMerge, op_buffer, maxElems, &deadline);
+}
+
+/*  same as ringBufferMergeRead, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferMergeReadUntil(struct s_ringBufferMerge * const iop_ringBufferMerge, void *op_buffer, unsigned long int maxElems, struct timespec const *ip_deadline)
+{
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  return mergeUntil(iop_ringBufferMerge, op_buffer, maxElems, NULL, NULL, ip_deadline);
+}
+
+/*  drain records in key order, in place. */
+unsigned long int ringBufferMergeDrain(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec *p_timeToWait)
+{
+  struct timespec deadline;
+
+  if(!p_timeToWait) return ringBufferMergeDrainUntil(iop_ringBufferMerge, maxElems, p_drainFunc, p_context, NULL);
+
+  if(!ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  return ringBufferMergeDrainUntil(iop_ringBufferMerge, maxElems, p_drainFunc, p_context, &deadline);
+}
+
+/*  same as ringBufferMergeDrain, waits till an absolute CLOCK_MONOTONIC deadline. */
+unsigned long int ringBufferMergeDrainUntil(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec const *ip_deadline)
+{
+  if(!p_drainFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Drain function is NULL.\n");
+    return 0;
+  }
+
+  return mergeUntil(iop_ringBufferMerge, NULL, maxElems, p_drainFunc, p_context, ip_deadline);
+}
+
+/*  anything in the heap, or an empty ring buffer that hasn't ended? */
+unsigned long int ringBufferMergeIsAlive(struct s_ringBufferMerge * const iop_ringBufferMerge)
+{
+  unsigned long int b_alive = 0;
+
+  if(!iop_ringBufferMerge) return ERROR_NULL;
+
+  pthread_mutex_lock(&iop_ringBufferMerge->mutex);
+
+  /* an ended ring buffer may have been empty when we last looked, and still not be. */
+  refreshEmpty(iop_ringBufferMerge);
+
+  b_alive = (iop_ringBufferMerge->heapSize > 0) || (iop_ringBufferMerge->numPending > 0);
+
+  pthread_mutex_unlock(&iop_ringBufferMerge->mutex);
+
+  return b_alive;
+}
+
+/*  help function implimentation */
+/* take the top of the heap till done, only looking at the empty ring buffers when one could be holding it up. */
+unsigned long int mergeUntil(struct s_ringBufferMerge * const iop_ringBufferMerge, void *op_buffer, unsigned long int maxElems, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec const *ip_deadline)
+{
+  unsigned long int totalMerged = 0;
+  unsigned long int ring = 0;
+  unsigned long int took = 0;
+
+  struct s_ringBufferReady ready;
+
+  if(!iop_ringBufferMerge) return 0;
+
+  pthread_mutex_lock(&iop_ringBufferMerge->mutex);
+
+  while(totalMerged < maxElems)
+  {
+    if(mergeBlocked(iop_ringBufferMerge)) refreshEmpty(iop_ringBufferMerge);
+
+    while(mergeBlocked(iop_ringBufferMerge))
+    {
+      /* return what we have rather then wait. */
+      if(totalMerged > 0) break;
+
+      if(!ringBufferWaitAnyUntil(iop_ringBufferMerge->p_waitSet, &ready, 1, ip_deadline)) break;
+
+      refreshEmpty(iop_ringBufferMerge);
+    }
+
+    /* timed out, or every ring buffer ended. */
+    if(mergeBlocked(iop_ringBufferMerge) || !iop_ringBufferMerge->heapSize) break;
+
+    ring = iop_ringBufferMerge->p_heap[0];
+
+    if(p_drainFunc)
+    {
+      took = ringBufferDrain(iop_ringBufferMerge->pp_rings[ring], 1, p_drainFunc, p_context);
+
+      /* the drain function didn't take it, it stays at the top. */
+      if(!took) break;
+    }
+    else
+    {
+      took = ringBufferRead(iop_ringBufferMerge->pp_rings[ring], ((char *)op_buffer) + (totalMerged * iop_ringBufferMerge->elementSize), 1);
+    }
+
+    iop_ringBufferMerge->p_lastKeys[ring] = iop_ringBufferMerge->p_keys[ring];
+
+    heapPop(iop_ringBufferMerge);
+
+    refreshRing(iop_ringBufferMerge, ring);
+
+    totalMerged += took;
+  }
+
+  pthread_mutex_unlock(&iop_ringBufferMerge->mutex);
+
+  return totalMerged;
+}
+
+/* the record may straddle the wrap, then this is given a copy. Either way nothing is consumed. */
+unsigned long int peekKey(void *p_data, unsigned long int len, void *p_context)
+{
+  struct s_mergePeek *p_peek = (struct s_mergePeek *)p_context;
+
+  if(len > 0 && !p_peek->b_found)
+  {
+    p_peek->key = p_peek->p_merge->p_keyFunc(p_data, p_peek->p_merge->p_context);
+    p_peek->b_found = 1;
+  }
+
+  return 0;
+}
+
+/* an empty ring buffer is in the wait set, so a write to it wakes the merge. */
+void refreshRing(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int ring)
+{
+  unsigned long int index = 0;
+  unsigned long int state = 0;
+
+  struct s_mergePeek peek;
+
+  peek.p_merge = iop_ringBufferMerge;
+  peek.key = 0;
+  peek.b_found = 0;
+
+  ringBufferDrain(iop_ringBufferMerge->pp_rings[ring], 1, peekKey, &peek);
+
+  if(peek.b_found)
+  {
+    state = MERGE_IN_HEAP;
+  }
+  else
+  {
+    /* is alive reads the data too, written between the peek and here it comes up next look. */
+    state = (ringBufferIsAlive(iop_ringBufferMerge->pp_rings[ring]) ? MERGE_EMPTY : MERGE_ENDED);
+  }
+
+  if((iop_ringBufferMerge->p_states[ring] == MERGE_EMPTY) && (state != MERGE_EMPTY))
+  {
+    while(iop_ringBufferMerge->p_pending[index] != ring) index++;
+
+    iop_ringBufferMerge->p_pending[index] = iop_ringBufferMerge->p_pending[--iop_ringBufferMerge->numPending];
+
+    ringBufferWaitSetRemove(iop_ringBufferMerge->p_waitSet, iop_ringBufferMerge->pp_rings[ring]);
+  }
+
+  if((iop_ringBufferMerge->p_states[ring] != MERGE_EMPTY) && (state == MERGE_EMPTY))
+  {
+    iop_ringBufferMerge->p_pending[iop_ringBufferMerge->numPending++] = ring;
+
+    ringBufferWaitSetAdd(iop_ringBufferMerge->p_waitSet, iop_ringBufferMerge->pp_rings[ring], RING_BUFFER_WAIT_READ, NULL);
+  }
+
+  iop_ringBufferMerge->p_states[ring] = state;
+
+  if(state == MERGE_IN_HEAP)
+  {
+    iop_ringBufferMerge->p_keys[ring] = peek.key;
+
+    heapPush(iop_ringBufferMerge, ring);
+  }
+}
+
+/* backwards, a ring buffer leaving the list is replaced by the last one, already looked at. */
+void refreshEmpty(struct s_ringBufferMerge * const iop_ringBufferMerge)
+{
+  unsigned long int index = 0;
+
+  for(index = iop_ringBufferMerge->numPending; index > 0; index--)
+  {
+    refreshRing(iop_ringBufferMerge, iop_ringBufferMerge->p_pending[index - 1]);
+  }
+}
+
+/* keys in a ring buffer only go up, one whose last key is already at the top of the heap can't go before it. */
+unsigned long int mergeBlocked(struct s_ringBufferMerge const * const ip_ringBufferMerge)
+{
+  unsigned long int index = 0;
+  unsigned long int topKey = 0;
+
+  if(!ip_ringBufferMerge->numPending) return 0;
+
+  if(!ip_ringBufferMerge->heapSize) return 1;
+
+  topKey = ip_ringBufferMerge->p_keys[ip_ringBufferMerge->p_heap[0]];
+
+  for(index = 0; index < ip_ringBufferMerge->numPending; index++)
+  {
+    if(ip_ringBufferMerge->p_lastKeys[ip_ringBufferMerge->p_pending[index]] < topKey) return 1;
+  }
+
+  return 0;
+}
+
+/* ties go to the lower ring buffer, so equal keys come out the same way every time. */
+unsigned long int ringBefore(struct s_ringBufferMerge const * const ip_ringBufferMerge, unsigned long int a, unsigned long int b)
+{
+  if(ip_ringBufferMerge->p_keys[a] != ip_ringBufferMerge->p_keys[b]) return ip_ringBufferMerge->p_keys[a] < ip_ringBufferMerge->p_keys[b];
+
+  return a < b;
+}
+
+/* add at the bottom, move up past anything it goes before. */
+void heapPush(struct s_ringBufferMerge * const iop_ringBufferMerge, unsigned long int ring)
+{
+  unsigned long int index = iop_ringBufferMerge->heapSize++;
+  unsigned long int parent = 0;
+
+  while(index > 0)
+  {
+    parent = (index - 1) / 2;
+
+    if(!ringBefore(iop_ringBufferMerge, ring, iop_ringBufferMerge->p_heap[parent])) break;
+
+    iop_ringBufferMerge->p_heap[index] = iop_ringBufferMerge->p_heap[parent];
+    index = parent;
+  }
+
+  iop_ringBufferMerge->p_heap[index] = ring;
+}
+
+/* the last one goes to the top, then down past anything that goes before it. */
+void heapPop(struct s_ringBufferMerge * const iop_ringBufferMerge)
+{
+  unsigned long int index = 0;
+  unsigned long int child = 0;
+  unsigned long int ring = 0;
+
+  if(!iop_ringBufferMerge->heapSize) return;
+
+  ring = iop_ringBufferMerge->p_heap[--iop_ringBufferMerge->heapSize];
+
+  for(;;)
+  {
+    child = index * 2 + 1;
+
+    if(child >= iop_ringBufferMerge->heapSize) break;
+
+    if((child + 1 < iop_ringBufferMerge->heapSize) && ringBefore(iop_ringBufferMerge, iop_ringBufferMerge->p_heap[child + 1], iop_ringBufferMerge->p_heap[child])) child++;
+
+    if(!ringBefore(iop_ringBufferMerge, iop_ringBufferMerge->p_heap[child], ring)) break;
+
+    iop_ringBufferMerge->p_heap[index] = iop_ringBufferMerge->p_heap[child];
+    index = child;
+  }
+
+  iop_ringBufferMerge->p_heap[index] = ring;
+}
@@ -0,0 +1,517 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer pipeline
+  * @details Multi stage pipeline built on chained ring buffers. Stages are functions
+  * run by one or more worker threads. The pipeline creates the ring buffers
+  * between stages, starts and joins the threads, ends blocking downstream
+  * when a stage finishes, and stops everything when a stage fails. Per stage
+  * throughput and stall time are kept to find the bottleneck stage.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.13.0 - Initial version, multi stage pipelines with stall statistics.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <ringBufferPipeline.h>
+
+#define PROC_SUCC 1
+#define PROC_FAIL 0
+
+/*  private helper functions */
+/*  thread entry for every worker, runs the stage function and passes end of stream on. */
+void *stageWorker(void *data);
+/*  monotonic time in seconds */
+double pipelineTime(void);
+
+/*  public  functions */
+/*  init, stages are added after. */
+struct s_ringBufferPipeline *initRingBufferPipeline(unsigned long int const buffSize, unsigned long int const elementSize)
+{
+  struct s_ringBufferPipeline *p_tempPipeline = NULL;
+
+  if(buffSize <= 0 || elementSize <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Size must be greater then 0.\n");
+    return NULL;
+  }
+
+  p_tempPipeline = malloc(sizeof(struct s_ringBufferPipeline));
+
+  if(!p_tempPipeline)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate pipeline object.");
+    return NULL;
+  }
+
+  memset(p_tempPipeline, 0, sizeof(*p_tempPipeline));
+
+  p_tempPipeline->buffSize = buffSize;
+  p_tempPipeline->elementSize = elementSize;
+
+  if(pthread_mutex_init(&p_tempPipeline->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Pipeline mutex init failed.\n");
+    free(p_tempPipeline);
+    return NULL;
+  }
+
+  return p_tempPipeline;
+}
+
+/*  free every stage and the ring buffers between them. */
+void freeRingBufferPipeline(struct s_ringBufferPipeline **iopp_pipeline)
+{
+  unsigned long int index = 0;
+
+  if(!iopp_pipeline) return;
+
+  if(!*iopp_pipeline) return;
+
+  if((*iopp_pipeline)->b_running)
+  {
+    ringBufferPipelineAbort(*iopp_pipeline, 0);
+    ringBufferPipelineJoin(*iopp_pipeline);
+  }
+
+  for(index = 0; index < (*iopp_pipeline)->numStages; index++)
+  {
+    /* each stage owns its input, the output belongs to the next stage. */
+    freeRingBuffer(&(*iopp_pipeline)->pp_stages[index]->p_input);
+    free((*iopp_pipeline)->pp_stages[index]->p_workers);
+    free((*iopp_pipeline)->pp_stages[index]);
+  }
+
+  pthread_mutex_destroy(&(*iopp_pipeline)->mutex);
+
+  free((*iopp_pipeline)->pp_stages);
+  free(*iopp_pipeline);
+
+  *iopp_pipeline = NULL;
+}
+
+/*  add a stage to the end, chaining it to the last one with a new ring buffer. */
+unsigned long int ringBufferPipelineAddStage(struct s_ringBufferPipeline * const iop_pipeline, char const *ip_name, int (*p_stageFunc)(struct s_ringBufferStageWorker *p_worker), void *p_userData, unsigned long int numWorkers, long int cpu)
+{
+  unsigned long int index = 0;
+
+  struct s_ringBufferStage *p_stage = NULL;
+  struct s_ringBufferStage **pp_temp = NULL;
+
+  if(!iop_pipeline) return PROC_FAIL;
+
+  if(!p_stageFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Stage function is NULL.\n");
+    return PROC_FAIL;
+  }
+
+  if(numWorkers <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Number of workers must be greater then 0.\n");
+    return PROC_FAIL;
+  }
+
+  if(iop_pipeline->b_running)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Can not add a stage to a running pipeline.\n");
+    return PROC_FAIL;
+  }
+
+  p_stage = malloc(sizeof(struct s_ringBufferStage));
+
+  if(!p_stage)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate stage.");
+    return PROC_FAIL;
+  }
+
+  memset(p_stage, 0, sizeof(*p_stage));
+
+  p_stage->p_workers = calloc(numWorkers, sizeof(*p_stage->p_workers));
+
+  pp_temp = realloc(iop_pipeline->pp_stages, (iop_pipeline->numStages + 1) * sizeof(*iop_pipeline->pp_stages));
+
+  if(!p_stage->p_workers || !pp_temp)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate stage.");
+    free(p_stage->p_workers);
+    free(p_stage);
+    if(pp_temp) iop_pipeline->pp_stages = pp_temp;
+    return PROC_FAIL;
+  }
+
+  iop_pipeline->pp_stages = pp_temp;
+
+  if(iop_pipeline->numStages > 0)
+  {
+    p_stage->p_input = initRingBuffer(iop_pipeline->buffSize, iop_pipeline->elementSize);
+
+    if(!p_stage->p_input)
+    {
+      fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Pipeline Stage Failed.\n");
+      free(p_stage->p_workers);
+      free(p_stage);
+      return PROC_FAIL;
+    }
+
+    iop_pipeline->pp_stages[iop_pipeline->numStages - 1]->p_output = p_stage->p_input;
+  }
+
+  p_stage->p_pipeline = iop_pipeline;
+  p_stage->p_name = (ip_name ? ip_name : "stage");
+  p_stage->p_stageFunc = p_stageFunc;
+  p_stage->numWorkers = numWorkers;
+  p_stage->cpu = cpu;
+
+  for(index = 0; index < numWorkers; index++)
+  {
+    p_stage->p_workers[index].p_stage = p_stage;
+    p_stage->p_workers[index].p_userData = p_userData;
+    p_stage->p_workers[index].index = index;
+  }
+
+  iop_pipeline->pp_stages[iop_pipeline->numStages++] = p_stage;
+
+  return PROC_SUCC;
+}
+
+/*  start every worker, last stage first so readers are waiting before data shows up. */
+unsigned long int ringBufferPipelineStart(struct s_ringBufferPipeline * const iop_pipeline)
+{
+  unsigned long int index = 0;
+  unsigned long int worker = 0;
+
+  if(!iop_pipeline) return PROC_FAIL;
+
+  if(iop_pipeline->b_running || iop_pipeline->numStages <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Pipeline is running or has no stages.\n");
+    return PROC_FAIL;
+  }
+
+  __atomic_store_n(&iop_pipeline->error, 0, __ATOMIC_RELEASE);
+  iop_pipeline->b_running = 1;
+
+  for(index = 0; index < iop_pipeline->numStages; index++)
+  {
+    struct s_ringBufferStage *p_stage = iop_pipeline->pp_stages[index];
+
+    /* restarted pipelines need the blocking back on. */
+    ringBufferReset(p_stage->p_input);
+
+    p_stage->workersLeft = p_stage->numWorkers;
+    p_stage->numStarted = 0;
+  }
+
+  for(index = iop_pipeline->numStages; index-- > 0;)
+  {
+    struct s_ringBufferStage *p_stage = iop_pipeline->pp_stages[index];
+
+    for(worker = 0; worker < p_stage->numWorkers; worker++)
+    {
+      pthread_attr_t attr;
+
+      struct s_ringBufferStageWorker *p_worker = &p_stage->p_workers[worker];
+
+      p_worker->elementsIn = p_worker->elementsOut = 0;
+      p_worker->runTime = p_worker->stallInTime = p_worker->stallOutTime = 0;
+      p_worker->error = 0;
+
+      pthread_attr_init(&attr);
+
+#ifdef __linux__
+      if(p_stage->cpu >= 0)
+      {
+        cpu_set_t cpuSet;
+        long numCpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+        CPU_ZERO(&cpuSet);
+        CPU_SET((p_stage->cpu + worker) % (numCpu > 0 ? numCpu : 1), &cpuSet);
+
+        pthread_attr_setaffinity_np(&attr, sizeof(cpuSet), &cpuSet);
+      }
+#endif
+
+      if(pthread_create(&p_worker->thread, &attr, stageWorker, p_worker))
+      {
+        fprintf(stderr, "ANSI-C RING BUFFER: Failed to create stage %s worker %lu.\n", p_stage->p_name, worker);
+
+        pthread_attr_destroy(&attr);
+
+        /* workers not started count as done, then stop the ones that did. */
+        pthread_mutex_lock(&iop_pipeline->mutex);
+        p_stage->workersLeft -= p_stage->numWorkers - worker;
+        pthread_mutex_unlock(&iop_pipeline->mutex);
+
+        ringBufferPipelineAbort(iop_pipeline, -1);
+        ringBufferPipelineJoin(iop_pipeline);
+
+        return PROC_FAIL;
+      }
+
+      pthread_attr_destroy(&attr);
+
+      p_stage->numStarted++;
+    }
+  }
+
+  return PROC_SUCC;
+}
+
+/*  join every worker, first stage first. */
+int ringBufferPipelineJoin(struct s_ringBufferPipeline * const iop_pipeline)
+{
+  unsigned long int index = 0;
+  unsigned long int worker = 0;
+
+  if(!iop_pipeline) return -1;
+
+  if(!iop_pipeline->b_running) return __atomic_load_n(&iop_pipeline->error, __ATOMIC_ACQUIRE);
+
+  for(index = 0; index < iop_pipeline->numStages; index++)
+  {
+    struct s_ringBufferStage *p_stage = iop_pipeline->pp_stages[index];
+
+    /* only the workers Start got going, a failed Start leaves the rest unstarted. */
+    for(worker = 0; worker < p_stage->numStarted; worker++)
+    {
+      pthread_join(p_stage->p_workers[worker].thread, NULL);
+    }
+  }
+
+  iop_pipeline->b_running = 0;
+
+  return __atomic_load_n(&iop_pipeline->error, __ATOMIC_ACQUIRE);
+}
+
+/*  start and join. */
+int ringBufferPipelineRun(struct s_ringBufferPipeline * const iop_pipeline)
+{
+  if(!ringBufferPipelineStart(iop_pipeline)) return -1;
+
+  return ringBufferPipelineJoin(iop_pipeline);
+}
+
+/*  keep the first error, and end blocking everywhere so every worker gets out. */
+void ringBufferPipelineAbort(struct s_ringBufferPipeline * const iop_pipeline, int error)
+{
+  unsigned long int index = 0;
+
+  if(!iop_pipeline) return;
+
+  pthread_mutex_lock(&iop_pipeline->mutex);
+
+  /* workers check it without the lock, so store it atomically. */
+  if(!iop_pipeline->error) __atomic_store_n(&iop_pipeline->error, (error ? error : -1), __ATOMIC_RELEASE);
+
+  pthread_mutex_unlock(&iop_pipeline->mutex);
+
+  for(index = 0; index < iop_pipeline->numStages; index++)
+  {
+    ringBufferEndBlocking(iop_pipeline->pp_stages[index]->p_input);
+  }
+}
+
+/*  blocking read from the input, timed as stall. */
+unsigned long int ringBufferStageRead(struct s_ringBufferStageWorker * const iop_worker, void *op_buffer, unsigned long int len)
+{
+  unsigned long int totalRead = 0;
+
+  double startTime = 0;
+
+  if(!iop_worker) return 0;
+
+  if(!iop_worker->p_stage->p_input || __atomic_load_n(&iop_worker->p_stage->p_pipeline->error, __ATOMIC_ACQUIRE)) return 0;
+
+  startTime = pipelineTime();
+
+  totalRead = ringBufferBlockingRead(iop_worker->p_stage->p_input, op_buffer, len, NULL);
+
+  iop_worker->stallInTime += pipelineTime() - startTime;
+  iop_worker->elementsIn += totalRead;
+
+  return totalRead;
+}
+
+/*  blocking write of all of it to the output, timed as stall. */
+unsigned long int ringBufferStageWrite(struct s_ringBufferStageWorker * const iop_worker, void *ip_buffer, unsigned long int len)
+{
+  unsigned long int totalWrote = 0;
+  unsigned long int wrote = 0;
+
+  double startTime = 0;
+
+  struct s_ringBuffer *p_output = NULL;
+
+  if(!iop_worker) return 0;
+
+  p_output = iop_worker->p_stage->p_output;
+
+  if(!p_output) return 0;
+
+  startTime = pipelineTime();
+
+  while(totalWrote < len && !__atomic_load_n(&iop_worker->p_stage->p_pipeline->error, __ATOMIC_ACQUIRE))
+  {
+    wrote = ringBufferBlockingWrite(p_output, ((char *)ip_buffer) + (totalWrote * getRingBufferElementSize(p_output)), len - totalWrote, NULL);
+
+    if(wrote <= 0) break;
+
+    totalWrote += wrote;
+  }
+
+  iop_worker->stallOutTime += pipelineTime() - startTime;
+  iop_worker->elementsOut += totalWrote;
+
+  return totalWrote;
+}
+
+/*  add up the workers of a stage. */
+unsigned long int ringBufferPipelineGetStats(struct s_ringBufferPipeline const * const ip_pipeline, unsigned long int stage, struct s_ringBufferStageStats *op_stats)
+{
+  unsigned long int worker = 0;
+
+  struct s_ringBufferStage *p_stage = NULL;
+
+  if(!ip_pipeline) return PROC_FAIL;
+
+  if(!op_stats || stage >= ip_pipeline->numStages) return PROC_FAIL;
+
+  p_stage = ip_pipeline->pp_stages[stage];
+
+  memset(op_stats, 0, sizeof(*op_stats));
+
+  op_stats->numWorkers = p_stage->numWorkers;
+
+  for(worker = 0; worker < p_stage->numWorkers; worker++)
+  {
+    op_stats->elementsIn += p_stage->p_workers[worker].elementsIn;
+    op_stats->elementsOut += p_stage->p_workers[worker].elementsOut;
+    op_stats->runTime += p_stage->p_workers[worker].runTime;
+    op_stats->stallInTime += p_stage->p_workers[worker].stallInTime;
+    op_stats->stallOutTime += p_stage->p_workers[worker].stallOutTime;
+  }
+
+  return PROC_SUCC;
+}
+
+/*  one line per stage, the busiest (least stalled) stage is the bottleneck. */
+void ringBufferPipelineReport(struct s_ringBufferPipeline const * const ip_pipeline, FILE *op_file)
+{
+  unsigned long int index = 0;
+  unsigned long int bottleneck = 0;
+
+  double busy = 0;
+  double maxBusy = -1;
+
+  struct s_ringBufferStageStats stats;
+
+  if(!ip_pipeline || !op_file) return;
+
+  for(index = 0; index < ip_pipeline->numStages; index++)
+  {
+    ringBufferPipelineGetStats(ip_pipeline, index, &stats);
+
+    busy = (stats.runTime > 0 ? (stats.runTime - stats.stallInTime - stats.stallOutTime) / stats.runTime : 0);
+
+    if(busy > maxBusy)
+    {
+      maxBusy = busy;
+      bottleneck = index;
+    }
+  }
+
+  fprintf(op_file, "%-16s %7s %12s %12s %14s %8s %8s\n", "STAGE", "WORKERS", "IN", "OUT", "ELEMENTS/SEC", "STALL_IN", "STALL_OUT");
+
+  for(index = 0; index < ip_pipeline->numStages; index++)
+  {
+    double rate = 0;
+
+    ringBufferPipelineGetStats(ip_pipeline, index, &stats);
+
+    /* workers run side by side, so rate is per the average worker run time. */
+    if(stats.runTime > 0) rate = (stats.elementsIn > stats.elementsOut ? stats.elementsIn : stats.elementsOut) / (stats.runTime / stats.numWorkers);
+
+    fprintf(op_file, "%-16s %7lu %12lu %12lu %14.0f %7.1f%% %7.1f%%%s\n", ip_pipeline->pp_stages[index]->p_name, stats.numWorkers, stats.elementsIn, stats.elementsOut, rate,
+            (stats.runTime > 0 ? 100.0 * stats.stallInTime / stats.runTime : 0), (stats.runTime > 0 ? 100.0 * stats.stallOutTime / stats.runTime : 0), (index == bottleneck ? " <- bottleneck" : ""));
+  }
+}
+
+/*  help function implimentation */
+/*  run the stage function, on the last worker out end blocking downstream. */
+void *stageWorker(void *data)
+{
+  unsigned long int b_lastOut = 0;
+
+  double startTime = 0;
+
+  struct s_ringBufferStageWorker *p_worker = NULL;
+  struct s_ringBufferStage *p_stage = NULL;
+
+  p_worker = (struct s_ringBufferStageWorker *)data;
+
+  if(!p_worker) return NULL;
+
+  p_stage = p_worker->p_stage;
+
+  startTime = pipelineTime();
+
+  p_worker->error = p_stage->p_stageFunc(p_worker);
+
+  p_worker->runTime = pipelineTime() - startTime;
+
+  if(p_worker->error) ringBufferPipelineAbort(p_stage->p_pipeline, p_worker->error);
+
+  pthread_mutex_lock(&p_stage->p_pipeline->mutex);
+
+  b_lastOut = (--p_stage->workersLeft == 0);
+
+  pthread_mutex_unlock(&p_stage->p_pipeline->mutex);
+
+  if(b_lastOut) ringBufferEndBlocking(p_stage->p_output);
+
+  return NULL;
+}
+
+/*  seconds from the monotonic clock. */
+double pipelineTime(void)
+{
+  struct timespec timeNow;
+
+  if(clock_gettime(CLOCK_MONOTONIC, &timeNow)) return 0;
+
+  return timeNow.tv_sec + (timeNow.tv_nsec / 1e9);
+}
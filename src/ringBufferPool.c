@@ -0,0 +1,215 @@
+/***************************************************************************//**
+  * @brief   ansi-C ring buffer pool
+  * @details Pool of ring buffers that are initialized once and recycled.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.19.0 - Initial version, ring buffer pool.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ringBufferPool.h>
+
+#define PROC_SUCC 1
+#define PROC_FAIL 0
+
+/*  public  functions */
+/*  init, one block for every ring buffer, each laid out in place. */
+struct s_ringBufferPool *initRingBufferPool(unsigned long int numRings, unsigned long int buffSize, unsigned long int elementSize)
+{
+  unsigned long int index = 0;
+
+  struct s_ringBufferPool *p_tempPool = NULL;
+
+  if(numRings <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Number of ring buffers must be greater then 0.\n");
+    return NULL;
+  }
+
+  p_tempPool = malloc(sizeof(struct s_ringBufferPool));
+
+  if(!p_tempPool)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate pool object.");
+    return NULL;
+  }
+
+  memset(p_tempPool, 0, sizeof(*p_tempPool));
+
+  p_tempPool->ringStride = ringBufferInPlaceSize(buffSize, elementSize);
+
+  if(!p_tempPool->ringStride)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Pool Failed.\n");
+    free(p_tempPool);
+    return NULL;
+  }
+
+  /* each ring buffer starts on its own cache line. */
+  p_tempPool->ringStride = (p_tempPool->ringStride + RING_BUFFER_ALIGN - 1) / RING_BUFFER_ALIGN * RING_BUFFER_ALIGN;
+
+  if(pthread_mutex_init(&p_tempPool->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Pool mutex init failed.\n");
+    free(p_tempPool);
+    return NULL;
+  }
+
+  /* aligned, so each ring buffer sits right at the start of its stride. */
+  if(posix_memalign(&p_tempPool->p_memory, RING_BUFFER_ALIGN, numRings * p_tempPool->ringStride)) p_tempPool->p_memory = NULL;
+  p_tempPool->pp_free = calloc(numRings, sizeof(*p_tempPool->pp_free));
+
+  if(!p_tempPool->p_memory || !p_tempPool->pp_free)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate ring buffers.");
+    freeRingBufferPool(&p_tempPool);
+    return NULL;
+  }
+
+  for(index = 0; index < numRings; index++)
+  {
+    p_tempPool->pp_free[index] = ringBufferInitInPlace(((char *)p_tempPool->p_memory) + (index * p_tempPool->ringStride), p_tempPool->ringStride, buffSize, elementSize);
+
+    if(!p_tempPool->pp_free[index])
+    {
+      fprintf(stderr, "ANSI-C RING BUFFER: Ring Buffer Pool Failed.\n");
+      freeRingBufferPool(&p_tempPool);
+      return NULL;
+    }
+
+    p_tempPool->numRings++;
+    p_tempPool->numFree++;
+  }
+
+  return p_tempPool;
+}
+
+/*  free every ring buffer, then the block they live in. */
+void freeRingBufferPool(struct s_ringBufferPool **iopp_ringBufferPool)
+{
+  unsigned long int index = 0;
+
+  if(!iopp_ringBufferPool) return;
+
+  if(!*iopp_ringBufferPool) return;
+
+  if((*iopp_ringBufferPool)->numFree != (*iopp_ringBufferPool)->numRings)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: %lu ring buffers not returned to the pool.\n", (*iopp_ringBufferPool)->numRings - (*iopp_ringBufferPool)->numFree);
+  }
+
+  /* in place, this only destroys the mutex and condition, and frees anything a resize allocated. */
+  for(index = 0; index < (*iopp_ringBufferPool)->numFree; index++)
+  {
+    freeRingBuffer(&(*iopp_ringBufferPool)->pp_free[index]);
+  }
+
+  pthread_mutex_destroy(&(*iopp_ringBufferPool)->mutex);
+
+  free((*iopp_ringBufferPool)->pp_free);
+  free((*iopp_ringBufferPool)->p_memory);
+  free(*iopp_ringBufferPool);
+
+  *iopp_ringBufferPool = NULL;
+}
+
+/*  pop a ring buffer off of the free list. */
+struct s_ringBuffer *ringBufferPoolGet(struct s_ringBufferPool * const iop_ringBufferPool)
+{
+  struct s_ringBuffer *p_ringBuffer = NULL;
+
+  if(!iop_ringBufferPool) return NULL;
+
+  pthread_mutex_lock(&iop_ringBufferPool->mutex);
+
+  if(iop_ringBufferPool->numFree > 0)
+  {
+    p_ringBuffer = iop_ringBufferPool->pp_free[--iop_ringBufferPool->numFree];
+  }
+
+  pthread_mutex_unlock(&iop_ringBufferPool->mutex);
+
+  return p_ringBuffer;
+}
+
+/*  recycle, then push it back on the free list. */
+int ringBufferPoolPut(struct s_ringBufferPool * const iop_ringBufferPool, struct s_ringBuffer * const iop_ringBuffer)
+{
+  char *p_ring = (char *)iop_ringBuffer;
+  char *p_memory = NULL;
+
+  if(!iop_ringBufferPool) return PROC_FAIL;
+
+  if(!iop_ringBuffer) return PROC_FAIL;
+
+  p_memory = (char *)iop_ringBufferPool->p_memory;
+
+  /* inside the block isn't enough, it has to be where a ring buffer starts. */
+  if(p_ring < p_memory || p_ring >= p_memory + (iop_ringBufferPool->numRings * iop_ringBufferPool->ringStride) || ((unsigned long int)(p_ring - p_memory) % iop_ringBufferPool->ringStride))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer is not from this pool.\n");
+    return PROC_FAIL;
+  }
+
+  /* the recycle happens here, so getting one is as cheap as it can be. */
+  ringBufferRecycle(iop_ringBuffer);
+
+  pthread_mutex_lock(&iop_ringBufferPool->mutex);
+
+  if(iop_ringBufferPool->numFree >= iop_ringBufferPool->numRings)
+  {
+    pthread_mutex_unlock(&iop_ringBufferPool->mutex);
+    fprintf(stderr, "ANSI-C RING BUFFER: Ring buffer put back in the pool twice.\n");
+    return PROC_FAIL;
+  }
+
+  iop_ringBufferPool->pp_free[iop_ringBufferPool->numFree++] = iop_ringBuffer;
+
+  pthread_mutex_unlock(&iop_ringBufferPool->mutex);
+
+  return PROC_SUCC;
+}
+
+/*  How many ring buffers are left? */
+unsigned long int getRingBufferPoolFree(struct s_ringBufferPool * const ip_ringBufferPool)
+{
+  unsigned long int tempSize = 0;
+
+  if(!ip_ringBufferPool) return ERROR_NULL;
+
+  pthread_mutex_lock(&ip_ringBufferPool->mutex);
+
+  tempSize = ip_ringBufferPool->numFree;
+
+  pthread_mutex_unlock(&ip_ringBufferPool->mutex);
+
+  return tempSize;
+}
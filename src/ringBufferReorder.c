@@ -0,0 +1,453 @@
+/***************************************************************************//**
+  * @brief   ansi-C reorder ring buffer
+  * @details Window of chunk slots indexed by sequence number. Producers fill slots in
+  * any order, the reader takes the completed prefix. The slots of the prefix
+  * are read without the mutex, only the reader touches them till they are
+  * given back.
+  * @author  Jay Convertino(electrobs@gmail.com)
+  * @date    10/18/2026
+  * @version
+  * - 1.25.0 - Initial version, sequence numbered reorder ring.
+  * 
+  * @license mit
+  * 
+  * Copyright 2020 Johnathan Convertino
+  *
+  * Permission is hereby granted, free of charge, to any person obtaining a copy
+  * of this software and associated documentation files (the "Software"), to deal
+  * in the Software without restriction, including without limitation the rights
+  * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell 
+  * copies of the Software, and to permit persons to whom the Software is 
+  * furnished to do so, subject to the following conditions:
+  * 
+  * The above copyright notice and this permission notice shall be included in 
+  * all copies or substantial portions of the Software.
+  * 
+  * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR 
+  * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, 
+  * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE 
+  * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER 
+  * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING 
+  * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+  * IN THE SOFTWARE.
+  *****************************************************************************/
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <ringBufferReorder.h>
+
+#define PROC_SUCC 1
+#define PROC_FAIL 0
+
+/*  private helper functions */
+/*  wait for the chunk at the start of the window, return how many completed chunks follow in a row. */
+unsigned long int waitPrefix(struct s_ringBufferReorder * const iop_ringBufferReorder, struct timespec const *ip_deadline);
+/*  count completed chunks from the start of the window, mutex held. */
+unsigned long int countPrefix(struct s_ringBufferReorder const * const ip_ringBufferReorder);
+/*  give the first count slots back and move the window. */
+void releasePrefix(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int count);
+/*  the slot for a sequence number. */
+char *slotData(struct s_ringBufferReorder const * const ip_ringBufferReorder, unsigned long int seq);
+
+/*  public  functions */
+/*  init, slots in one aligned block, a monotonic condition for each side. */
+struct s_ringBufferReorder *initRingBufferReorder(unsigned long int numSlots, unsigned long int slotSize)
+{
+  pthread_condattr_t condAttr;
+
+  struct s_ringBufferReorder *p_tempReorder = NULL;
+
+  if(numSlots <= 0 || slotSize <= 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Number and size of slots must be greater then 0.\n");
+    return NULL;
+  }
+
+  p_tempReorder = malloc(sizeof(struct s_ringBufferReorder));
+
+  if(!p_tempReorder)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate reorder object.");
+    return NULL;
+  }
+
+  memset(p_tempReorder, 0, sizeof(*p_tempReorder));
+
+  if(pthread_mutex_init(&p_tempReorder->mutex, NULL))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Reorder mutex init failed.\n");
+    free(p_tempReorder);
+    return NULL;
+  }
+
+  /* deadlines are on CLOCK_MONOTONIC, same as the ring buffer. */
+  if(pthread_condattr_init(&condAttr) || pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Reorder condition init failed.\n");
+    pthread_mutex_destroy(&p_tempReorder->mutex);
+    free(p_tempReorder);
+    return NULL;
+  }
+
+  if(pthread_cond_init(&p_tempReorder->writeCondition, &condAttr))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Reorder condition init failed.\n");
+    pthread_condattr_destroy(&condAttr);
+    pthread_mutex_destroy(&p_tempReorder->mutex);
+    free(p_tempReorder);
+    return NULL;
+  }
+
+  if(pthread_cond_init(&p_tempReorder->readCondition, &condAttr))
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Reorder condition init failed.\n");
+    pthread_condattr_destroy(&condAttr);
+    pthread_cond_destroy(&p_tempReorder->writeCondition);
+    pthread_mutex_destroy(&p_tempReorder->mutex);
+    free(p_tempReorder);
+    return NULL;
+  }
+
+  pthread_condattr_destroy(&condAttr);
+
+  p_tempReorder->numSlots = numSlots;
+  p_tempReorder->slotSize = slotSize;
+  p_tempReorder->slotStride = (slotSize + RING_BUFFER_ALIGN - 1) / RING_BUFFER_ALIGN * RING_BUFFER_ALIGN;
+  p_tempReorder->b_blocking = 1;
+
+  p_tempReorder->p_lens = calloc(numSlots, sizeof(*p_tempReorder->p_lens));
+  p_tempReorder->p_ready = calloc(numSlots, sizeof(*p_tempReorder->p_ready));
+
+  if(posix_memalign(&p_tempReorder->p_slots, RING_BUFFER_ALIGN, numSlots * p_tempReorder->slotStride)) p_tempReorder->p_slots = NULL;
+
+  if(!p_tempReorder->p_lens || !p_tempReorder->p_ready || !p_tempReorder->p_slots)
+  {
+    perror("ANSI-C RING BUFFER: Could not allocate reorder slots.");
+    freeRingBufferReorder(&p_tempReorder);
+    return NULL;
+  }
+
+  return p_tempReorder;
+}
+
+/*  free the slots, then the object. */
+void freeRingBufferReorder(struct s_ringBufferReorder **iopp_ringBufferReorder)
+{
+  if(!iopp_ringBufferReorder) return;
+
+  if(!*iopp_ringBufferReorder) return;
+
+  pthread_cond_destroy(&(*iopp_ringBufferReorder)->readCondition);
+  pthread_cond_destroy(&(*iopp_ringBufferReorder)->writeCondition);
+  pthread_mutex_destroy(&(*iopp_ringBufferReorder)->mutex);
+
+  free((*iopp_ringBufferReorder)->p_lens);
+  free((*iopp_ringBufferReorder)->p_ready);
+  free((*iopp_ringBufferReorder)->p_slots);
+  free(*iopp_ringBufferReorder);
+
+  *iopp_ringBufferReorder = NULL;
+}
+
+/*  wait till seq is inside the window, then hand out its slot. */
+void *ringBufferReorderAcquire(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int seq, struct timespec *p_timeToWait)
+{
+  int error = 0;
+
+  struct timespec deadline;
+
+  if(!iop_ringBufferReorder) return NULL;
+
+  /* deadline for the whole call, waking up early doesn't restart it. */
+  if(p_timeToWait && !ringBufferDeadline(&deadline, p_timeToWait)) return NULL;
+
+  pthread_mutex_lock(&iop_ringBufferReorder->mutex);
+
+  /* unsigned distance from the start of the window, a sequence number behind it comes out huge. */
+  if(seq - iop_ringBufferReorder->nextSeq > ((unsigned long int)~0 >> 1))
+  {
+    pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Sequence %lu has already been read.\n", seq);
+    return NULL;
+  }
+
+  while(seq - iop_ringBufferReorder->nextSeq >= iop_ringBufferReorder->numSlots)
+  {
+    if(!iop_ringBufferReorder->b_blocking || error)
+    {
+      pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+      return NULL;
+    }
+
+    if(p_timeToWait)
+    {
+      error = pthread_cond_timedwait(&iop_ringBufferReorder->writeCondition, &iop_ringBufferReorder->mutex, &deadline);
+    }
+    else
+    {
+      error = pthread_cond_wait(&iop_ringBufferReorder->writeCondition, &iop_ringBufferReorder->mutex);
+    }
+  }
+
+  if(!iop_ringBufferReorder->b_blocking)
+  {
+    pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+    return NULL;
+  }
+
+  pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+
+  return slotData(iop_ringBufferReorder, seq);
+}
+
+/*  mark the chunk complete, wake the reader if it was waiting on this one. */
+int ringBufferReorderCommit(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int seq, unsigned long int len)
+{
+  unsigned long int index = 0;
+
+  if(!iop_ringBufferReorder) return PROC_FAIL;
+
+  if(len > iop_ringBufferReorder->slotSize)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Length %lu is larger then the slot.\n", len);
+    return PROC_FAIL;
+  }
+
+  index = seq % iop_ringBufferReorder->numSlots;
+
+  pthread_mutex_lock(&iop_ringBufferReorder->mutex);
+
+  if(seq - iop_ringBufferReorder->nextSeq >= iop_ringBufferReorder->numSlots)
+  {
+    pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Sequence %lu is not in the window.\n", seq);
+    return PROC_FAIL;
+  }
+
+  if(iop_ringBufferReorder->p_ready[index])
+  {
+    pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+
+    fprintf(stderr, "ANSI-C RING BUFFER: Sequence %lu committed more then once.\n", seq);
+    return PROC_FAIL;
+  }
+
+  iop_ringBufferReorder->p_lens[index] = len;
+  iop_ringBufferReorder->p_ready[index] = 1;
+
+  /* chunks after a gap can't be read yet, only filling the gap wakes the reader. */
+  if(seq == iop_ringBufferReorder->nextSeq) pthread_cond_signal(&iop_ringBufferReorder->readCondition);
+
+  pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+
+  return PROC_SUCC;
+}
+
+/*  acquire, copy, commit. */
+int ringBufferReorderWrite(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int seq, void *ip_buffer, unsigned long int len, struct timespec *p_timeToWait)
+{
+  char *p_slot = NULL;
+
+  if(!iop_ringBufferReorder) return PROC_FAIL;
+
+  if(!ip_buffer && len > 0)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Input buffer is NULL.\n");
+    return PROC_FAIL;
+  }
+
+  if(len > iop_ringBufferReorder->slotSize)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Length %lu is larger then the slot.\n", len);
+    return PROC_FAIL;
+  }
+
+  p_slot = ringBufferReorderAcquire(iop_ringBufferReorder, seq, p_timeToWait);
+
+  if(!p_slot) return PROC_FAIL;
+
+  if(len > 0) memcpy(p_slot, ip_buffer, len);
+
+  return ringBufferReorderCommit(iop_ringBufferReorder, seq, len);
+}
+
+/*  copy as many whole chunks of the prefix as fit. */
+unsigned long int ringBufferReorderRead(struct s_ringBufferReorder * const iop_ringBufferReorder, void *op_buffer, unsigned long int len, struct timespec *p_timeToWait)
+{
+  unsigned long int count = 0;
+  unsigned long int index = 0;
+  unsigned long int chunkLen = 0;
+  unsigned long int totalRead = 0;
+
+  struct timespec deadline;
+
+  if(!iop_ringBufferReorder) return 0;
+
+  if(!op_buffer)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Output buffer is NULL.\n");
+    return 0;
+  }
+
+  if(len < iop_ringBufferReorder->slotSize)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Read length must be at least the slot size, %lu.\n", iop_ringBufferReorder->slotSize);
+    return 0;
+  }
+
+  if(p_timeToWait && !ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  count = waitPrefix(iop_ringBufferReorder, (p_timeToWait ? &deadline : NULL));
+
+  /* the prefix is ours till it is released, copy without the mutex. */
+  for(index = 0; index < count; index++)
+  {
+    chunkLen = iop_ringBufferReorder->p_lens[(iop_ringBufferReorder->nextSeq + index) % iop_ringBufferReorder->numSlots];
+
+    if(totalRead + chunkLen > len) break;
+
+    memcpy(((char *)op_buffer) + totalRead, slotData(iop_ringBufferReorder, iop_ringBufferReorder->nextSeq + index), chunkLen);
+
+    totalRead += chunkLen;
+  }
+
+  releasePrefix(iop_ringBufferReorder, index);
+
+  return totalRead;
+}
+
+/*  hand each chunk of the prefix to the callback where it is. */
+unsigned long int ringBufferReorderDrain(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int (*p_drainFunc)(void *p_data, unsigned long int len, void *p_context), void *p_context, struct timespec *p_timeToWait)
+{
+  unsigned long int count = 0;
+  unsigned long int index = 0;
+  unsigned long int seq = 0;
+
+  struct timespec deadline;
+
+  if(!iop_ringBufferReorder) return 0;
+
+  if(!p_drainFunc)
+  {
+    fprintf(stderr, "ANSI-C RING BUFFER: Drain function is NULL.\n");
+    return 0;
+  }
+
+  if(p_timeToWait && !ringBufferDeadline(&deadline, p_timeToWait)) return 0;
+
+  count = waitPrefix(iop_ringBufferReorder, (p_timeToWait ? &deadline : NULL));
+
+  for(index = 0; index < count; index++)
+  {
+    seq = iop_ringBufferReorder->nextSeq + index;
+
+    p_drainFunc(slotData(iop_ringBufferReorder, seq), iop_ringBufferReorder->p_lens[seq % iop_ringBufferReorder->numSlots], p_context);
+  }
+
+  releasePrefix(iop_ringBufferReorder, count);
+
+  return count;
+}
+
+/*  still blocking, or the next chunk is ready? */
+unsigned long int ringBufferReorderIsAlive(struct s_ringBufferReorder * const ip_ringBufferReorder)
+{
+  unsigned long int b_alive = 0;
+
+  if(!ip_ringBufferReorder) return ERROR_NULL;
+
+  pthread_mutex_lock(&ip_ringBufferReorder->mutex);
+
+  b_alive = (ip_ringBufferReorder->b_blocking || ip_ringBufferReorder->p_ready[ip_ringBufferReorder->nextSeq % ip_ringBufferReorder->numSlots]);
+
+  pthread_mutex_unlock(&ip_ringBufferReorder->mutex);
+
+  return b_alive;
+}
+
+/*  wake both sides, they check b_blocking. */
+void ringBufferReorderEndBlocking(struct s_ringBufferReorder * const iop_ringBufferReorder)
+{
+  if(!iop_ringBufferReorder) return;
+
+  pthread_mutex_lock(&iop_ringBufferReorder->mutex);
+
+  iop_ringBufferReorder->b_blocking = 0;
+
+  pthread_cond_broadcast(&iop_ringBufferReorder->writeCondition);
+  pthread_cond_broadcast(&iop_ringBufferReorder->readCondition);
+  pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+}
+
+/*  help function implimentation */
+/*  wait on the read condition till the start of the window is committed, blocking ends, or the deadline. */
+unsigned long int waitPrefix(struct s_ringBufferReorder * const iop_ringBufferReorder, struct timespec const *ip_deadline)
+{
+  int error = 0;
+
+  unsigned long int count = 0;
+
+  pthread_mutex_lock(&iop_ringBufferReorder->mutex);
+
+  while(!(count = countPrefix(iop_ringBufferReorder)))
+  {
+    if(!iop_ringBufferReorder->b_blocking || error) break;
+
+    if(ip_deadline)
+    {
+      error = pthread_cond_timedwait(&iop_ringBufferReorder->readCondition, &iop_ringBufferReorder->mutex, ip_deadline);
+    }
+    else
+    {
+      error = pthread_cond_wait(&iop_ringBufferReorder->readCondition, &iop_ringBufferReorder->mutex);
+    }
+  }
+
+  pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+
+  return count;
+}
+
+/*  walk the ready flags from the start of the window to the first gap. */
+unsigned long int countPrefix(struct s_ringBufferReorder const * const ip_ringBufferReorder)
+{
+  unsigned long int count = 0;
+
+  while((count < ip_ringBufferReorder->numSlots) && ip_ringBufferReorder->p_ready[(ip_ringBufferReorder->nextSeq + count) % ip_ringBufferReorder->numSlots]) count++;
+
+  return count;
+}
+
+/*  clear the flags, move the window, and let every waiting producer look at it. */
+void releasePrefix(struct s_ringBufferReorder * const iop_ringBufferReorder, unsigned long int count)
+{
+  unsigned long int index = 0;
+
+  if(count <= 0) return;
+
+  pthread_mutex_lock(&iop_ringBufferReorder->mutex);
+
+  for(index = 0; index < count; index++)
+  {
+    iop_ringBufferReorder->p_ready[(iop_ringBufferReorder->nextSeq + index) % iop_ringBufferReorder->numSlots] = 0;
+  }
+
+  iop_ringBufferReorder->nextSeq += count;
+
+  /* producers wait for different sequence numbers, wake them all. */
+  pthread_cond_broadcast(&iop_ringBufferReorder->writeCondition);
+  pthread_mutex_unlock(&iop_ringBufferReorder->mutex);
+}
+
+/*  slots are indexed by sequence number modulo the window. */
+char *slotData(struct s_ringBufferReorder const * const ip_ringBufferReorder, unsigned long int seq)
+{
+  return ((char *)ip_ringBufferReorder->p_slots) + (seq % ip_ringBufferReorder->numSlots) * ip_ringBufferReorder->slotStride;
+}